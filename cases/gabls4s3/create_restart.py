@@ -8,6 +8,7 @@ import sys
 
 # Custom functions to do fast tri-linear interpolation:
 from trilin import *
+from microhh import skip_restart_header
 
 DEBUG = True
 
@@ -52,6 +53,7 @@ class Read_field:
         self.data = np.zeros((nz+2, ny+2, nx+2))
 
         fin   = open(path, "rb")
+        skip_restart_header(fin, nx*ny*nz)
         for k in range(nz):
             raw = fin.read(nx*ny*8)
             tmp = np.array(st.unpack('{0}{1}d'.format('<', nx*ny), raw))
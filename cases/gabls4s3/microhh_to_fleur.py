@@ -6,6 +6,7 @@ import numpy as np
 from netCDF4 import Dataset
 import struct  as st
 from pylab import * ## TMP
+from microhh import skip_restart_header
 
 # load the init script to get variables like ug, vg, Ts
 from gabls4s3init import *
@@ -397,6 +398,7 @@ def convert_3d(times, itot=608, jtot=608, ktot=304, ksave=246):
         # Write 3D fields:
         for var,field in zip(['u','v','w','th'],[var_u, var_v, var_w, var_th]):
             fin = open("%s.%07i"%(var,time),"rb")
+            skip_restart_header(fin, itot*jtot*ktot)
             for k in range(ksave):
                 raw = fin.read(itot*jtot*8)
                 tmp = np.array(st.unpack('{0}{1}d'.format('<', itot*jtot), raw))
@@ -3,6 +3,7 @@ import struct
 import netCDF4
 
 from pylab import *
+from microhh import skip_restart_header
 
 nx = 384
 ny = 384
@@ -53,6 +54,7 @@ for t in range(nt):
   print("Processing iter = {:07d}".format(prociter))
 
   fin = open("u.{:07d}".format(prociter),"rb")
+  skip_restart_header(fin, n)
   raw = fin.read(n*8)
   tmp = numpy.array(struct.unpack('>{}d'.format(n), raw))
   del(raw)
@@ -66,6 +68,7 @@ for t in range(nt):
   del(u)
 
   fin = open("v.{:07d}".format(prociter),"rb")
+  skip_restart_header(fin, n)
   raw = fin.read(n*8)
   tmp = numpy.array(struct.unpack('>{}d'.format(n), raw))
   del(raw)
@@ -79,6 +82,7 @@ for t in range(nt):
   del(v)
 
   fin = open("w.{:07d}".format(prociter),"rb")
+  skip_restart_header(fin, n)
   raw = fin.read(n*8)
   tmp = numpy.array(struct.unpack('>{}d'.format(n), raw))
   del(raw)
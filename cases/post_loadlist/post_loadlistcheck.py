@@ -0,0 +1,23 @@
+import numpy
+import glob
+import sys
+
+# the cross sections of the passive scalar need the scalar to be loaded in post-processing mode,
+# a field that is not loaded is zero
+itot = 16
+jtot = 16
+
+error = 0
+for name in ['s', 'slngrad']:
+  files = sorted(glob.glob('{0}.xy.*'.format(name)))
+  if (len(files) == 0):
+    print('no cross sections of {0}'.format(name))
+    error += 1
+
+  for f in files:
+    data = numpy.fromfile(f, dtype=numpy.float64)
+    if (data.size != itot*jtot or not numpy.any(data != 0.)):
+      print('cross section {0} is empty'.format(f))
+      error += 1
+
+sys.exit(error)
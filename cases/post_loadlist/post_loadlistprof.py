@@ -0,0 +1,21 @@
+import numpy
+
+# set the height
+kmax  = 32
+zsize = 1.
+dz    = zsize / kmax
+
+z = numpy.linspace(0.5*dz, zsize-0.5*dz, kmax)
+
+# the buoyancy and the passive scalars increase linearly with height
+b = 3.*z
+s = 2.*z
+c = 1.*z
+
+# write the data to a file, the post-processing run reads the same profiles
+for name in ['post_loadlist.prof', 'post_loadlist_post.prof']:
+  proffile = open(name,'w')
+  proffile.write('{0:^20s} {1:^20s} {2:^20s} {3:^20s}\n'.format('z','b','s','c'))
+  for k in range(kmax):
+    proffile.write('{0:1.14E} {1:1.14E} {2:1.14E} {3:1.14E}\n'.format(z[k], b[k], s[k], c[k]))
+  proffile.close()
@@ -0,0 +1,15 @@
+#!/bin/bash
+python post_loadlistprof.py
+
+rm -f *.000*
+rm -f *.out
+./microhh init post_loadlist
+./microhh run post_loadlist
+./microhh post post_loadlist_post
+python post_loadlistcheck.py
+error=$?
+if [ $error = 0 ]; then
+  echo "TEST PASSED!"
+else
+  echo "TEST FAILED!"
+fi
@@ -1,6 +1,7 @@
 import numpy as np
 import struct as st
 import pylab as pl
+from microhh import skip_restart_header
 
 class Data:
     def __init__(self, path, nx, nz, N2):
@@ -23,6 +24,7 @@ class Data:
         fin.close()
         
         fin = open("{0}/u.0010000".format(path), "rb")
+        skip_restart_header(fin, n)
         raw = fin.read(nx*nz*8)
         tmp = np.array(st.unpack('{0}d'.format(nx*nz), raw))
         del(raw)
@@ -31,6 +33,7 @@ class Data:
         del(tmp)
          
         fin = open("{0}/w.0010000".format(path), "rb")
+        skip_restart_header(fin, n)
         raw = fin.read(nx*nz*8)
         tmp = np.array(st.unpack('{0}d'.format(nx*nz), raw))
         del(raw)
@@ -39,6 +42,7 @@ class Data:
         del(tmp)
          
         fin = open("{0}/b.0010000".format(path), "rb")
+        skip_restart_header(fin, n)
         raw = fin.read(nx*nz*8)
         tmp = np.array(st.unpack('{0}d'.format(nx*nz), raw))
         del(raw)
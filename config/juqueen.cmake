@@ -19,6 +19,6 @@ set(NETCDF_LIB_CPP     "/bgsys/local/netcdf/lib/libnetcdf_c++.a")
 set(HDF5_LIB_1         "/bgsys/local/hdf5/lib/libhdf5.a")
 set(HDF5_LIB_2         "/bgsys/local/hdf5/lib/libhdf5_hl.a")
 set(SZIP_LIB           "")
-set(LIBS ${FFTW_LIB} ${NETCDF_LIB_CPP} ${NETCDF_LIB_C} ${HDF5_LIB_2} ${HDF5_LIB_1} ${SZIP_LIB} m)
+set(LIBS ${FFTW_LIB} ${NETCDF_LIB_CPP} ${NETCDF_LIB_C} ${HDF5_LIB_2} ${HDF5_LIB_1} ${SZIP_LIB} m z)
 
 add_definitions(-DRESTRICTKEYWORD=__restrict__)
@@ -52,6 +52,12 @@ class Advec
         virtual unsigned long get_time_limit(unsigned long, double) = 0; ///< Get the maximum time step imposed by advection scheme
         virtual double get_cfl(double) = 0; ///< Retrieve the CFL number.
 
+        // Split execution to overlap the ghost cell exchange, by default everything is done in exec_boundary.
+        virtual void exec_interior() {}         ///< Execute the advection scheme in the part of the domain that does not need ghost cells.
+        virtual void exec_boundary() { exec(); } ///< Execute the advection scheme in the rest of the domain.
+
+        virtual bool includes_diff() { return false; } ///< Check whether the scheme computes the diffusion tendencies as well.
+
     protected:
         Master* master; ///< Pointer to master class.
         Model*  model;  ///< Pointer to model class.
@@ -23,6 +23,7 @@
 #ifndef ADVEC_2
 #define ADVEC_2
 
+#include <vector>
 #include "advec.h"
 
 class Model;
@@ -38,15 +39,40 @@ class Advec_2 : public Advec
         ~Advec_2();              ///< Destructor of the advection class.
 
         void exec(); ///< Execute the advection scheme.
+#ifndef USECUDA
+        void exec_interior(); ///< Execute the advection scheme in the part of the domain that does not need ghost cells.
+        void exec_boundary(); ///< Execute the advection scheme in the rest of the domain.
+#endif
+        bool includes_diff(); ///< Check whether the diffusion is fused into the advection kernels.
+
         unsigned long get_time_limit(long unsigned int, double); ///< Get the limit on the time step imposed by the advection scheme.
         double get_cfl(double); ///< Get the CFL number.
 
     private:
+        std::string swfusediff; ///< Switch for computing the 2nd order diffusion in the same sweep as the advection.
+
         double calc_cfl(double*, double*, double*, double*, double); ///< Calculate the CFL number.
 
-        void advec_u(double*, double*, double*, double*, double*, double*, double*);          ///< Calculate longitudinal velocity advection.
-        void advec_v(double*, double*, double*, double*, double*, double*, double*);          ///< Calculate latitudinal velocity advection.
-        void advec_w(double*, double*, double*, double*, double*, double*, double*);          ///< Calculate vertical velocity advection.
-        void advec_s(double*, double*, double*, double*, double*, double*, double*, double*); ///< Calculate scalar advection.
+        void exec_box(int, int, int, int, int, int); ///< Execute the advection scheme in a box of the domain.
+        void exec_box_fused(int, int, int, int, int, int); ///< Execute the advection and diffusion in a box of the domain.
+
+        void advec_u(double*, double*, double*, double*, double*, double*, double*,
+                     int, int, int, int, int, int); ///< Calculate longitudinal velocity advection.
+        void advec_v(double*, double*, double*, double*, double*, double*, double*,
+                     int, int, int, int, int, int); ///< Calculate latitudinal velocity advection.
+        void advec_w(double*, double*, double*, double*, double*, double*, double*,
+                     int, int, int, int, int, int); ///< Calculate vertical velocity advection.
+        void advec_s(const std::vector<double*>&, const std::vector<double*>&, double*, double*, double*, double*, double*, double*,
+                     int, int, int, int, int, int); ///< Calculate the advection of all scalars in one sweep.
+
+        void advec_diff_u(double*, double*, double*, double*, double*, double*, double*, double*, double,
+                          int, int, int, int, int, int); ///< Calculate longitudinal velocity advection and diffusion.
+        void advec_diff_v(double*, double*, double*, double*, double*, double*, double*, double*, double,
+                          int, int, int, int, int, int); ///< Calculate latitudinal velocity advection and diffusion.
+        void advec_diff_w(double*, double*, double*, double*, double*, double*, double*, double*, double,
+                          int, int, int, int, int, int); ///< Calculate vertical velocity advection and diffusion.
+        void advec_diff_s(const std::vector<double*>&, const std::vector<double*>&, double*, double*, double*,
+                          double*, double*, double*, double*, const std::vector<double>&,
+                          int, int, int, int, int, int); ///< Calculate the advection and diffusion of all scalars in one sweep.
 };
 #endif
@@ -23,6 +23,7 @@
 #ifndef ADVEC_4
 #define ADVEC_4
 
+#include <vector>
 #include "advec.h"
 #include "defines.h"
 
@@ -52,6 +53,6 @@ class Advec_4 : public Advec
         template<bool>
         void advec_w(double* restrict, double* restrict, double* restrict, double* restrict, double* restrict); ///< Calculate vertical velocity advection.
         template<bool>
-        void advec_s(double* restrict, double* restrict, double* restrict, double* restrict, double* restrict, double* restrict); ///< Calculate scalar advection.
+        void advec_s(const std::vector<double*>&, const std::vector<double*>&, double* restrict, double* restrict, double* restrict, double* restrict); ///< Calculate the advection of all scalars in one sweep.
 };
 #endif
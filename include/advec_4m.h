@@ -23,6 +23,7 @@
 #ifndef ADVEC_4M
 #define ADVEC_4M
 
+#include <vector>
 #include "advec.h"
 
 class Model;
@@ -49,6 +50,6 @@ class Advec_4m : public Advec
         void advec_u(double*, double*, double*, double*, double*);          ///< Calculate longitudinal velocity advection.
         void advec_v(double*, double*, double*, double*, double*);          ///< Calculate latitudinal velocity advection.
         void advec_w(double*, double*, double*, double*, double*);          ///< Calculate vertical velocity advection.
-        void advec_s(double*, double*, double*, double*, double*, double*); ///< Calculate scalar advection.
+        void advec_s(const std::vector<double*>&, const std::vector<double*>&, double*, double*, double*, double*); ///< Calculate the advection of all scalars in one sweep.
 };
 #endif
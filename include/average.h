@@ -0,0 +1,97 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2015 Chiel van Heerwaarden
+ * Copyright (c) 2011-2015 Thijs Heus
+ * Copyright (c) 2014-2015 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AVERAGE
+#define AVERAGE
+
+#include <map>
+
+class Master;
+class Model;
+class Grid;
+class Fields;
+
+/**
+ * Class for the in-situ time averaging of 3d fields.
+ * The running mean, variance and covariance of the selected fields are accumulated
+ * in memory every sample time and the averaged fields are written to disk at the
+ * end of every averaging window.
+ */
+class Average
+{
+    public:
+        Average(Model*, Input*);
+        ~Average();
+
+        void init(double);
+        void create(unsigned long);
+
+        unsigned long get_time_limit(unsigned long);
+        std::string get_switch();
+        void get_fieldlist(std::vector<std::string>*); ///< Appends the names of the averaged fields.
+
+        bool do_average();
+        void exec();
+
+        void save(int); ///< Saves the running statistics for a restart, including the sample at the current time.
+        void load(int); ///< Loads the running statistics of a restart, if available.
+        void exec_save(); ///< Writes the pending restart of the running statistics after the sample has been added.
+
+    private:
+        Master* master;
+        Model*  model;
+        Grid*   grid;
+        Fields* fields;
+
+        std::string swaverage;
+
+        double sampletime;  ///< Time between two samples [s].
+        double averagetime; ///< Length of the averaging window [s].
+        unsigned long isampletime;
+        unsigned long iaveragetime;
+        unsigned long istarttime; ///< Integer time at the start of the run, which is not sampled.
+
+        int nsamples; ///< Number of samples in the current window.
+
+        bool savepending;        ///< Boolean to check whether the restart is written after the next sample.
+        int saveiotime;          ///< Time of the restart files that are written after the next sample.
+        unsigned long isavetime; ///< Integer time of the restart files that are written after the next sample.
+
+        std::vector<std::string> meanlist; ///< List with the fields of which the mean is saved.
+        std::vector<std::string> varlist;  ///< List with the fields of which the variance is saved.
+        std::vector<std::string> covlist;  ///< List with the pairs of fields of which the covariance is saved, as a*b.
+
+        struct Covariance
+        {
+            std::string name1; ///< Name of the first field.
+            std::string name2; ///< Name of the second field, equal to the first for a variance.
+            double* data;      ///< Running sum of the products of the deviations from the mean.
+        };
+
+        std::map<std::string, double*> means; ///< Running means of all fields that are needed.
+        std::vector<Covariance> covs;         ///< Running sums of the variances and covariances.
+
+        int check_field(std::string);
+        void save(double*, double, std::string);
+        void save_restart(int);
+};
+#endif
@@ -53,11 +53,14 @@ class Boundary
 
         virtual void set_values(); ///< Set all 2d fields to the prober BC value.
 
-        virtual void exec(); ///< Update the boundary conditions.
+        virtual void exec();       ///< Update the boundary conditions.
+        virtual void exec_start(); ///< Start the exchange of the ghost cells of the prognostic fields.
+        virtual void exec_end();   ///< Complete the ghost cell exchange and update the boundary conditions.
         virtual void set_ghost_cells_w(Boundary_w_type); ///< Update the boundary conditions.
 
         virtual void exec_stats(Mask*); ///< Execute statistics of surface
         virtual void exec_cross();       ///< Execute cross sections of surface
+        virtual void exec_column();      ///< Sample the surface values in the columns
 
         virtual void get_mask(Field3d*, Field3d*, Mask*); ///< Calculate statistics mask
         virtual void get_surface_mask(Field3d*);          ///< Calculate surface mask
@@ -105,6 +108,8 @@ class Boundary
         std::vector<std::string> timedeplist;
         std::map<std::string, double*> timedepdata;
 
+        std::vector<double*> cyclic_fields; ///< Fields of which the ghost cells are exchanged in exec_start.
+
         void process_bcs(Input *); ///< Process the boundary condition settings from the ini file.
 
         void process_time_dependent(Input *); ///< Process the time dependent settings from the ini file.
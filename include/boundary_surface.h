@@ -43,6 +43,7 @@ class Boundary_surface : public Boundary
 
         void exec_stats(Mask*); ///< Execute statistics of surface
         void exec_cross();      ///< Execute cross sections of surface
+        void exec_column();     ///< Sample the surface values in the columns
 
         // Make these variables public for out-of-class usage.
         double* obuk;
@@ -0,0 +1,112 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2015 Chiel van Heerwaarden
+ * Copyright (c) 2011-2015 Thijs Heus
+ * Copyright (c) 2014-2015 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COLUMN
+#define COLUMN
+
+#include <vector>
+#include <map>
+#include <netcdfcpp.h>
+
+class Master;
+class Model;
+class Grid;
+class Fields;
+
+/**
+ * Class for the output of vertical columns at fixed locations, comparable to measurement towers.
+ * The columns are sampled every time step and kept in memory by the process that contains them.
+ * At every sync time, the samples are collected and written to a single file.
+ */
+class Column
+{
+    public:
+        Column(Model*, Input*);
+        ~Column();
+
+        void init(double);
+        void create(int);
+
+        unsigned long get_time_limit(unsigned long);
+        std::string get_switch();
+        std::vector<std::string>* get_columnlist();
+
+        bool do_column();
+        void exec(int, double, unsigned long);
+
+        void add_prof(std::string, std::string, std::string, std::string); ///< Add a variable with a value per level.
+        void add_time_series(std::string, std::string, std::string);       ///< Add a variable with a single value.
+
+        void calc_column(std::string, const double*, const double); ///< Sample a 3d field in all columns.
+        void calc_time_series(std::string, const double*);          ///< Sample a 2d field in all columns.
+
+        void write_buffer(); ///< Write the samples that are kept in memory to the file.
+
+    private:
+        void gather_buffer(const std::vector<double>&, std::vector<double>&, int); ///< Collect the samples of all columns at the main process.
+
+        Master* master;
+        Model*  model;
+        Grid*   grid;
+        Fields* fields;
+
+        std::string swcolumn;
+
+        double synctime;          ///< Time interval at which the samples are written to disk.
+        unsigned long isynctime;
+
+        std::vector<double> coordx; ///< X-position [m] of the columns from the ini file.
+        std::vector<double> coordy; ///< Y-position [m] of the columns from the ini file.
+        std::vector<int> icol;      ///< Index of the nearest full x position of the columns.
+        std::vector<int> jcol;      ///< Index of the nearest full y position of the columns.
+
+        std::vector<int> colown;   ///< Indices of the columns in the subdomain of this process.
+        std::vector<int> ncolproc; ///< Number of columns per process, only at the main process.
+        std::vector<int> colproc;  ///< Indices of the columns in the order of the processes, only at the main process.
+
+        std::vector<std::string> columnlist; ///< List with all fields in the columns from the ini file.
+
+        struct Column_var
+        {
+            NcVar* ncvar;
+            int nlevels;                ///< Number of levels, one for a time series.
+            std::vector<double> buffer; ///< Samples of the columns of this process that are not yet written.
+        };
+
+        typedef std::map<std::string, Column_var> Column_map;
+        Column_map vars;
+
+        NcFile* dataFile;
+        NcDim* z_dim;
+        NcDim* zh_dim;
+        NcDim* t_dim;
+        NcDim* col_dim;
+        NcVar* iter_var;
+        NcVar* t_var;
+
+        std::vector<int> iterbuf; ///< Iteration numbers of the samples that are not yet written.
+        std::vector<double> tbuf; ///< Times of the samples that are not yet written.
+
+        int nstats;    ///< Number of samples that are written to the file.
+        int nbuffered; ///< Number of samples that are kept in memory.
+};
+#endif
@@ -23,6 +23,7 @@
 #ifndef CROSS
 #define CROSS
 
+#include <cstdio>
 #include <netcdfcpp.h>
 
 class Master;
@@ -49,6 +50,9 @@ class Cross
         std::string swcross;
         bool do_cross();
 
+        void start_output();  ///< Opens the file with all cross sections of this time, if aggregated.
+        void finish_output(); ///< Closes the file with all cross sections of this time, if aggregated.
+
         int cross_simple(double*, double*, std::string);
         int cross_lngrad(double*, double*, double*, double*, std::string);
         int cross_plane (double*, double*, std::string);
@@ -64,6 +68,10 @@ class Cross
         double sampletime;
         unsigned long isampletime;
 
+        std::string swaggregate;  ///< Switch for writing all cross sections of one time into a single file.
+        std::FILE* indexfile;     ///< Index file that lists the cross sections in the aggregated file.
+        unsigned long fileoffset; ///< Offset in bytes of the next cross section in the aggregated file.
+
         std::vector<std::string> crosslist; ///< List with all crosses from the ini file.
 
         std::vector<int> jxz;   ///< Index of nearest full y position of xz input
@@ -84,6 +92,7 @@ class Cross
 
         int check_list(std::vector<std::string> *, FieldMap *, std::string crossname);
         int check_save(int, char *);
+        int save_slice(double*, double*, std::string, std::string, int);
 };
 #endif
 
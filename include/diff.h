@@ -43,6 +43,10 @@ class Diff
         virtual void exec_viscosity() = 0;
         virtual void exec() = 0;
 
+        // Split execution to overlap the ghost cell exchange, by default everything is done in exec_boundary.
+        virtual void exec_interior() {}
+        virtual void exec_boundary() { exec(); }
+
         virtual unsigned long get_time_limit(unsigned long, double) = 0;
         virtual double get_dn(double) = 0;
 
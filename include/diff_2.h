@@ -23,6 +23,7 @@
 #ifndef DIFF_2
 #define DIFF_2
 
+#include <vector>
 #include "diff.h"
 
 class Diff_2 : public Diff
@@ -34,6 +35,11 @@ class Diff_2 : public Diff
         void set_values();
         void exec();
 
+        #ifndef USECUDA
+        void exec_interior();
+        void exec_boundary();
+        #endif
+
         unsigned long get_time_limit(unsigned long, double);
         double get_dn(double);
 
@@ -47,7 +53,11 @@ class Diff_2 : public Diff
     private:
         double dnmul;
 
-        void diff_c(double*, double*, double*, double*, double);
-        void diff_w(double*, double*, double*, double*, double);
+        void exec_box(int, int, int, int, int, int);
+
+        void diff_c(const std::vector<double*>&, const std::vector<double*>&, double*, double*, const std::vector<double>&,
+                    int, int, int, int, int, int);
+        void diff_w(double*, double*, double*, double*, double,
+                    int, int, int, int, int, int);
 };
 #endif
@@ -23,6 +23,7 @@
 #ifndef DIFF_4
 #define DIFF_4
 
+#include <vector>
 #include "diff.h"
 #include "defines.h"
 
@@ -49,7 +50,7 @@ class Diff_4 : public Diff
         double dnmul;
 
         template<bool>
-        void diff_c(double* restrict, double* restrict, double* restrict, double* restrict, double);
+        void diff_c(const std::vector<double*>&, const std::vector<double*>&, double* restrict, double* restrict, const std::vector<double>&);
         template<bool> 
         void diff_w(double* restrict, double* restrict, double* restrict, double* restrict, double);
 };
@@ -23,6 +23,7 @@
 #ifndef DIFF_SMAG_2
 #define DIFF_SMAG_2
 
+#include <vector>
 #include "diff.h"
 
 class Diff_smag_2 : public Diff
@@ -76,7 +77,7 @@ class Diff_smag_2 : public Diff
         void diff_v(double*, double*, double*, double*, double*, double*, double*, double*, double*, double*, double*);
 
         void diff_w(double*, double*, double*, double*, double*, double*, double*, double*, double*);
-        void diff_c(double*, double*, double*, double*, double*, double*, double*, double*, double*, double);
+        void diff_c(const std::vector<double*>&, const std::vector<double*>&, double*, double*, double*, const std::vector<double*>&, const std::vector<double*>&, double*, double*, double);
 
         double calc_dnmul(double*, double*, double);
 
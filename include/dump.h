@@ -55,5 +55,20 @@ class Dump
 
         double sampletime;
         unsigned long isampletime;
+
+        std::string dumpformat; ///< Precision of the dumped fields, double or float.
+        std::string swcompress; ///< Switch for the lossless compression of the dumped fields.
+
+        void calc_packing(double*, double*, double*); ///< Calculate the offset and scale of a field to store it in single precision.
+
+        // region of interest and coarsening
+        double xmin, xmax; ///< Bounds in the x-direction of the region that is dumped [m].
+        double ymin, ymax; ///< Bounds in the y-direction of the region that is dumped [m].
+        double zmin, zmax; ///< Bounds in the z-direction of the region that is dumped [m].
+        int coarse[3];     ///< Number of cells in x, y and z that are averaged into one value.
+        int region[6];     ///< Start and end indices in x, y and z of the region that is dumped.
+        bool subdump;      ///< Boolean that is true if the dump is smaller than the full domain.
+
+        void init_region(); ///< Calculate the indices of the region that is dumped.
 };
 #endif
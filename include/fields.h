@@ -49,6 +49,7 @@ class Fields
         void exec();
         void get_mask(Field3d*, Field3d*, Mask*);
         void exec_stats(Mask*);
+        void exec_spectra(); ///< Calculate the horizontal spectra of the selected fields.
 
         void init_momentum_field  (Field3d*&, Field3d*&, std::string, std::string, std::string);
         void init_prognostic_field(std::string, std::string, std::string);
@@ -57,6 +58,11 @@ class Fields
 
         void save(int);
         void load(int);
+        void progress_save(); ///< Lets a pending asynchronous save progress.
+        void finish_save();   ///< Waits for a pending asynchronous save to complete.
+        void prefetch(int);   ///< Starts loading the fields of the given time in the background.
+        void progress_prefetch(); ///< Lets a pending prefetch progress.
+        void create_loadlist(); ///< Selects the prognostic fields that are read from disk.
 
         double check_momentum();
         double check_tke();
@@ -66,6 +72,7 @@ class Fields
 
         void exec_cross();
         void exec_dump();
+        void exec_column(); ///< Sample the selected fields in the columns.
 
         Field3d* u; ///< Field3d instance of x velocity component
         Field3d* v; ///< Field3d instance of y velocity component
@@ -123,9 +130,25 @@ class Fields
 
         bool calc_mean_profs;
 
+        // asynchronous saving of the restart files
+        std::string swasyncsave;       ///< Switch for saving the prognostic fields while the model continues.
+        std::vector<double*> savebufs; ///< Staging buffers that hold the copies of the fields that are being saved.
+        bool savepending;              ///< Boolean to check whether an asynchronous save is in progress.
+
+        // prefetching of the fields in post processing mode
+        std::string swprefetch;        ///< Switch for loading the fields of the next time while the statistics are computed.
+        std::vector<int> prefetched;   ///< Flags of the fields of which the prefetch has been started.
+        int prefetchtime;              ///< Time of the prefetched fields, -1 if none.
+
+        // selective loading of the fields in post processing mode
+        std::vector<std::string> loadlist; ///< List with the prognostic fields that are read from disk.
+        bool is_loaded(std::string);
+
         // cross sections
         std::vector<std::string> crosslist; ///< List with all crosses from the ini file.
         std::vector<std::string> dumplist;  ///< List with all 3d dumps from the ini file.
+        std::vector<std::string> spectralist; ///< List with the fields of which the spectra are computed.
+        std::vector<std::string> columnlist;  ///< List with the fields that are sampled in the columns.
 
         // Cross sections split per type.
         std::vector<std::string> crosssimple;
@@ -27,6 +27,9 @@
 #include <mpi.h>
 #endif
 #include <fftw3.h>
+#include <cstdio>
+#include <vector>
+#include <map>
 #include "input.h"
 
 class Model;
@@ -114,11 +117,18 @@ class Grid
 
         void set_minimum_ghost_cells(int, int, int);
 
+        static const int nboxes = 7; ///< Number of boxes the domain is split in for overlapping communication.
+        void get_box(int&, int&, int&, int&, int&, int&, int); ///< Get the bounds of a box, box 0 is the interior that does not need ghost cells.
+
         // MPI functions
         void init_mpi(); ///< Creates the MPI data types used in grid operations.
         void exit_mpi(); ///< Destructs the MPI data types used in grid operations.
         void boundary_cyclic   (double*, Edge=Both_edges); ///< Fills the ghost cells in the periodic directions.
         void boundary_cyclic_2d(double*); ///< Fills the ghost cells of one slice in the periodic direction.
+        void boundary_cyclic_start(double*); ///< Starts filling the ghost cells in the periodic directions without waiting.
+        void boundary_cyclic_end  (double*); ///< Completes the filling of the ghost cells started with boundary_cyclic_start.
+        void boundary_cyclic_start(const std::vector<double*>&); ///< Starts filling the ghost cells of a set of fields with one message per neighbor.
+        void boundary_cyclic_end  (const std::vector<double*>&); ///< Completes the filling of the ghost cells of a set of fields.
         void transpose_zx(double*, double*); ///< Changes the transpose orientation from z to x.
         void transpose_xz(double*, double*); ///< Changes the transpose orientation from x to z.
         void transpose_xy(double*, double*); ///< changes the transpose orientation from x to y.
@@ -129,25 +139,46 @@ class Grid
         void get_max (double*);      ///< Gets the maximum of a number over all processes.
         void get_sum (double*);      ///< Gets the sum of a number over all processes.
         void get_prof(double*, int); ///< Averages a vertical profile over all processes.
+        void get_min (unsigned long*, int); ///< Gets the minimum of an array of numbers over all processes.
+
+        void begin_deferred_reductions(); ///< Lets get_max and get_sum keep the local value, the reduction is done by exec_reductions.
+        void end_deferred_reductions();   ///< Lets get_max and get_sum reduce directly again.
+        void add_max(double*);            ///< Registers a local value of which the maximum over all processes is needed.
+        void add_sum(double*);            ///< Registers a local value of which the sum over all processes is needed.
+        void exec_reductions();           ///< Reduces all registered values in a single collective call.
         void calc_mean(double*, const double*, int);
 
         // IO functions
-        int save_field3d(double*, double*, double*, char*, double); ///< Saves a full 3d field.
-        int load_field3d(double*, double*, double*, char*, double); ///< Loads a full 3d field.
+        int save_field3d(double*, double*, double*, char*, double, bool); ///< Saves a full 3d field, with a header describing the grid if requested.
+        int load_field3d(double*, double*, double*, char*, double); ///< Loads a full 3d field, with or without header.
+        int save_field3d_start(double*, double*, double*, char*, double, bool); ///< Starts the saving of a full 3d field, the third array is written and has to remain untouched until save_field3d_end.
+        int save_field3d_end();      ///< Completes the saving of all 3d fields started with save_field3d_start.
+        int save_field3d_packed(double*, double*, double*, char*, double, double, bool, bool); ///< Saves a full 3d field in single precision and/or compressed, preceded by a header.
+        int save_field3d_sub(double*, double*, char*, double, const int[6], const int[3], const int[3]); ///< Saves a block averaged region of a 3d field.
+        void progress_field3d_save(); ///< Lets the pending saves of 3d fields progress without waiting for them.
+        int load_field3d_start(char*); ///< Starts reading a full 3d field in the background.
+        int load_field3d_end(double*, double*, double*, char*, double); ///< Completes the reading of the file started with load_field3d_start and stores the field.
+        void progress_field3d_load(); ///< Lets the pending loads of 3d fields progress without waiting for them.
 
         int save_xz_slice(double*, double*, char*, int);           ///< Saves a xz-slice from a 3d field.
         int save_yz_slice(double*, double*, char*, int);           ///< Saves a yz-slice from a 3d field.
         int save_xy_slice(double*, double*, char*, int kslice=-1); ///< Saves a xy-slice from a 3d field.
         int load_xy_slice(double*, double*, char*, int kslice=-1); ///< Loads a xy-slice.
 
+        int open_slice_file(char*);                             ///< Opens a file that contains multiple slices.
+        int close_slice_file();                                 ///< Closes the file that contains multiple slices.
+        int write_xz_slice(double*, double*, int, unsigned long); ///< Writes a xz-slice at the given byte offset in the open slice file.
+        int write_yz_slice(double*, double*, int, unsigned long); ///< Writes a yz-slice at the given byte offset in the open slice file.
+        int write_xy_slice(double*, double*, int, unsigned long); ///< Writes a xy-slice at the given byte offset in the open slice file, -1 for a 2d plane.
+
         // Fourier tranforms
         double*fftini, *fftouti; ///< Help arrays for fast-fourier transforms in x-direction.
         double*fftinj, *fftoutj; ///< Help arrays for fast-fourier transforms in y-direction.
         fftw_plan iplanf, iplanb; ///< FFTW3 plans for forward and backward transforms in x-direction.
         fftw_plan jplanf, jplanb; ///< FFTW3 plans for forward and backward transforms in y-direction.
 
-        void fft_forward (double*, double*, double*, double*, double*, double*); ///< Forward fast-fourier transform.
-        void fft_backward(double*, double*, double*, double*, double*, double*); ///< Backward fast-fourier transform.
+        void fft_forward (double*, double*, double*, double*, double*, double*, double*); ///< Forward fast-fourier transform.
+        void fft_backward(double*, double*, double*, double*, double*, double*, double*); ///< Backward fast-fourier transform.
 
         // interpolation functions
         void interpolate_2nd(double*, const double*, const int[3], const int[3]); ///< Second order interpolation
@@ -185,6 +216,30 @@ class Grid
         bool mpitypes;  ///< Boolean to check whether MPI datatypes are created.
         bool fftwplan;  ///< Boolean to check whether FFTW3 plans are created.
 
+        int fftchunk; ///< Number of vertical levels per chunk in the pipelined transposes, 0 switches the pipelining off.
+
+        unsigned int fftwflags;    ///< Planner flags of the FFTW3 plans.
+        double fftwtimelimit;      ///< Time limit of the FFTW3 planner in seconds, negative for no limit.
+        std::string fftwwisdomdir; ///< Directory of the FFTW3 wisdom cache that is shared between cases, empty if not used.
+
+        void create_fftw_plans();            ///< Creation of the FFTW3 plans with the chosen planner settings.
+        std::string get_wisdom_cache_name(); ///< Name of the file in the wisdom cache that belongs to this grid.
+        bool import_wisdom_cache();          ///< Import the wisdom of this grid from the cache, if available.
+        void export_wisdom_cache();          ///< Store the current wisdom in the cache.
+
+        bool deferreductions;            ///< Boolean to check whether get_max and get_sum are deferred.
+        std::vector<double*> reducevars; ///< Values registered for the combined reduction.
+        std::vector<int> reduceops;      ///< Type of reduction per registered value, 0 for sum and 1 for max.
+
+        void calc_coarse_block(double*, const double*, double, const int[6], const int[3], const int[3]); ///< Block averages a part of the subdomain.
+
+        static const int field3dheaderlength = 8; ///< Number of integers in the header of a 3d field.
+        void set_field3d_header(int*); ///< Fills the header of a 3d field.
+        void set_field3d_packed_header(int*, bool, bool); ///< Fills the header of a packed 3d field.
+        int check_field3d_header(const int*, long long, long long*, char*); ///< Checks the header of a 3d field and returns the position of the data.
+
+        static int compress_block(std::vector<unsigned char>&, const unsigned char*, int, int); ///< Byte shuffle and deflate a block of values.
+
         void calculate(); ///< Computation of dimensions, faces and ghost cells.
         void check_ghost_cells(); ///< Check whether slice thickness is at least equal to number of ghost cells.
 
@@ -194,6 +249,9 @@ class Grid
         MPI_Datatype northsouthedge;   ///< MPI datatype containing the ghostcells at the north-south sides.
         MPI_Datatype eastwestedge2d;   ///< MPI datatype containing the ghostcells for one slice at the east-west sides.
         MPI_Datatype northsouthedge2d; ///< MPI datatype containing the ghostcells for one slice at the north-south sides.
+        MPI_Datatype eastwestface;     ///< MPI datatype containing the ghostcells at the east-west sides without the corners.
+        MPI_Datatype northsouthface;   ///< MPI datatype containing the ghostcells at the north-south sides without the corners.
+        MPI_Datatype corneredge;       ///< MPI datatype containing the ghostcells in one of the corners.
 
         MPI_Datatype transposez;  ///< MPI datatype containing base blocks for z-orientation in zx-transpose.
         MPI_Datatype transposez2; ///< MPI datatype containing base blocks for z-orientation in zy-transpose.
@@ -202,6 +260,13 @@ class Grid
         MPI_Datatype transposey;  ///< MPI datatype containing base blocks for y-orientation in xy-transpose.
         MPI_Datatype transposey2; ///< MPI datatype containing base blocks for y-orientation in zy-transpose.
 
+        MPI_Datatype transposezchunk;  ///< MPI datatype containing one chunk of levels of transposez.
+        MPI_Datatype transposez2chunk; ///< MPI datatype containing one chunk of levels of transposez2.
+        MPI_Datatype transposexchunk;  ///< MPI datatype containing one chunk of levels of transposex.
+        MPI_Datatype transposex2chunk; ///< MPI datatype containing one chunk of levels of transposex2.
+        MPI_Datatype transposeychunk;  ///< MPI datatype containing one chunk of levels of transposey.
+        MPI_Datatype transposey2chunk; ///< MPI datatype containing one chunk of levels of transposey2.
+
         MPI_Datatype subi;       ///< MPI datatype containing a subset of the entire x-axis.
         MPI_Datatype subj;       ///< MPI datatype containing a subset of the entire y-axis.
         MPI_Datatype subarray;   ///< MPI datatype containing the dimensions of the total array that is contained in one process.
@@ -209,7 +274,55 @@ class Grid
         MPI_Datatype subyzslice; ///< MPI datatype containing only one yz-slice.
         MPI_Datatype subxyslice; ///< MPI datatype containing only one xy-slice.
 
+        int write_field3d_header(MPI_File); ///< Writes the header of a 3d field.
+
+        MPI_Datatype reducepair; ///< MPI datatype containing the type of reduction and the value of a registered value.
+        MPI_Op reduceop;         ///< MPI operation that takes the sum or the maximum depending on the type of reduction.
+
         double* profl; ///< Help array used in profile writing.
+
+        // Pending saves of 3d fields started with save_field3d_start.
+        std::vector<MPI_File> savefiles;    ///< File handles of the pending saves.
+        std::vector<MPI_Request> savereqs;  ///< Requests of the pending saves.
+        std::vector<double*> savebuffers;   ///< Arrays that are written by the pending saves.
+
+        // Pending loads of 3d fields started with load_field3d_start.
+        std::vector<MPI_File> loadfiles;    ///< File handles of the pending loads.
+        std::vector<MPI_Request> loadreqs;  ///< Requests of the pending loads.
+        std::vector<double*> loadbuffers;   ///< Arrays that are read by the pending loads.
+        std::vector<std::string> loadnames; ///< Names of the files of the pending loads.
+        std::vector<double*> loadpool;      ///< Arrays of completed loads that are reused by the next loads.
+
+        double* halobuf; ///< Send and receive buffers for the aggregated ghost cell exchange.
+        int nhalobuf;    ///< Size of the ghost cell exchange buffers.
+        int nhalofields; ///< Number of fields the persistent requests of the aggregated exchange are made for.
+
+        // Persistent requests, created at the first exchange of a field or pair of arrays.
+        typedef std::map<std::pair<double*, double*>, std::vector<MPI_Request> > Request_map;
+        std::map<double*, std::vector<MPI_Request> > haloreqs; ///< Persistent requests of the ghost cell exchange per field.
+        std::vector<MPI_Request> halobufreqs; ///< Persistent requests of the aggregated ghost cell exchange.
+        Request_map zxreqs; ///< Persistent requests of the zx-transpose per pair of arrays.
+        Request_map xzreqs; ///< Persistent requests of the xz-transpose per pair of arrays.
+        Request_map xyreqs; ///< Persistent requests of the xy-transpose per pair of arrays.
+        Request_map yxreqs; ///< Persistent requests of the yx-transpose per pair of arrays.
+        Request_map yzreqs; ///< Persistent requests of the yz-transpose per pair of arrays.
+        Request_map zyreqs; ///< Persistent requests of the zy-transpose per pair of arrays.
+
+        void init_halo_requests(std::vector<MPI_Request>&, double*); ///< Create the persistent requests of the ghost cell exchange of a field.
+        void start_wait_all(std::vector<MPI_Request>&); ///< Start a set of persistent requests and wait for them to complete.
+        void free_requests (std::vector<MPI_Request>&); ///< Free a set of persistent requests.
+
+        void fft_forward_pipelined (double*, double*, double*, double*, double*, double*, double*); ///< Forward fast-fourier transform with chunked transposes.
+        void fft_backward_pipelined(double*, double*, double*, double*, double*, double*, double*); ///< Backward fast-fourier transform with chunked transposes.
+
+        void pack_halo  (double*, const double*, int, int, int, int);
+        void unpack_halo(double*, const double*, int, int, int, int);
+
+        MPI_File slicefile; ///< File that contains multiple slices.
+
+        int write_slice(double*, int, MPI_Datatype, bool, unsigned long); ///< Collective write of a slice in the open slice file.
+#else
+        std::FILE* slicefile; ///< File that contains multiple slices.
 #endif
 };
 #endif
@@ -26,7 +26,9 @@
 #ifdef USEMPI
 #include <mpi.h>
 #endif
+#include <cstdio>
 #include <string>
+#include <map>
 #include "input.h"
 
 class Input;
@@ -61,6 +63,16 @@ class Master
         // overload the min function
         void min(double *, int);
 
+        // overload the gather function, which collects data of different size per process at the main process
+        void gather(int *, int, int *, const int *);
+        void gather(double *, int, double *, const int *);
+
+        // timers of the stages of the model, all processes have to call them in the same way
+        void start_timer(const std::string&); ///< Starts the timer with the given name, creates it if needed.
+        void stop_timer (const std::string&); ///< Stops the timer and adds the elapsed time to its totals.
+        void write_timers(int, double);       ///< Writes the timings since the previous call to the .timing file, if enabled.
+        void print_timers();                  ///< Prints the minimum, mean and maximum timings over all processes.
+
         void print_message(const char *format, ...);
         void print_warning(const char *format, ...);
         void print_error  (const char *format, ...);
@@ -75,11 +87,17 @@ class Master
         int mpicoordx;
         int mpicoordy;
 
+        int nthreads; ///< Number of shared memory threads per process.
+
 #ifdef USEMPI
         int nnorth;
         int nsouth;
         int neast;
         int nwest;
+        int nnortheast;
+        int nnorthwest;
+        int nsoutheast;
+        int nsouthwest;
 
         MPI_Comm commxy;
         MPI_Comm commx;
@@ -96,6 +114,23 @@ class Master
         double wall_clock_start;
         double wall_clock_end;
 
+        struct Timer
+        {
+            double start;         ///< Wall clock time of the latest start of the timer.
+            double total;         ///< Elapsed time over the entire run.
+            double interval;      ///< Elapsed time since the latest write of the timing file.
+            unsigned long ncalls; ///< Number of times the timer is stopped.
+        };
+
+        std::map<std::string, Timer> timers; ///< Timers per stage of the model.
+        std::string swtiming;                ///< Switch for the writing of the timers to the .timing file.
+        std::FILE* timingfile;               ///< File that holds the timings per check interval.
+        bool timingopened;                   ///< Boolean to check whether the opening of the timing file has been done on all processes.
+
+        bool check_timers(); ///< Check whether all processes have the same set of timers.
+
+        void init_threads(); ///< Sets the number of threads for the threaded kernels.
+
 #ifdef USEMPI
         int check_error(int);
 #endif
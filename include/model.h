@@ -40,6 +40,8 @@ class Buffer;
 class Stats;
 class Cross;
 class Dump;
+class Average;
+class Column;
 class Budget;
 
 class Model
@@ -74,6 +76,8 @@ class Model
         Stats*  stats;
         Cross*  cross;
         Dump*   dump;
+        Average* average;
+        Column*  column;
         Budget* budget;
 
     private:
@@ -51,6 +51,9 @@ class Pres_2 : public Pres
         double* c;
         double* work2d;
 
+        double* gam;  ///< Elimination factors of the tridiagonal matrices of all wave numbers.
+        double* beti; ///< Reciprocals of the pivots of the tridiagonal matrices of all wave numbers.
+
 #ifdef USECUDA
         double* bmati_g;
         double* bmatj_g;
@@ -65,15 +68,15 @@ class Pres_2 : public Pres
                    double*, double*, double*,
                    double);
 
-        void solve(double*, double*, double*,
-                   double*, double*,
+        void solve(double*, double*, double*, double*,
                    double*, double*, double*, double*);
 
         void output(double*, double*, double*,
                     double*, double*);
 
-        void tdma(double*, double*, double*, double*, 
-                  double*, double*);
+        void tdma_factorize(double*, double*, double*, double*,
+                            double*, double*);
+        void tdma(double*, double*, double*, double*);
 
         double calc_divergence(double*, double*, double*, double*, double*, double*);
 };
@@ -60,6 +60,17 @@ class Pres_4 : public Pres
         double* m6;
         double* m7;
 
+        // LU factorization of the matrices of all wave numbers, stored per slice.
+        double* m1fac;
+        double* m2fac;
+        double* m3fac;
+        double* m4fac;
+        double* m5fac;
+        double* m6fac;
+        double* m7fac;
+
+        int jslice; ///< Thickness of the slices in the y-direction that are solved together.
+
 #ifdef USECUDA
         double* bmati_g;
         double* bmatj_g;
@@ -85,18 +96,27 @@ class Pres_4 : public Pres
                    double* restrict, double* restrict, double* restrict,
                    double* restrict, double);
 
-        void solve(double* restrict, double* restrict, double* restrict,
+        void factorize(double* restrict, double* restrict, double* restrict, double* restrict,
+                       double* restrict, double* restrict, double* restrict,
+                       double* restrict, double* restrict, double* restrict, double* restrict,
+                       double* restrict, double* restrict, double* restrict,
+                       double* restrict, double* restrict,
+                       int);
+
+        void solve(double* restrict, double* restrict, double* restrict, double* restrict,
                    double* restrict, double* restrict, double* restrict, double* restrict,
                    double* restrict, double* restrict, double* restrict,
-                   double* restrict, double* restrict, double* restrict, double* restrict,
-                   double* restrict, double* restrict, double* restrict, double* restrict,
-                   double* restrict, double* restrict,
+                   double* restrict,
                    int);
 
         template<bool>
         void output(double* restrict, double* restrict, double* restrict,
                     double* restrict, double* restrict);
 
+        void hdma_factorize(double* restrict, double* restrict, double* restrict, double* restrict,
+                            double* restrict, double* restrict, double* restrict,
+                            int);
+
         void hdma(double* restrict, double* restrict, double* restrict, double* restrict,
                   double* restrict, double* restrict, double* restrict, double* restrict,
                   int);
@@ -23,6 +23,7 @@
 #ifndef STATS
 #define STATS
 
+#include <vector>
 #include <netcdfcpp.h>
 
 class Master;
@@ -35,6 +36,8 @@ struct Prof_var
 {
     NcVar*  ncvar;
     double* data;
+    int nlevels;                ///< Number of vertical levels that are written.
+    std::vector<double> buffer; ///< Samples that are not yet written to the file.
 };
 
 // struct for time series
@@ -42,11 +45,22 @@ struct Time_series_var
 {
     NcVar* ncvar;
     double data;
+    std::vector<double> buffer; ///< Samples that are not yet written to the file.
+};
+
+// struct for spectra
+struct Spec_var
+{
+    NcVar*  ncvar;
+    double* data;               ///< Spectra of all levels, with the wave number as fastest index.
+    int nwaves;                 ///< Number of wave numbers of the spectrum.
+    std::vector<double> buffer; ///< Samples that are not yet written to the file.
 };
 
 // typedefs for containers of profiles and time series
 typedef std::map<std::string, Prof_var> Prof_map;
 typedef std::map<std::string, Time_series_var> Time_series_map;
+typedef std::map<std::string, Spec_var> Spec_map;
 
 // structure
 struct Mask
@@ -56,10 +70,17 @@ struct Mask
     NcDim* z_dim;
     NcDim* zh_dim;
     NcDim* t_dim;
+    NcDim* kx_dim;
+    NcDim* ky_dim;
+    NcDim* kr_dim;
     NcVar* iter_var;
     NcVar* t_var;
+    int iorank;                 ///< Process that writes the file of this mask.
+    std::vector<int> iterbuf;   ///< Iteration numbers of the samples that are not yet written.
+    std::vector<double> tbuf;   ///< Times of the samples that are not yet written.
     Prof_map profs;
     Time_series_map tseries;
+    Spec_map specs;             ///< Spectra, which are only part of the default mask.
 };
 
 typedef std::map<std::string, Mask> Mask_map;
@@ -90,9 +111,15 @@ class Stats
         void add_prof(std::string, std::string, std::string, std::string);
         void add_fixed_prof(std::string, std::string, std::string, std::string, double*);
         void add_time_series(std::string, std::string, std::string);
+        void add_spectra(std::string, std::string, std::string); ///< Add the horizontal spectra of a field.
+
+        std::vector<std::string>* get_spectralist();
 
         void calc_area(double*, const int[3], int*);
 
+        void begin_deferred_sums(); ///< Lets the calc functions keep the local sums of the profiles.
+        void end_deferred_sums();   ///< Reduces all deferred profiles at once and normalizes them.
+
         void calc_mean(double* const, const double* const,
                        const double, const int[3],
                        const double* const, const int* const);
@@ -114,6 +141,10 @@ class Stats
         void calc_flux_2nd(double*, double*, double*, double*, double*, double*, const int[3], double*, int*);
         void calc_flux_4th(double*, double*, double*, double*, const int[3], double*, int*);
 
+        void calc_stats_2nd(double*, double*, double*, double*,
+                            double*, double*, double*, double*, double*, double*,
+                            double*, double, const int[3], double*, int*, double*, int*); ///< Calculate the moments, gradient and fluxes in one sweep.
+
         void add_fluxes   (double*, double*, double*);
         void calc_count   (double*, double*, double, double*, int*);
         void calc_path    (double*, double*, int*, double*);
@@ -121,12 +152,38 @@ class Stats
 
         void calc_sorted_prof(double*, double*, double*);
 
+        void calc_spectra(std::string, double*, double*, double*, double*); ///< Calculate the horizontal spectra of a field per level.
+
     private:
-        int nstats;
+        int nstats;    ///< Number of samples that are written to the files.
+        int nbuffered; ///< Number of samples that are kept in memory.
+
+        void write_buffer(); ///< Write the samples that are kept in memory to the files.
+
+        std::vector<std::string> spectralist; ///< List with the fields of which the spectra are computed.
+        std::string swspectra2d;              ///< Switch for the radially averaged 2d spectra.
+        int nkx;     ///< Number of wave numbers of the spectra in the x-direction.
+        int nky;     ///< Number of wave numbers of the spectra in the y-direction.
+        int nkr;     ///< Number of wave numbers of the radially averaged spectra.
+        double dkr;  ///< Width of the wave number bins of the radially averaged spectra.
 
         // mask calculations
         void calc_mask(double*, double*, double*, int*, int*, int*);
 
+        // deferred reductions of the profiles
+        struct Deferred_prof
+        {
+            double* prof;           ///< Profile that contains the local sums.
+            const int* nmask;       ///< Number of grid points in the mask per level.
+            const double* datamean; ///< Mean of which the missing values are missing in the profile, zero if not used.
+        };
+
+        bool defersums; ///< Boolean to check whether the sums of the profiles are deferred.
+        std::vector<Deferred_prof> deferredprofs;
+
+        void sum_prof(double*, const int*, const double*);
+        void normalize_prof(double*, const int*, const double*);
+
     protected:
         Model*  model;
         Grid*   grid;
@@ -135,8 +192,11 @@ class Stats
 
         double sampletime;
         unsigned long isampletime;
+        double synctime;          ///< Time interval at which the samples are written to disk.
+        unsigned long isynctime;
 
         std::string swstats;
+        std::string swnetcdf4;    ///< Switch for writing netCDF-4 (HDF5) files instead of classic netCDF.
 
         static const int nthres = 0;
 };
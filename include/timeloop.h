@@ -25,6 +25,7 @@
 
 #include <sys/time.h>
 #include <string>
+#include <vector>
 
 class Input;
 class Master;
@@ -40,6 +41,7 @@ class Timeloop
 
         void step_time();
         void step_post_proc_time();
+        int get_next_post_proc_iotime(); ///< Returns the iotime of the next post processing time, or -1 at the end.
         void set_time_step();
         void set_time_step_limit();
         void set_time_step_limit(unsigned long);
@@ -81,8 +83,8 @@ class Timeloop
 
         int outputiter;
 
-        void rk3(double*, double*, double);
-        void rk4(double*, double*, double);
+        void rk3(const std::vector<double*>&, const std::vector<double*>&, double); ///< Runge-Kutta update of all prognostic fields in one sweep.
+        void rk4(const std::vector<double*>&, const std::vector<double*>&, double); ///< Runge-Kutta update of all prognostic fields in one sweep.
 
         double rk3subdt(double);
         double rk4subdt(double);
@@ -1,6 +1,7 @@
 import numpy   as np
 import struct  as st
 import netCDF4 as nc4
+from microhh import skip_restart_header
 
 # Settings -------
 variable   = 'w'
@@ -92,6 +93,7 @@ for t in range(nt):
     var_t[t] = time * 10**iotimeprec
 
     fin = open("%s.%07i"%(variable, time),"rb")
+    skip_restart_header(fin, n)
     for k in range(nzsave):
         raw = fin.read(nx*ny*8)
         tmp = np.array(st.unpack('{0}{1}d'.format(en, nx*ny), raw))
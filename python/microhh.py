@@ -1,5 +1,61 @@
 import numpy
 import struct
+import zlib
+
+def skip_restart_header(fin, n):
+    # Restart files start with a header of eight 4-byte integers, of which the first one is
+    # the magic number 0x3348484d. Files without a header contain only the n doubles.
+    fin.seek(0, 2)
+    size = fin.tell()
+    fin.seek(0)
+    if (size == n*8):
+        return
+    magic = fin.read(4)
+    if (magic == struct.pack('<i', 0x3348484d) or magic == struct.pack('>i', 0x3348484d)):
+        fin.seek(32)
+    else:
+        fin.seek(0)
+
+def read_packed_dump(filename):
+    # Packed dumps (dumpformat=float or swcompress=1) start with a header of eight 4-byte integers:
+    # the magic number 0x3350484d, the version, itot, jtot, ktot, the flags (1 for single precision,
+    # 2 for compression), npy and 0, followed by the offset and the scale as doubles. Compressed
+    # fields continue with the number of blocks and the size of each block as 8-byte integers.
+    # Block k*npy+p holds level k of the rows of process p in the y-direction, with the bytes of
+    # the values shuffled before the deflate. The field is returned unpacked as (ktot, jtot, itot).
+    fin = open(filename, "rb")
+    raw = fin.read(48)
+    if (raw[0:4] == struct.pack('<i', 0x3350484d)):
+        en = '<'
+    elif (raw[0:4] == struct.pack('>i', 0x3350484d)):
+        en = '>'
+    else:
+        fin.close()
+        raise IOError('{0} is not a packed dump'.format(filename))
+
+    header = struct.unpack('{0}8i'.format(en), raw[0:32])
+    offset, scale = struct.unpack('{0}2d'.format(en), raw[32:48])
+    itot, jtot, ktot, flags, npy = header[2], header[3], header[4], header[5], header[6]
+
+    dtype = numpy.dtype('{0}f4'.format(en)) if (flags & 1) else numpy.dtype('{0}f8'.format(en))
+
+    if (flags & 2):
+        nblocks = struct.unpack('{0}Q'.format(en), fin.read(8))[0]
+        sizes = struct.unpack('{0}{1}Q'.format(en, nblocks), fin.read(nblocks*8))
+        jblock = jtot // npy
+        nvalues = itot*jblock
+        data = numpy.empty((ktot, jtot, itot), dtype)
+        for n in range(nblocks):
+            shuffled = numpy.frombuffer(zlib.decompress(fin.read(sizes[n])), numpy.uint8)
+            block = shuffled.reshape((dtype.itemsize, nvalues)).T.copy().view(dtype)
+            k, p = n // npy, n % npy
+            data[k, p*jblock:(p+1)*jblock, :] = block.reshape((jblock, itot))
+    else:
+        data = numpy.fromfile(fin, dtype, itot*jtot*ktot).reshape((ktot, jtot, itot))
+
+    fin.close()
+    return data.astype(numpy.float64)/scale + offset
+
 
 class microhh:
   def __init__(self, iter, itot, jtot, ktot):
@@ -25,6 +81,7 @@ class microhh:
     fin.close()
     
     fin = open("u.{:07d}".format(iter),"rb")
+    skip_restart_header(fin, n)
     raw = fin.read(n*8)
     tmp = numpy.array(struct.unpack('<{}d'.format(n), raw))
     del(raw)
@@ -33,6 +90,7 @@ class microhh:
     fin.close()
     
     fin = open("v.{:07d}".format(iter),"rb")
+    skip_restart_header(fin, n)
     raw = fin.read(n*8)
     tmp = numpy.array(struct.unpack('<{}d'.format(n), raw))
     del(raw)
@@ -41,6 +99,7 @@ class microhh:
     fin.close()
     
     fin = open("w.{:07d}".format(iter),"rb")
+    skip_restart_header(fin, n)
     raw = fin.read(n*8)
     tmp = numpy.array(struct.unpack('<{}d'.format(n), raw))
     del(raw)
@@ -49,6 +108,7 @@ class microhh:
     fin.close()
     
     fin = open("p.{:07d}".format(iter),"rb")
+    skip_restart_header(fin, n)
     raw = fin.read(n*8)
     tmp = numpy.array(struct.unpack('<{}d'.format(n), raw))
     del(raw)
@@ -57,6 +117,7 @@ class microhh:
     fin.close()
 
     fin = open("s.{:07d}".format(iter),"rb")
+    skip_restart_header(fin, n)
     raw = fin.read(n*8)
     tmp = numpy.array(struct.unpack('<{}d'.format(n), raw))
     del(raw)
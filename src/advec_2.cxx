@@ -30,18 +30,42 @@
 #include "constants.h"
 #include "finite_difference.h"
 #include "model.h"
+#include "master.h"
+#include "input.h"
 
 using namespace Finite_difference::O2;
 
 Advec_2::Advec_2(Model* modelin, Input* inputin) : Advec(modelin, inputin)
 {
     swadvec = "2";
+
+    if (inputin->get_item(&swfusediff, "advec", "swfusediff", "", "0"))
+        throw 1;
+
+    if (!(swfusediff == "0" || swfusediff == "1"))
+    {
+        master->print_error("\"%s\" is an illegal value for swfusediff\n", swfusediff.c_str());
+        throw 1;
+    }
+
+#ifdef USECUDA
+    if (swfusediff == "1")
+    {
+        master->print_warning("swfusediff is not available on the GPU, advection and diffusion are computed separately\n");
+        swfusediff = "0";
+    }
+#endif
 }
 
 Advec_2::~Advec_2()
 {
 }
 
+bool Advec_2::includes_diff()
+{
+    return swfusediff == "1";
+}
+
 #ifndef USECUDA
 double Advec_2::get_cfl(double dt)
 {
@@ -58,16 +82,87 @@ unsigned long Advec_2::get_time_limit(unsigned long idt, double dt)
 
 void Advec_2::exec()
 {
+    exec_box(grid->istart, grid->iend, grid->jstart, grid->jend, grid->kstart, grid->kend);
+}
+
+void Advec_2::exec_interior()
+{
+    int ib, ie, jb, je, kb, ke;
+    grid->get_box(ib, ie, jb, je, kb, ke, 0);
+    exec_box(ib, ie, jb, je, kb, ke);
+}
+
+void Advec_2::exec_boundary()
+{
+    int ib, ie, jb, je, kb, ke;
+    for (int n=1; n<Grid::nboxes; ++n)
+    {
+        grid->get_box(ib, ie, jb, je, kb, ke, n);
+        exec_box(ib, ie, jb, je, kb, ke);
+    }
+}
+
+void Advec_2::exec_box(const int istart, const int iend, const int jstart, const int jend,
+                       const int kstart, const int kend)
+{
+    if (swfusediff == "1")
+    {
+        exec_box_fused(istart, iend, jstart, jend, kstart, kend);
+        return;
+    }
+
+    // The vertical velocity is not advected at the bottom boundary.
+    const int kstarth = std::max(kstart, grid->kstart+1);
+
     advec_u(fields->ut->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi,
-            fields->rhoref, fields->rhorefh);
+            fields->rhoref, fields->rhorefh, istart, iend, jstart, jend, kstart, kend);
     advec_v(fields->vt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi,
-            fields->rhoref, fields->rhorefh);
+            fields->rhoref, fields->rhorefh, istart, iend, jstart, jend, kstart, kend);
     advec_w(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzhi,
-            fields->rhoref, fields->rhorefh);
+            fields->rhoref, fields->rhorefh, istart, iend, jstart, jend, kstarth, kend);
 
+    // Collect the scalars, such that the velocities are loaded once for all of them.
+    std::vector<double*> stlist, slist;
     for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); it++)
-        advec_s(it->second->data, fields->sp[it->first]->data, fields->u->data, fields->v->data, fields->w->data,
-                grid->dzi, fields->rhoref, fields->rhorefh);
+    {
+        stlist.push_back(it->second->data);
+        slist .push_back(fields->sp[it->first]->data);
+    }
+
+    advec_s(stlist, slist, fields->u->data, fields->v->data, fields->w->data,
+            grid->dzi, fields->rhoref, fields->rhorefh, istart, iend, jstart, jend, kstart, kend);
+}
+
+/**
+ * This function computes the 2nd order advection and diffusion tendencies in a single sweep,
+ * such that every prognostic field and its tendency is streamed through memory only once.
+ * The diffusion is added after the advection in each grid point, as in the separate kernels.
+ */
+void Advec_2::exec_box_fused(const int istart, const int iend, const int jstart, const int jend,
+                             const int kstart, const int kend)
+{
+    // The vertical velocity is not advected and diffused at the bottom boundary.
+    const int kstarth = std::max(kstart, grid->kstart+1);
+
+    advec_diff_u(fields->ut->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi,
+                 fields->rhoref, fields->rhorefh, fields->visc, istart, iend, jstart, jend, kstart, kend);
+    advec_diff_v(fields->vt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi,
+                 fields->rhoref, fields->rhorefh, fields->visc, istart, iend, jstart, jend, kstart, kend);
+    advec_diff_w(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi,
+                 fields->rhoref, fields->rhorefh, fields->visc, istart, iend, jstart, jend, kstarth, kend);
+
+    std::vector<double*> stlist, slist;
+    std::vector<double> visclist;
+    for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); it++)
+    {
+        stlist  .push_back(it->second->data);
+        slist   .push_back(fields->sp[it->first]->data);
+        visclist.push_back(fields->sp[it->first]->visc);
+    }
+
+    advec_diff_s(stlist, slist, fields->u->data, fields->v->data, fields->w->data,
+                 grid->dzi, grid->dzhi, fields->rhoref, fields->rhorefh, visclist,
+                 istart, iend, jstart, jend, kstart, kend);
 }
 #endif
 
@@ -99,7 +194,9 @@ double Advec_2::calc_cfl(double* restrict u, double* restrict v, double* restric
 }
 
 void Advec_2::advec_u(double* restrict ut, double* restrict u, double* restrict v, double* restrict w,
-                      double* restrict dzi, double* restrict rhoref, double* restrict rhorefh)
+                      double* restrict dzi, double* restrict rhoref, double* restrict rhorefh,
+                      const int istart, const int iend, const int jstart, const int jend,
+                      const int kstart, const int kend)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -108,10 +205,11 @@ void Advec_2::advec_u(double* restrict ut, double* restrict u, double* restrict
     const double dxi = 1./grid->dx;
     const double dyi = 1./grid->dy;
 
-    for (int k=grid->kstart; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+#pragma omp parallel for
+    for (int k=kstart; k<kend; ++k)
+        for (int j=jstart; j<jend; ++j)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
+            for (int i=istart; i<iend; ++i)
             {
                 const int ijk = i + j*jj + k*kk;
                 ut[ijk] +=
@@ -127,7 +225,9 @@ void Advec_2::advec_u(double* restrict ut, double* restrict u, double* restrict
 }
 
 void Advec_2::advec_v(double* restrict vt, double* restrict u, double* restrict v, double* restrict w,
-                      double* restrict dzi, double* restrict rhoref, double* restrict rhorefh)
+                      double* restrict dzi, double* restrict rhoref, double* restrict rhorefh,
+                      const int istart, const int iend, const int jstart, const int jend,
+                      const int kstart, const int kend)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -136,10 +236,11 @@ void Advec_2::advec_v(double* restrict vt, double* restrict u, double* restrict
     const double dxi = 1./grid->dx;
     const double dyi = 1./grid->dy;
 
-    for (int k=grid->kstart; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+#pragma omp parallel for
+    for (int k=kstart; k<kend; ++k)
+        for (int j=jstart; j<jend; ++j)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
+            for (int i=istart; i<iend; ++i)
             {
                 const int ijk = i + j*jj + k*kk;
                 vt[ijk] +=
@@ -155,7 +256,9 @@ void Advec_2::advec_v(double* restrict vt, double* restrict u, double* restrict
 }
 
 void Advec_2::advec_w(double* restrict wt, double* restrict u, double* restrict v, double* restrict w,
-                      double* restrict dzhi, double* restrict rhoref, double* restrict rhorefh)
+                      double* restrict dzhi, double* restrict rhoref, double* restrict rhorefh,
+                      const int istart, const int iend, const int jstart, const int jend,
+                      const int kstart, const int kend)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -164,10 +267,11 @@ void Advec_2::advec_w(double* restrict wt, double* restrict u, double* restrict
     const double dxi = 1./grid->dx;
     const double dyi = 1./grid->dy;
 
-    for (int k=grid->kstart+1; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+#pragma omp parallel for
+    for (int k=kstart; k<kend; ++k)
+        for (int j=jstart; j<jend; ++j)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
+            for (int i=istart; i<iend; ++i)
             {
                 const int ijk = i + j*jj + k*kk;
                 wt[ijk] +=
@@ -182,9 +286,14 @@ void Advec_2::advec_w(double* restrict wt, double* restrict u, double* restrict
             }
 }
 
-void Advec_2::advec_s(double* restrict st, double* restrict s, double* restrict u, double* restrict v, double* restrict w,
-                      double* restrict dzi, double* restrict rhoref, double* restrict rhorefh)
+void Advec_2::advec_s(const std::vector<double*>& stlist, const std::vector<double*>& slist,
+                      double* restrict u, double* restrict v, double* restrict w,
+                      double* restrict dzi, double* restrict rhoref, double* restrict rhorefh,
+                      const int istart, const int iend, const int jstart, const int jend,
+                      const int kstart, const int kend)
 {
+    const int nsc = stlist.size();
+
     const int ii = 1;
     const int jj = grid->icells;
     const int kk = grid->ijcells;
@@ -192,20 +301,207 @@ void Advec_2::advec_s(double* restrict st, double* restrict s, double* restrict
     const double dxi = 1./grid->dx;
     const double dyi = 1./grid->dy;
 
-    for (int k=grid->kstart; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+#pragma omp parallel for
+    for (int k=kstart; k<kend; ++k)
+        for (int j=jstart; j<jend; ++j)
+            for (int n=0; n<nsc; ++n)
+            {
+                double* restrict st = stlist[n];
+                double* restrict s  = slist[n];
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
+                for (int i=istart; i<iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    st[ijk] +=
+                             - ( u[ijk+ii] * interp2(s[ijk   ], s[ijk+ii])
+                               - u[ijk   ] * interp2(s[ijk-ii], s[ijk   ]) ) * dxi
+
+                             - ( v[ijk+jj] * interp2(s[ijk   ], s[ijk+jj])
+                               - v[ijk   ] * interp2(s[ijk-jj], s[ijk   ]) ) * dyi
+
+                             - ( rhorefh[k+1] * w[ijk+kk] * interp2(s[ijk   ], s[ijk+kk])
+                               - rhorefh[k  ] * w[ijk   ] * interp2(s[ijk-kk], s[ijk   ]) ) / rhoref[k] * dzi[k];
+                }
+            }
+}
+
+void Advec_2::advec_diff_u(double* restrict ut, double* restrict u, double* restrict v, double* restrict w,
+                           double* restrict dzi, double* restrict dzhi, double* restrict rhoref, double* restrict rhorefh,
+                           const double visc,
+                           const int istart, const int iend, const int jstart, const int jend,
+                           const int kstart, const int kend)
+{
+    const int ii = 1;
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+
+    const double dxi = 1./grid->dx;
+    const double dyi = 1./grid->dy;
+
+    const double dxidxi = 1./(grid->dx * grid->dx);
+    const double dyidyi = 1./(grid->dy * grid->dy);
+
+#pragma omp parallel for
+    for (int k=kstart; k<kend; ++k)
+        for (int j=jstart; j<jend; ++j)
+#pragma ivdep
+            for (int i=istart; i<iend; ++i)
             {
                 const int ijk = i + j*jj + k*kk;
-                st[ijk] +=
-                         - ( u[ijk+ii] * interp2(s[ijk   ], s[ijk+ii])
-                           - u[ijk   ] * interp2(s[ijk-ii], s[ijk   ]) ) * dxi
+                ut[ijk] +=
+                         - ( interp2(u[ijk   ], u[ijk+ii]) * interp2(u[ijk   ], u[ijk+ii])
+                           - interp2(u[ijk-ii], u[ijk   ]) * interp2(u[ijk-ii], u[ijk   ]) ) * dxi
 
-                         - ( v[ijk+jj] * interp2(s[ijk   ], s[ijk+jj])
-                           - v[ijk   ] * interp2(s[ijk-jj], s[ijk   ]) ) * dyi
+                         - ( interp2(v[ijk-ii+jj], v[ijk+jj]) * interp2(u[ijk   ], u[ijk+jj])
+                           - interp2(v[ijk-ii   ], v[ijk   ]) * interp2(u[ijk-jj], u[ijk   ]) ) * dyi
 
-                         - ( rhorefh[k+1] * w[ijk+kk] * interp2(s[ijk   ], s[ijk+kk])
-                           - rhorefh[k  ] * w[ijk   ] * interp2(s[ijk-kk], s[ijk   ]) ) / rhoref[k] * dzi[k];
+                         - ( rhorefh[k+1] * interp2(w[ijk-ii+kk], w[ijk+kk]) * interp2(u[ijk   ], u[ijk+kk])
+                           - rhorefh[k  ] * interp2(w[ijk-ii   ], w[ijk   ]) * interp2(u[ijk-kk], u[ijk   ]) ) / rhoref[k] * dzi[k];
+
+                ut[ijk] += visc * (
+                        + ( (u[ijk+ii] - u[ijk   ]) 
+                          - (u[ijk   ] - u[ijk-ii]) ) * dxidxi 
+                        + ( (u[ijk+jj] - u[ijk   ]) 
+                          - (u[ijk   ] - u[ijk-jj]) ) * dyidyi
+                        + ( (u[ijk+kk] - u[ijk   ]) * dzhi[k+1]
+                          - (u[ijk   ] - u[ijk-kk]) * dzhi[k]   ) * dzi[k] );
+            }
+}
+
+void Advec_2::advec_diff_v(double* restrict vt, double* restrict u, double* restrict v, double* restrict w,
+                           double* restrict dzi, double* restrict dzhi, double* restrict rhoref, double* restrict rhorefh,
+                           const double visc,
+                           const int istart, const int iend, const int jstart, const int jend,
+                           const int kstart, const int kend)
+{
+    const int ii = 1;
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+
+    const double dxi = 1./grid->dx;
+    const double dyi = 1./grid->dy;
+
+    const double dxidxi = 1./(grid->dx * grid->dx);
+    const double dyidyi = 1./(grid->dy * grid->dy);
+
+#pragma omp parallel for
+    for (int k=kstart; k<kend; ++k)
+        for (int j=jstart; j<jend; ++j)
+#pragma ivdep
+            for (int i=istart; i<iend; ++i)
+            {
+                const int ijk = i + j*jj + k*kk;
+                vt[ijk] +=
+                         - ( interp2(u[ijk+ii-jj], u[ijk+ii]) * interp2(v[ijk   ], v[ijk+ii])
+                           - interp2(u[ijk   -jj], u[ijk   ]) * interp2(v[ijk-ii], v[ijk   ]) ) * dxi
+
+                         - ( interp2(v[ijk   ], v[ijk+jj]) * interp2(v[ijk   ], v[ijk+jj])
+                           - interp2(v[ijk-jj], v[ijk   ]) * interp2(v[ijk-jj], v[ijk   ]) ) * dyi
+
+                         - ( rhorefh[k+1] * interp2(w[ijk-jj+kk], w[ijk+kk]) * interp2(v[ijk   ], v[ijk+kk])
+                           - rhorefh[k  ] * interp2(w[ijk-jj   ], w[ijk   ]) * interp2(v[ijk-kk], v[ijk   ]) ) / rhoref[k] * dzi[k];
+
+                vt[ijk] += visc * (
+                        + ( (v[ijk+ii] - v[ijk   ]) 
+                          - (v[ijk   ] - v[ijk-ii]) ) * dxidxi 
+                        + ( (v[ijk+jj] - v[ijk   ]) 
+                          - (v[ijk   ] - v[ijk-jj]) ) * dyidyi
+                        + ( (v[ijk+kk] - v[ijk   ]) * dzhi[k+1]
+                          - (v[ijk   ] - v[ijk-kk]) * dzhi[k]   ) * dzi[k] );
+            }
+}
+
+void Advec_2::advec_diff_w(double* restrict wt, double* restrict u, double* restrict v, double* restrict w,
+                           double* restrict dzi, double* restrict dzhi, double* restrict rhoref, double* restrict rhorefh,
+                           const double visc,
+                           const int istart, const int iend, const int jstart, const int jend,
+                           const int kstart, const int kend)
+{
+    const int ii = 1;
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+
+    const double dxi = 1./grid->dx;
+    const double dyi = 1./grid->dy;
+
+    const double dxidxi = 1./(grid->dx*grid->dx);
+    const double dyidyi = 1./(grid->dy*grid->dy);
+
+#pragma omp parallel for
+    for (int k=kstart; k<kend; ++k)
+        for (int j=jstart; j<jend; ++j)
+#pragma ivdep
+            for (int i=istart; i<iend; ++i)
+            {
+                const int ijk = i + j*jj + k*kk;
+                wt[ijk] +=
+                         - ( interp2(u[ijk+ii-kk], u[ijk+ii]) * interp2(w[ijk   ], w[ijk+ii])
+                           - interp2(u[ijk   -kk], u[ijk   ]) * interp2(w[ijk-ii], w[ijk   ]) ) * dxi
+
+                         - ( interp2(v[ijk+jj-kk], v[ijk+jj]) * interp2(w[ijk   ], w[ijk+jj])
+                           - interp2(v[ijk   -kk], v[ijk   ]) * interp2(w[ijk-jj], w[ijk   ]) ) * dyi
+
+                         - ( rhoref[k  ] * interp2(w[ijk   ], w[ijk+kk]) * interp2(w[ijk   ], w[ijk+kk])
+                           - rhoref[k-1] * interp2(w[ijk-kk], w[ijk   ]) * interp2(w[ijk-kk], w[ijk   ]) ) / rhorefh[k] * dzhi[k];
+
+                wt[ijk] += visc * (
+                        + ( (w[ijk+ii] - w[ijk   ]) 
+                          - (w[ijk   ] - w[ijk-ii]) ) * dxidxi 
+                        + ( (w[ijk+jj] - w[ijk   ]) 
+                          - (w[ijk   ] - w[ijk-jj]) ) * dyidyi
+                        + ( (w[ijk+kk] - w[ijk   ]) * dzi[k]
+                          - (w[ijk   ] - w[ijk-kk]) * dzi[k-1] ) * dzhi[k] );
+            }
+}
+
+void Advec_2::advec_diff_s(const std::vector<double*>& stlist, const std::vector<double*>& slist,
+                           double* restrict u, double* restrict v, double* restrict w,
+                           double* restrict dzi, double* restrict dzhi, double* restrict rhoref, double* restrict rhorefh,
+                           const std::vector<double>& visclist,
+                           const int istart, const int iend, const int jstart, const int jend,
+                           const int kstart, const int kend)
+{
+    const int nsc = stlist.size();
+
+    const int ii = 1;
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+
+    const double dxi = 1./grid->dx;
+    const double dyi = 1./grid->dy;
+
+    const double dxidxi = 1./(grid->dx * grid->dx);
+    const double dyidyi = 1./(grid->dy * grid->dy);
+
+#pragma omp parallel for
+    for (int k=kstart; k<kend; ++k)
+        for (int j=jstart; j<jend; ++j)
+            for (int n=0; n<nsc; ++n)
+            {
+                double* restrict st = stlist[n];
+                double* restrict s  = slist[n];
+                const double visc = visclist[n];
+#pragma ivdep
+                for (int i=istart; i<iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    st[ijk] +=
+                             - ( u[ijk+ii] * interp2(s[ijk   ], s[ijk+ii])
+                               - u[ijk   ] * interp2(s[ijk-ii], s[ijk   ]) ) * dxi
+
+                             - ( v[ijk+jj] * interp2(s[ijk   ], s[ijk+jj])
+                               - v[ijk   ] * interp2(s[ijk-jj], s[ijk   ]) ) * dyi
+
+                             - ( rhorefh[k+1] * w[ijk+kk] * interp2(s[ijk   ], s[ijk+kk])
+                               - rhorefh[k  ] * w[ijk   ] * interp2(s[ijk-kk], s[ijk   ]) ) / rhoref[k] * dzi[k];
+
+                    st[ijk] += visc * (
+                            + ( (s[ijk+ii] - s[ijk   ]) 
+                              - (s[ijk   ] - s[ijk-ii]) ) * dxidxi 
+                            + ( (s[ijk+jj] - s[ijk   ]) 
+                              - (s[ijk   ] - s[ijk-jj]) ) * dyidyi
+                            + ( (s[ijk+kk] - s[ijk   ]) * dzhi[k+1]
+                              - (s[ijk   ] - s[ijk-kk]) * dzhi[k]   ) * dzi[k] );
+                }
             }
 }
@@ -76,10 +76,16 @@ void Advec_2i4::exec()
     advec_w(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzhi,
             fields->rhoref, fields->rhorefh);
 
+    // Collect the scalars, such that the velocities are loaded once for all of them.
+    std::vector<double*> stlist, slist;
     for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); it++)
-        advec_s(it->second->data, fields->sp[it->first]->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi,
-                fields->rhoref, fields->rhorefh);
+    {
+        stlist.push_back(it->second->data);
+        slist .push_back(fields->sp[it->first]->data);
+    }
 
+    advec_s(stlist, slist, fields->u->data, fields->v->data, fields->w->data, grid->dzi,
+            fields->rhoref, fields->rhorefh);
 }
 #endif
 
@@ -158,6 +164,7 @@ void Advec_2i4::advec_u(double* restrict ut, double* restrict u, double* restric
 
     int k = kstart; 
 
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -177,6 +184,7 @@ void Advec_2i4::advec_u(double* restrict ut, double* restrict u, double* restric
         }
 
     k = kstart + 1; 
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -196,6 +204,7 @@ void Advec_2i4::advec_u(double* restrict ut, double* restrict u, double* restric
                        - rhorefh[k  ] * interp2(w[ijk-ii1    ], w[ijk    ]) * interp2(u[ijk-kk1], u[ijk    ]) ) / rhoref[k] * dzi[k];
         }
 
+#pragma omp parallel for
     for (k=grid->kstart+2; k<grid->kend-2; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
@@ -217,6 +226,7 @@ void Advec_2i4::advec_u(double* restrict ut, double* restrict u, double* restric
             }
 
     k = kend - 2; 
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -237,6 +247,7 @@ void Advec_2i4::advec_u(double* restrict ut, double* restrict u, double* restric
         }
 
     k = kend - 1; 
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -273,6 +284,7 @@ void Advec_2i4::advec_v(double* restrict vt, double* restrict u, double* restric
     const int kend   = grid->kend;
 
     int k = kstart;
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -292,6 +304,7 @@ void Advec_2i4::advec_v(double* restrict vt, double* restrict u, double* restric
         }
 
     k = kstart+1;
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -311,6 +324,7 @@ void Advec_2i4::advec_v(double* restrict vt, double* restrict u, double* restric
                        - rhorefh[k  ] * interp2(w[ijk-jj1    ], w[ijk    ]) * interp2(v[ijk-kk1], v[ijk    ]) ) / rhoref[k] * dzi[k];
         }
 
+#pragma omp parallel for
     for (k=grid->kstart+2; k<grid->kend-2; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
@@ -332,6 +346,7 @@ void Advec_2i4::advec_v(double* restrict vt, double* restrict u, double* restric
             }
 
     k = kend-2;
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -352,6 +367,7 @@ void Advec_2i4::advec_v(double* restrict vt, double* restrict u, double* restric
         }
 
     k = kend-1;
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -388,6 +404,7 @@ void Advec_2i4::advec_w(double* restrict wt, double* restrict u, double* restric
     const int kend   = grid->kend;
 
     int k = kstart+1;
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -407,6 +424,7 @@ void Advec_2i4::advec_w(double* restrict wt, double* restrict u, double* restric
                        - rhoref[k-1] * interp2(w[ijk-kk1    ], w[ijk    ]) * interp2(w[ijk-kk1], w[ijk    ]) ) / rhorefh[k] * dzhi[k];
         }
 
+#pragma omp parallel for
     for (k=grid->kstart+2; k<grid->kend-1; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
@@ -428,6 +446,7 @@ void Advec_2i4::advec_w(double* restrict wt, double* restrict u, double* restric
             }
 
     k = kend-1;
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -448,9 +467,12 @@ void Advec_2i4::advec_w(double* restrict wt, double* restrict u, double* restric
         }
 }
 
-void Advec_2i4::advec_s(double* restrict st, double* restrict s, double* restrict u, double* restrict v, double* restrict w,
+void Advec_2i4::advec_s(const std::vector<double*>& stlist, const std::vector<double*>& slist,
+                        double* restrict u, double* restrict v, double* restrict w,
                         double* restrict dzi, double* restrict rhoref, double* restrict rhorefh)
 {
+    const int nsc = stlist.size();
+
     const int ii1 = 1;
     const int ii2 = 2;
     const int jj1 = 1*grid->icells;
@@ -466,40 +488,34 @@ void Advec_2i4::advec_s(double* restrict st, double* restrict s, double* restric
 
     // assume that w at the boundary equals zero...
     int k = kstart;
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-        for (int i=grid->istart; i<grid->iend; ++i)
+        for (int n=0; n<nsc; ++n)
         {
-            const int ijk = i + j*jj1 + k*kk1;
-            st[ijk] += 
-                     - ( u[ijk+ii1] * interp4(s[ijk-ii1], s[ijk    ], s[ijk+ii1], s[ijk+ii2])
-                       - u[ijk    ] * interp4(s[ijk-ii2], s[ijk-ii1], s[ijk    ], s[ijk+ii1]) ) * dxi
+            double* restrict st = stlist[n];
+            double* restrict s  = slist[n];
+#pragma ivdep
+            for (int i=grid->istart; i<grid->iend; ++i)
+            {
+                const int ijk = i + j*jj1 + k*kk1;
+                st[ijk] += 
+                         - ( u[ijk+ii1] * interp4(s[ijk-ii1], s[ijk    ], s[ijk+ii1], s[ijk+ii2])
+                           - u[ijk    ] * interp4(s[ijk-ii2], s[ijk-ii1], s[ijk    ], s[ijk+ii1]) ) * dxi
 
-                     - ( v[ijk+jj1] * interp4(s[ijk-jj1], s[ijk    ], s[ijk+jj1], s[ijk+jj2])
-                       - v[ijk    ] * interp4(s[ijk-jj2], s[ijk-jj1], s[ijk    ], s[ijk+jj1]) ) * dyi 
+                         - ( v[ijk+jj1] * interp4(s[ijk-jj1], s[ijk    ], s[ijk+jj1], s[ijk+jj2])
+                           - v[ijk    ] * interp4(s[ijk-jj2], s[ijk-jj1], s[ijk    ], s[ijk+jj1]) ) * dyi 
 
-                     - ( rhorefh[k+1] * w[ijk+kk1] * interp2(s[ijk    ], s[ijk+kk1]) ) / rhoref[k] * dzi[k];
+                         - ( rhorefh[k+1] * w[ijk+kk1] * interp2(s[ijk    ], s[ijk+kk1]) ) / rhoref[k] * dzi[k];
+            }
         }
 
     k = kstart+1;
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-        for (int i=grid->istart; i<grid->iend; ++i)
+        for (int n=0; n<nsc; ++n)
         {
-            const int ijk = i + j*jj1 + k*kk1;
-            st[ijk] += 
-                     - ( u[ijk+ii1] * interp4(s[ijk-ii1], s[ijk    ], s[ijk+ii1], s[ijk+ii2])
-                       - u[ijk    ] * interp4(s[ijk-ii2], s[ijk-ii1], s[ijk    ], s[ijk+ii1]) ) * dxi
-
-                     - ( v[ijk+jj1] * interp4(s[ijk-jj1], s[ijk    ], s[ijk+jj1], s[ijk+jj2])
-                       - v[ijk    ] * interp4(s[ijk-jj2], s[ijk-jj1], s[ijk    ], s[ijk+jj1]) ) * dyi 
-
-                     - ( rhorefh[k+1] * w[ijk+kk1] * interp4(s[ijk-kk1], s[ijk    ], s[ijk+kk1], s[ijk+kk2])
-                       - rhorefh[k  ] * w[ijk    ] * interp2(s[ijk-kk1], s[ijk    ]) ) / rhoref[k] * dzi[k];
-        }
-
-    for (k=grid->kstart+2; k<grid->kend-2; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+            double* restrict st = stlist[n];
+            double* restrict s  = slist[n];
 #pragma ivdep
             for (int i=grid->istart; i<grid->iend; ++i)
             {
@@ -512,40 +528,76 @@ void Advec_2i4::advec_s(double* restrict st, double* restrict s, double* restric
                            - v[ijk    ] * interp4(s[ijk-jj2], s[ijk-jj1], s[ijk    ], s[ijk+jj1]) ) * dyi 
 
                          - ( rhorefh[k+1] * w[ijk+kk1] * interp4(s[ijk-kk1], s[ijk    ], s[ijk+kk1], s[ijk+kk2])
-                           - rhorefh[k  ] * w[ijk    ] * interp4(s[ijk-kk2], s[ijk-kk1], s[ijk    ], s[ijk+kk1]) ) / rhoref[k] * dzi[k];
+                           - rhorefh[k  ] * w[ijk    ] * interp2(s[ijk-kk1], s[ijk    ]) ) / rhoref[k] * dzi[k];
+            }
+        }
+
+#pragma omp parallel for
+    for (k=grid->kstart+2; k<grid->kend-2; ++k)
+        for (int j=grid->jstart; j<grid->jend; ++j)
+            for (int n=0; n<nsc; ++n)
+            {
+                double* restrict st = stlist[n];
+                double* restrict s  = slist[n];
+#pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk = i + j*jj1 + k*kk1;
+                    st[ijk] += 
+                             - ( u[ijk+ii1] * interp4(s[ijk-ii1], s[ijk    ], s[ijk+ii1], s[ijk+ii2])
+                               - u[ijk    ] * interp4(s[ijk-ii2], s[ijk-ii1], s[ijk    ], s[ijk+ii1]) ) * dxi
+
+                             - ( v[ijk+jj1] * interp4(s[ijk-jj1], s[ijk    ], s[ijk+jj1], s[ijk+jj2])
+                               - v[ijk    ] * interp4(s[ijk-jj2], s[ijk-jj1], s[ijk    ], s[ijk+jj1]) ) * dyi 
+
+                             - ( rhorefh[k+1] * w[ijk+kk1] * interp4(s[ijk-kk1], s[ijk    ], s[ijk+kk1], s[ijk+kk2])
+                               - rhorefh[k  ] * w[ijk    ] * interp4(s[ijk-kk2], s[ijk-kk1], s[ijk    ], s[ijk+kk1]) ) / rhoref[k] * dzi[k];
+                }
             }
 
     k = kend-2;
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-        for (int i=grid->istart; i<grid->iend; ++i)
+        for (int n=0; n<nsc; ++n)
         {
-            const int ijk = i + j*jj1 + k*kk1;
-            st[ijk] += 
-                     - ( u[ijk+ii1] * interp4(s[ijk-ii1], s[ijk    ], s[ijk+ii1], s[ijk+ii2])
-                       - u[ijk    ] * interp4(s[ijk-ii2], s[ijk-ii1], s[ijk    ], s[ijk+ii1]) ) * dxi
+            double* restrict st = stlist[n];
+            double* restrict s  = slist[n];
+#pragma ivdep
+            for (int i=grid->istart; i<grid->iend; ++i)
+            {
+                const int ijk = i + j*jj1 + k*kk1;
+                st[ijk] += 
+                         - ( u[ijk+ii1] * interp4(s[ijk-ii1], s[ijk    ], s[ijk+ii1], s[ijk+ii2])
+                           - u[ijk    ] * interp4(s[ijk-ii2], s[ijk-ii1], s[ijk    ], s[ijk+ii1]) ) * dxi
 
-                     - ( v[ijk+jj1] * interp4(s[ijk-jj1], s[ijk    ], s[ijk+jj1], s[ijk+jj2])
-                       - v[ijk    ] * interp4(s[ijk-jj2], s[ijk-jj1], s[ijk    ], s[ijk+jj1]) ) * dyi 
+                         - ( v[ijk+jj1] * interp4(s[ijk-jj1], s[ijk    ], s[ijk+jj1], s[ijk+jj2])
+                           - v[ijk    ] * interp4(s[ijk-jj2], s[ijk-jj1], s[ijk    ], s[ijk+jj1]) ) * dyi 
 
-                     - ( rhorefh[k+1] * w[ijk+kk1] * interp2(s[ijk    ], s[ijk+kk1])
-                       - rhorefh[k  ] * w[ijk    ] * interp4(s[ijk-kk2], s[ijk-kk1], s[ijk    ], s[ijk+kk1]) ) / rhoref[k] * dzi[k];
+                         - ( rhorefh[k+1] * w[ijk+kk1] * interp2(s[ijk    ], s[ijk+kk1])
+                           - rhorefh[k  ] * w[ijk    ] * interp4(s[ijk-kk2], s[ijk-kk1], s[ijk    ], s[ijk+kk1]) ) / rhoref[k] * dzi[k];
+            }
         }
 
     // assume that w at the boundary equals zero...
     k = kend-1;
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-        for (int i=grid->istart; i<grid->iend; ++i)
+        for (int n=0; n<nsc; ++n)
         {
-            const int ijk = i + j*jj1 + k*kk1;
-            st[ijk] += 
-                     - ( u[ijk+ii1] * interp4(s[ijk-ii1], s[ijk    ], s[ijk+ii1], s[ijk+ii2])
-                       - u[ijk    ] * interp4(s[ijk-ii2], s[ijk-ii1], s[ijk    ], s[ijk+ii1]) ) * dxi
+            double* restrict st = stlist[n];
+            double* restrict s  = slist[n];
+#pragma ivdep
+            for (int i=grid->istart; i<grid->iend; ++i)
+            {
+                const int ijk = i + j*jj1 + k*kk1;
+                st[ijk] += 
+                         - ( u[ijk+ii1] * interp4(s[ijk-ii1], s[ijk    ], s[ijk+ii1], s[ijk+ii2])
+                           - u[ijk    ] * interp4(s[ijk-ii2], s[ijk-ii1], s[ijk    ], s[ijk+ii1]) ) * dxi
 
-                     - ( v[ijk+jj1] * interp4(s[ijk-jj1], s[ijk    ], s[ijk+jj1], s[ijk+jj2])
-                       - v[ijk    ] * interp4(s[ijk-jj2], s[ijk-jj1], s[ijk    ], s[ijk+jj1]) ) * dyi 
+                         - ( v[ijk+jj1] * interp4(s[ijk-jj1], s[ijk    ], s[ijk+jj1], s[ijk+jj2])
+                           - v[ijk    ] * interp4(s[ijk-jj2], s[ijk-jj1], s[ijk    ], s[ijk+jj1]) ) * dyi 
 
-                     - (- rhorefh[k  ] * w[ijk    ] * interp2(s[ijk-kk1], s[ijk    ]) ) / rhoref[k] * dzi[k];
+                         - (- rhorefh[k  ] * w[ijk    ] * interp2(s[ijk-kk1], s[ijk    ]) ) / rhoref[k] * dzi[k];
+            }
         }
 }
@@ -58,6 +58,14 @@ double Advec_4::get_cfl(double dt)
 
 void Advec_4::exec()
 {
+    // Collect the scalars, such that the velocities are loaded once for all of them.
+    std::vector<double*> stlist, slist;
+    for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); it++)
+    {
+        stlist.push_back(it->second->data);
+        slist .push_back(fields->sp[it->first]->data);
+    }
+
     // In case of a two-dimensional run, strip v component out of all kernels and do 
     // not calculate v-advection tendency.
     if (grid->jtot == 1)
@@ -65,8 +73,7 @@ void Advec_4::exec()
         advec_u<false>(fields->ut->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi4 );
         advec_w<false>(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzhi4);
 
-        for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); it++)
-            advec_s<false>(it->second->data, fields->sp[it->first]->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi4);
+        advec_s<false>(stlist, slist, fields->u->data, fields->v->data, fields->w->data, grid->dzi4);
     }
     else
     {
@@ -74,8 +81,7 @@ void Advec_4::exec()
         advec_v<true>(fields->vt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi4 );
         advec_w<true>(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzhi4);
 
-        for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); it++)
-            advec_s<true>(it->second->data, fields->sp[it->first]->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi4);
+        advec_s<true>(stlist, slist, fields->u->data, fields->v->data, fields->w->data, grid->dzi4);
     }
 }
 #endif
@@ -132,6 +138,7 @@ void Advec_4::advec_u(double * restrict ut, double * restrict u, double * restri
     const double dyi = 1./grid->dy;
 
     // bottom boundary
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; i++)
@@ -157,6 +164,7 @@ void Advec_4::advec_u(double * restrict ut, double * restrict u, double * restri
                      * dzi4[kstart];
         }
 
+#pragma omp parallel for
     for (int k=grid->kstart+1; k<grid->kend-1; k++)
         for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
@@ -184,6 +192,7 @@ void Advec_4::advec_u(double * restrict ut, double * restrict u, double * restri
             }
 
     // top boundary
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; i++)
@@ -230,6 +239,7 @@ void Advec_4::advec_v(double * restrict vt, double * restrict u, double * restri
     const double dyi = 1./grid->dy;
 
     // bottom boundary
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; i++)
@@ -255,6 +265,7 @@ void Advec_4::advec_v(double * restrict vt, double * restrict u, double * restri
                      * dzi4[kstart];
         }
 
+#pragma omp parallel for
     for (int k=grid->kstart+1; k<grid->kend-1; k++)
         for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
@@ -282,6 +293,7 @@ void Advec_4::advec_v(double * restrict vt, double * restrict u, double * restri
             }
 
     // top boundary
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; i++)
@@ -328,6 +340,7 @@ void Advec_4::advec_w(double * restrict wt, double * restrict u, double * restri
     const double dyi = 1./grid->dy;
 
     // bottom boundary
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; i++)
@@ -353,6 +366,7 @@ void Advec_4::advec_w(double * restrict wt, double * restrict u, double * restri
                 * dzhi4[kstart+1];
         }
 
+#pragma omp parallel for
     for (int k=grid->kstart+2; k<grid->kend-1; k++)
         for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
@@ -380,6 +394,7 @@ void Advec_4::advec_w(double * restrict wt, double * restrict u, double * restri
             }
 
     // top boundary
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; i++)
@@ -407,8 +422,11 @@ void Advec_4::advec_w(double * restrict wt, double * restrict u, double * restri
 }
 
     template<bool dim3>
-void Advec_4::advec_s(double * restrict st, double * restrict s, double * restrict u, double * restrict v, double * restrict w, double * restrict dzi4)
+void Advec_4::advec_s(const std::vector<double*>& stlist, const std::vector<double*>& slist,
+                      double * restrict u, double * restrict v, double * restrict w, double * restrict dzi4)
 {
+    const int nsc = stlist.size();
+
     const int ii1 = 1;
     const int ii2 = 2;
     const int ii3 = 3;
@@ -426,37 +444,16 @@ void Advec_4::advec_s(double * restrict st, double * restrict s, double * restri
     const int kend   = grid->kend;
 
     // bottom boundary
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-        for (int i=grid->istart; i<grid->iend; i++)
+        for (int n=0; n<nsc; ++n)
         {
-            const int ijk = i + j*jj1 + kstart*kk1;
-            st[ijk] -= ( cg0*(u[ijk-ii1] * (ci0*s[ijk-ii3] + ci1*s[ijk-ii2] + ci2*s[ijk-ii1] + ci3*s[ijk    ]))
-                       + cg1*(u[ijk    ] * (ci0*s[ijk-ii2] + ci1*s[ijk-ii1] + ci2*s[ijk    ] + ci3*s[ijk+ii1]))
-                       + cg2*(u[ijk+ii1] * (ci0*s[ijk-ii1] + ci1*s[ijk    ] + ci2*s[ijk+ii1] + ci3*s[ijk+ii2]))
-                       + cg3*(u[ijk+ii2] * (ci0*s[ijk    ] + ci1*s[ijk+ii1] + ci2*s[ijk+ii2] + ci3*s[ijk+ii3])) ) * cgi*dxi;
-
-            if (dim3)
-            {
-                st[ijk] -= ( cg0*(v[ijk-jj1] * (ci0*s[ijk-jj3] + ci1*s[ijk-jj2] + ci2*s[ijk-jj1] + ci3*s[ijk    ]))
-                           + cg1*(v[ijk    ] * (ci0*s[ijk-jj2] + ci1*s[ijk-jj1] + ci2*s[ijk    ] + ci3*s[ijk+jj1]))
-                           + cg2*(v[ijk+jj1] * (ci0*s[ijk-jj1] + ci1*s[ijk    ] + ci2*s[ijk+jj1] + ci3*s[ijk+jj2]))
-                           + cg3*(v[ijk+jj2] * (ci0*s[ijk    ] + ci1*s[ijk+jj1] + ci2*s[ijk+jj2] + ci3*s[ijk+jj3])) ) * cgi*dyi;
-            }
-
-            st[ijk] -= ( cg0*(w[ijk-kk1] * (bi0*s[ijk-kk2] + bi1*s[ijk-kk1] + bi2*s[ijk    ] + bi3*s[ijk+kk1]))
-                       + cg1*(w[ijk    ] * (ci0*s[ijk-kk2] + ci1*s[ijk-kk1] + ci2*s[ijk    ] + ci3*s[ijk+kk1]))
-                       + cg2*(w[ijk+kk1] * (ci0*s[ijk-kk1] + ci1*s[ijk    ] + ci2*s[ijk+kk1] + ci3*s[ijk+kk2]))
-                       + cg3*(w[ijk+kk2] * (ci0*s[ijk    ] + ci1*s[ijk+kk1] + ci2*s[ijk+kk2] + ci3*s[ijk+kk3])) )
-                     * dzi4[kstart];
-        }
-
-    for (int k=grid->kstart+1; k<grid->kend-1; k++)
-        for (int j=grid->jstart; j<grid->jend; j++)
+            double* restrict st = stlist[n];
+            double* restrict s  = slist[n];
 #pragma ivdep
             for (int i=grid->istart; i<grid->iend; i++)
             {
-                const int ijk = i + j*jj1 + k*kk1;
+                const int ijk = i + j*jj1 + kstart*kk1;
                 st[ijk] -= ( cg0*(u[ijk-ii1] * (ci0*s[ijk-ii3] + ci1*s[ijk-ii2] + ci2*s[ijk-ii1] + ci3*s[ijk    ]))
                            + cg1*(u[ijk    ] * (ci0*s[ijk-ii2] + ci1*s[ijk-ii1] + ci2*s[ijk    ] + ci3*s[ijk+ii1]))
                            + cg2*(u[ijk+ii1] * (ci0*s[ijk-ii1] + ci1*s[ijk    ] + ci2*s[ijk+ii1] + ci3*s[ijk+ii2]))
@@ -470,36 +467,75 @@ void Advec_4::advec_s(double * restrict st, double * restrict s, double * restri
                                + cg3*(v[ijk+jj2] * (ci0*s[ijk    ] + ci1*s[ijk+jj1] + ci2*s[ijk+jj2] + ci3*s[ijk+jj3])) ) * cgi*dyi;
                 }
 
-                st[ijk] -= ( cg0*(w[ijk-kk1] * (ci0*s[ijk-kk3] + ci1*s[ijk-kk2] + ci2*s[ijk-kk1] + ci3*s[ijk    ]))
+                st[ijk] -= ( cg0*(w[ijk-kk1] * (bi0*s[ijk-kk2] + bi1*s[ijk-kk1] + bi2*s[ijk    ] + bi3*s[ijk+kk1]))
                            + cg1*(w[ijk    ] * (ci0*s[ijk-kk2] + ci1*s[ijk-kk1] + ci2*s[ijk    ] + ci3*s[ijk+kk1]))
                            + cg2*(w[ijk+kk1] * (ci0*s[ijk-kk1] + ci1*s[ijk    ] + ci2*s[ijk+kk1] + ci3*s[ijk+kk2]))
                            + cg3*(w[ijk+kk2] * (ci0*s[ijk    ] + ci1*s[ijk+kk1] + ci2*s[ijk+kk2] + ci3*s[ijk+kk3])) )
-                         * dzi4[k];
+                         * dzi4[kstart];
+            }
+        }
+
+#pragma omp parallel for
+    for (int k=grid->kstart+1; k<grid->kend-1; k++)
+        for (int j=grid->jstart; j<grid->jend; j++)
+            for (int n=0; n<nsc; ++n)
+            {
+                double* restrict st = stlist[n];
+                double* restrict s  = slist[n];
+#pragma ivdep
+                for (int i=grid->istart; i<grid->iend; i++)
+                {
+                    const int ijk = i + j*jj1 + k*kk1;
+                    st[ijk] -= ( cg0*(u[ijk-ii1] * (ci0*s[ijk-ii3] + ci1*s[ijk-ii2] + ci2*s[ijk-ii1] + ci3*s[ijk    ]))
+                               + cg1*(u[ijk    ] * (ci0*s[ijk-ii2] + ci1*s[ijk-ii1] + ci2*s[ijk    ] + ci3*s[ijk+ii1]))
+                               + cg2*(u[ijk+ii1] * (ci0*s[ijk-ii1] + ci1*s[ijk    ] + ci2*s[ijk+ii1] + ci3*s[ijk+ii2]))
+                               + cg3*(u[ijk+ii2] * (ci0*s[ijk    ] + ci1*s[ijk+ii1] + ci2*s[ijk+ii2] + ci3*s[ijk+ii3])) ) * cgi*dxi;
+
+                    if (dim3)
+                    {
+                        st[ijk] -= ( cg0*(v[ijk-jj1] * (ci0*s[ijk-jj3] + ci1*s[ijk-jj2] + ci2*s[ijk-jj1] + ci3*s[ijk    ]))
+                                   + cg1*(v[ijk    ] * (ci0*s[ijk-jj2] + ci1*s[ijk-jj1] + ci2*s[ijk    ] + ci3*s[ijk+jj1]))
+                                   + cg2*(v[ijk+jj1] * (ci0*s[ijk-jj1] + ci1*s[ijk    ] + ci2*s[ijk+jj1] + ci3*s[ijk+jj2]))
+                                   + cg3*(v[ijk+jj2] * (ci0*s[ijk    ] + ci1*s[ijk+jj1] + ci2*s[ijk+jj2] + ci3*s[ijk+jj3])) ) * cgi*dyi;
+                    }
+
+                    st[ijk] -= ( cg0*(w[ijk-kk1] * (ci0*s[ijk-kk3] + ci1*s[ijk-kk2] + ci2*s[ijk-kk1] + ci3*s[ijk    ]))
+                               + cg1*(w[ijk    ] * (ci0*s[ijk-kk2] + ci1*s[ijk-kk1] + ci2*s[ijk    ] + ci3*s[ijk+kk1]))
+                               + cg2*(w[ijk+kk1] * (ci0*s[ijk-kk1] + ci1*s[ijk    ] + ci2*s[ijk+kk1] + ci3*s[ijk+kk2]))
+                               + cg3*(w[ijk+kk2] * (ci0*s[ijk    ] + ci1*s[ijk+kk1] + ci2*s[ijk+kk2] + ci3*s[ijk+kk3])) )
+                             * dzi4[k];
+                }
             }
 
     // top boundary
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-        for (int i=grid->istart; i<grid->iend; i++)
+        for (int n=0; n<nsc; ++n)
         {
-            const int ijk = i + j*jj1 + (kend-1)*kk1;
-            st[ijk] -= ( cg0*(u[ijk-ii1] * (ci0*s[ijk-ii3] + ci1*s[ijk-ii2] + ci2*s[ijk-ii1] + ci3*s[ijk    ]))
-                       + cg1*(u[ijk    ] * (ci0*s[ijk-ii2] + ci1*s[ijk-ii1] + ci2*s[ijk    ] + ci3*s[ijk+ii1]))
-                       + cg2*(u[ijk+ii1] * (ci0*s[ijk-ii1] + ci1*s[ijk    ] + ci2*s[ijk+ii1] + ci3*s[ijk+ii2]))
-                       + cg3*(u[ijk+ii2] * (ci0*s[ijk    ] + ci1*s[ijk+ii1] + ci2*s[ijk+ii2] + ci3*s[ijk+ii3])) ) * cgi*dxi;
-
-            if (dim3)
+            double* restrict st = stlist[n];
+            double* restrict s  = slist[n];
+#pragma ivdep
+            for (int i=grid->istart; i<grid->iend; i++)
             {
-                st[ijk] -= ( cg0*(v[ijk-jj1] * (ci0*s[ijk-jj3] + ci1*s[ijk-jj2] + ci2*s[ijk-jj1] + ci3*s[ijk    ]))
-                           + cg1*(v[ijk    ] * (ci0*s[ijk-jj2] + ci1*s[ijk-jj1] + ci2*s[ijk    ] + ci3*s[ijk+jj1]))
-                           + cg2*(v[ijk+jj1] * (ci0*s[ijk-jj1] + ci1*s[ijk    ] + ci2*s[ijk+jj1] + ci3*s[ijk+jj2]))
-                           + cg3*(v[ijk+jj2] * (ci0*s[ijk    ] + ci1*s[ijk+jj1] + ci2*s[ijk+jj2] + ci3*s[ijk+jj3])) ) * cgi*dyi;
-            }
+                const int ijk = i + j*jj1 + (kend-1)*kk1;
+                st[ijk] -= ( cg0*(u[ijk-ii1] * (ci0*s[ijk-ii3] + ci1*s[ijk-ii2] + ci2*s[ijk-ii1] + ci3*s[ijk    ]))
+                           + cg1*(u[ijk    ] * (ci0*s[ijk-ii2] + ci1*s[ijk-ii1] + ci2*s[ijk    ] + ci3*s[ijk+ii1]))
+                           + cg2*(u[ijk+ii1] * (ci0*s[ijk-ii1] + ci1*s[ijk    ] + ci2*s[ijk+ii1] + ci3*s[ijk+ii2]))
+                           + cg3*(u[ijk+ii2] * (ci0*s[ijk    ] + ci1*s[ijk+ii1] + ci2*s[ijk+ii2] + ci3*s[ijk+ii3])) ) * cgi*dxi;
 
-            st[ijk] -= ( cg0*(w[ijk-kk1] * (ci0*s[ijk-kk3] + ci1*s[ijk-kk2] + ci2*s[ijk-kk1] + ci3*s[ijk    ]))
-                       + cg1*(w[ijk    ] * (ci0*s[ijk-kk2] + ci1*s[ijk-kk1] + ci2*s[ijk    ] + ci3*s[ijk+kk1]))
-                       + cg2*(w[ijk+kk1] * (ci0*s[ijk-kk1] + ci1*s[ijk    ] + ci2*s[ijk+kk1] + ci3*s[ijk+kk2]))
-                       + cg3*(w[ijk+kk2] * (ti0*s[ijk-kk1] + ti1*s[ijk    ] + ti2*s[ijk+kk1] + ti3*s[ijk+kk2])) )
-                     * dzi4[kend-1];
+                if (dim3)
+                {
+                    st[ijk] -= ( cg0*(v[ijk-jj1] * (ci0*s[ijk-jj3] + ci1*s[ijk-jj2] + ci2*s[ijk-jj1] + ci3*s[ijk    ]))
+                               + cg1*(v[ijk    ] * (ci0*s[ijk-jj2] + ci1*s[ijk-jj1] + ci2*s[ijk    ] + ci3*s[ijk+jj1]))
+                               + cg2*(v[ijk+jj1] * (ci0*s[ijk-jj1] + ci1*s[ijk    ] + ci2*s[ijk+jj1] + ci3*s[ijk+jj2]))
+                               + cg3*(v[ijk+jj2] * (ci0*s[ijk    ] + ci1*s[ijk+jj1] + ci2*s[ijk+jj2] + ci3*s[ijk+jj3])) ) * cgi*dyi;
+                }
+
+                st[ijk] -= ( cg0*(w[ijk-kk1] * (ci0*s[ijk-kk3] + ci1*s[ijk-kk2] + ci2*s[ijk-kk1] + ci3*s[ijk    ]))
+                           + cg1*(w[ijk    ] * (ci0*s[ijk-kk2] + ci1*s[ijk-kk1] + ci2*s[ijk    ] + ci3*s[ijk+kk1]))
+                           + cg2*(w[ijk+kk1] * (ci0*s[ijk-kk1] + ci1*s[ijk    ] + ci2*s[ijk+kk1] + ci3*s[ijk+kk2]))
+                           + cg3*(w[ijk+kk2] * (ti0*s[ijk-kk1] + ti1*s[ijk    ] + ti2*s[ijk+kk1] + ti3*s[ijk+kk2])) )
+                         * dzi4[kend-1];
+            }
         }
 }
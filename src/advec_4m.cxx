@@ -65,8 +65,15 @@ void Advec_4m::exec()
     advec_v(fields->vt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi4 );
     advec_w(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzhi4);
 
+    // Collect the scalars, such that the velocities are loaded once for all of them.
+    std::vector<double*> stlist, slist;
     for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); ++it)
-        advec_s(it->second->data, fields->sp[it->first]->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi4);
+    {
+        stlist.push_back(it->second->data);
+        slist .push_back(fields->sp[it->first]->data);
+    }
+
+    advec_s(stlist, slist, fields->u->data, fields->v->data, fields->w->data, grid->dzi4);
 }
 #endif
 
@@ -121,6 +128,7 @@ void Advec_4m::advec_u(double * restrict ut, double * restrict u, double * restr
     const double dyi = 1./grid->dy;
 
     // bottom boundary
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -145,6 +153,7 @@ void Advec_4m::advec_u(double * restrict ut, double * restrict u, double * restr
                        * dzi4[kstart];
         }
 
+#pragma omp parallel for
     for (int k=grid->kstart+1; k<grid->kend-1; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
@@ -170,6 +179,7 @@ void Advec_4m::advec_u(double * restrict ut, double * restrict u, double * restr
             }
 
     // top boundary
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -213,6 +223,7 @@ void Advec_4m::advec_v(double * restrict vt, double * restrict u, double * restr
     const double dyi = 1./grid->dy;
 
     // bottom boundary
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -236,6 +247,7 @@ void Advec_4m::advec_v(double * restrict vt, double * restrict u, double * restr
                        * dzi4[kstart];
         }
 
+#pragma omp parallel for
     for (int k=grid->kstart+1; k<grid->kend-1; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
@@ -261,6 +273,7 @@ void Advec_4m::advec_v(double * restrict vt, double * restrict u, double * restr
             }
 
     // top boundary
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -326,6 +339,7 @@ interp4       (w[ijk    ], w[ijk+kk1], w[ijk+kk2], w[ijk+kk3]) * interp4       (
      }
 
 */
+#pragma omp parallel for
     for (int k=grid->kstart+1; k<grid->kend; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
@@ -377,8 +391,11 @@ interp4top(w[ijk-kk1], w[ijk    ], w[ijk+kk1], w[ijk+kk2]) * interp4top(w[ijk-kk
  */
 }
 
-void Advec_4m::advec_s(double * restrict st, double * restrict s, double * restrict u, double * restrict v, double * restrict w, double * restrict dzi4)
+void Advec_4m::advec_s(const std::vector<double*>& stlist, const std::vector<double*>& slist,
+                       double * restrict u, double * restrict v, double * restrict w, double * restrict dzi4)
 {
+    const int nsc = stlist.size();
+
     const int ii1 = 1;
     const int ii2 = 2;
     const int ii3 = 3;
@@ -396,35 +413,16 @@ void Advec_4m::advec_s(double * restrict st, double * restrict s, double * restr
     const int kend   = grid->kend;
 
     // bottom boundary
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-        for (int i=grid->istart; i<grid->iend; ++i)
+        for (int n=0; n<nsc; ++n)
         {
-            const int ijk = i + j*jj1 + kstart*kk1;
-            st[ijk] +=
-                     - grad4(u[ijk-ii1] * interp2(s[ijk-ii3], s[ijk    ]),
-                             u[ijk    ] * interp2(s[ijk-ii1], s[ijk    ]),
-                             u[ijk+ii1] * interp2(s[ijk    ], s[ijk+ii1]),
-                             u[ijk+ii2] * interp2(s[ijk    ], s[ijk+ii3]), dxi)
-
-                     - grad4(v[ijk-jj1] * interp2(s[ijk-jj3], s[ijk    ]),
-                             v[ijk    ] * interp2(s[ijk-jj1], s[ijk    ]),
-                             v[ijk+jj1] * interp2(s[ijk    ], s[ijk+jj1]),
-                             v[ijk+jj2] * interp2(s[ijk    ], s[ijk+jj3]), dyi)
-
-                     - grad4x(-w[ijk+kk1] * interp2(s[ijk-kk1], s[ijk+kk2]),
-                               w[ijk    ] * interp2(s[ijk-kk1], s[ijk    ]),
-                               w[ijk+kk1] * interp2(s[ijk    ], s[ijk+kk1]),
-                               w[ijk+kk2] * interp2(s[ijk    ], s[ijk+kk3])) 
-                       * dzi4[kstart];
-        }
-
-    for (int k=grid->kstart+1; k<grid->kend-1; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+            double* restrict st = stlist[n];
+            double* restrict s  = slist[n];
 #pragma ivdep
             for (int i=grid->istart; i<grid->iend; ++i)
             {
-                const int ijk = i + j*jj1 + k*kk1;
+                const int ijk = i + j*jj1 + kstart*kk1;
                 st[ijk] +=
                          - grad4(u[ijk-ii1] * interp2(s[ijk-ii3], s[ijk    ]),
                                  u[ijk    ] * interp2(s[ijk-ii1], s[ijk    ]),
@@ -436,34 +434,71 @@ void Advec_4m::advec_s(double * restrict st, double * restrict s, double * restr
                                  v[ijk+jj1] * interp2(s[ijk    ], s[ijk+jj1]),
                                  v[ijk+jj2] * interp2(s[ijk    ], s[ijk+jj3]), dyi)
 
-                         - grad4x(w[ijk-kk1] * interp2(s[ijk-kk3], s[ijk    ]),
-                                  w[ijk    ] * interp2(s[ijk-kk1], s[ijk    ]),
-                                  w[ijk+kk1] * interp2(s[ijk    ], s[ijk+kk1]),
-                                  w[ijk+kk2] * interp2(s[ijk    ], s[ijk+kk3])) 
-                           * dzi4[k];
+                         - grad4x(-w[ijk+kk1] * interp2(s[ijk-kk1], s[ijk+kk2]),
+                                   w[ijk    ] * interp2(s[ijk-kk1], s[ijk    ]),
+                                   w[ijk+kk1] * interp2(s[ijk    ], s[ijk+kk1]),
+                                   w[ijk+kk2] * interp2(s[ijk    ], s[ijk+kk3])) 
+                           * dzi4[kstart];
+            }
+        }
+
+#pragma omp parallel for
+    for (int k=grid->kstart+1; k<grid->kend-1; ++k)
+        for (int j=grid->jstart; j<grid->jend; ++j)
+            for (int n=0; n<nsc; ++n)
+            {
+                double* restrict st = stlist[n];
+                double* restrict s  = slist[n];
+#pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk = i + j*jj1 + k*kk1;
+                    st[ijk] +=
+                             - grad4(u[ijk-ii1] * interp2(s[ijk-ii3], s[ijk    ]),
+                                     u[ijk    ] * interp2(s[ijk-ii1], s[ijk    ]),
+                                     u[ijk+ii1] * interp2(s[ijk    ], s[ijk+ii1]),
+                                     u[ijk+ii2] * interp2(s[ijk    ], s[ijk+ii3]), dxi)
+
+                             - grad4(v[ijk-jj1] * interp2(s[ijk-jj3], s[ijk    ]),
+                                     v[ijk    ] * interp2(s[ijk-jj1], s[ijk    ]),
+                                     v[ijk+jj1] * interp2(s[ijk    ], s[ijk+jj1]),
+                                     v[ijk+jj2] * interp2(s[ijk    ], s[ijk+jj3]), dyi)
+
+                             - grad4x(w[ijk-kk1] * interp2(s[ijk-kk3], s[ijk    ]),
+                                      w[ijk    ] * interp2(s[ijk-kk1], s[ijk    ]),
+                                      w[ijk+kk1] * interp2(s[ijk    ], s[ijk+kk1]),
+                                      w[ijk+kk2] * interp2(s[ijk    ], s[ijk+kk3])) 
+                               * dzi4[k];
+                }
             }
 
     // top boundary
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-        for (int i=grid->istart; i<grid->iend; ++i)
+        for (int n=0; n<nsc; ++n)
         {
-            const int ijk = i + j*jj1 + (kend-1)*kk1;
-            st[ijk] +=
-                     - grad4(u[ijk-ii1] * interp2(s[ijk-ii3], s[ijk    ]),
-                             u[ijk    ] * interp2(s[ijk-ii1], s[ijk    ]),
-                             u[ijk+ii1] * interp2(s[ijk    ], s[ijk+ii1]),
-                             u[ijk+ii2] * interp2(s[ijk    ], s[ijk+ii3]), dxi)
-
-                     - grad4(v[ijk-jj1] * interp2(s[ijk-jj3], s[ijk    ]),
-                             v[ijk    ] * interp2(s[ijk-jj1], s[ijk    ]),
-                             v[ijk+jj1] * interp2(s[ijk    ], s[ijk+jj1]),
-                             v[ijk+jj2] * interp2(s[ijk    ], s[ijk+jj3]), dyi)
-
-                     - grad4x( w[ijk-kk1] * interp2(s[ijk-kk3], s[ijk    ]),
-                               w[ijk    ] * interp2(s[ijk-kk1], s[ijk    ]),
-                               w[ijk+kk1] * interp2(s[ijk    ], s[ijk+kk1]),
-                              -w[ijk    ] * interp2(s[ijk-kk2], s[ijk+kk1])) 
-                       * dzi4[kend-1];
+            double* restrict st = stlist[n];
+            double* restrict s  = slist[n];
+#pragma ivdep
+            for (int i=grid->istart; i<grid->iend; ++i)
+            {
+                const int ijk = i + j*jj1 + (kend-1)*kk1;
+                st[ijk] +=
+                         - grad4(u[ijk-ii1] * interp2(s[ijk-ii3], s[ijk    ]),
+                                 u[ijk    ] * interp2(s[ijk-ii1], s[ijk    ]),
+                                 u[ijk+ii1] * interp2(s[ijk    ], s[ijk+ii1]),
+                                 u[ijk+ii2] * interp2(s[ijk    ], s[ijk+ii3]), dxi)
+
+                         - grad4(v[ijk-jj1] * interp2(s[ijk-jj3], s[ijk    ]),
+                                 v[ijk    ] * interp2(s[ijk-jj1], s[ijk    ]),
+                                 v[ijk+jj1] * interp2(s[ijk    ], s[ijk+jj1]),
+                                 v[ijk+jj2] * interp2(s[ijk    ], s[ijk+jj3]), dyi)
+
+                         - grad4x( w[ijk-kk1] * interp2(s[ijk-kk3], s[ijk    ]),
+                                   w[ijk    ] * interp2(s[ijk-kk1], s[ijk    ]),
+                                   w[ijk+kk1] * interp2(s[ijk    ], s[ijk+kk1]),
+                                  -w[ijk    ] * interp2(s[ijk-kk2], s[ijk+kk1])) 
+                           * dzi4[kend-1];
+            }
         }
 }
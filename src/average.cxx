@@ -0,0 +1,477 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2015 Chiel van Heerwaarden
+ * Copyright (c) 2011-2015 Thijs Heus
+ * Copyright (c) 2014-2015 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include "master.h"
+#include "grid.h"
+#include "fields.h"
+#include "average.h"
+#include "model.h"
+#include "timeloop.h"
+#include "constants.h"
+#include "defines.h"
+
+Average::Average(Model* modelin, Input* inputin)
+{
+    model  = modelin;
+    grid   = model->grid;
+    fields = model->fields;
+    master = model->master;
+
+    nsamples = 0;
+
+    savepending = false;
+    saveiotime  = 0;
+    isavetime   = 0;
+
+    int nerror = 0;
+    nerror += inputin->get_item(&swaverage, "average", "swaverage", "", "0");
+
+    if (swaverage == "1")
+    {
+        nerror += inputin->get_item(&sampletime , "average", "sampletime" , "");
+        nerror += inputin->get_item(&averagetime, "average", "averagetime", "");
+        nerror += inputin->get_list(&meanlist, "average", "meanlist", "");
+        nerror += inputin->get_list(&varlist , "average", "varlist" , "");
+        nerror += inputin->get_list(&covlist , "average", "covlist" , "");
+    }
+    else if (swaverage != "0")
+    {
+        master->print_error("\"%s\" is an illegal value for swaverage\n", swaverage.c_str());
+        throw 1;
+    }
+
+    if (nerror)
+        throw 1;
+}
+
+Average::~Average()
+{
+    for (std::map<std::string, double*>::const_iterator it=means.begin(); it!=means.end(); ++it)
+        delete[] it->second;
+
+    for (std::vector<Covariance>::const_iterator it=covs.begin(); it!=covs.end(); ++it)
+        delete[] it->data;
+}
+
+void Average::init(double ifactor)
+{
+    if (swaverage == "0")
+        return;
+
+    isampletime  = (unsigned long)(ifactor * sampletime);
+    iaveragetime = (unsigned long)(ifactor * averagetime);
+
+    if (isampletime == 0 || iaveragetime % isampletime != 0)
+    {
+        master->print_error("averagetime must be a multiple of sampletime\n");
+        throw 1;
+    }
+}
+
+int Average::check_field(std::string name)
+{
+    if (!fields->a.count(name))
+    {
+        master->print_error("field %s in [average] does not exist\n", name.c_str());
+        return 1;
+    }
+
+    // Allocate the running mean, which is needed for the variances and covariances as well.
+    if (!means.count(name))
+    {
+        means[name] = new double[grid->ncells];
+        for (int n=0; n<grid->ncells; ++n)
+            means[name][n] = 0.;
+    }
+
+    return 0;
+}
+
+void Average::create(unsigned long itime)
+{
+    if (swaverage == "0")
+        return;
+
+    // The fields at the start of the run are the last sample of the previous window.
+    istarttime = itime;
+
+    int nerror = 0;
+
+    for (std::vector<std::string>::const_iterator it=meanlist.begin(); it!=meanlist.end(); ++it)
+        nerror += check_field(*it);
+
+    std::vector<std::pair<std::string, std::string> > pairs;
+
+    for (std::vector<std::string>::const_iterator it=varlist.begin(); it!=varlist.end(); ++it)
+        pairs.push_back(std::make_pair(*it, *it));
+
+    for (std::vector<std::string>::const_iterator it=covlist.begin(); it!=covlist.end(); ++it)
+    {
+        const std::string::size_type pos = it->find('*');
+        if (pos == std::string::npos)
+        {
+            master->print_error("\"%s\" in [average][covlist] is not of the form a*b\n", it->c_str());
+            ++nerror;
+        }
+        else
+            pairs.push_back(std::make_pair(it->substr(0, pos), it->substr(pos+1)));
+    }
+
+    for (std::vector<std::pair<std::string, std::string> >::const_iterator it=pairs.begin(); it!=pairs.end(); ++it)
+    {
+        int nerrorpair = check_field(it->first);
+        if (it->second != it->first)
+            nerrorpair += check_field(it->second);
+
+        if (nerrorpair)
+        {
+            nerror += nerrorpair;
+            continue;
+        }
+
+        Covariance cov;
+        cov.name1 = it->first;
+        cov.name2 = it->second;
+        cov.data  = new double[grid->ncells];
+        for (int n=0; n<grid->ncells; ++n)
+            cov.data[n] = 0.;
+        covs.push_back(cov);
+    }
+
+    if (nerror)
+        throw 1;
+}
+
+unsigned long Average::get_time_limit(unsigned long itime)
+{
+    if (swaverage == "0")
+        return Constants::ulhuge;
+
+    return isampletime - itime % isampletime;
+}
+
+std::string Average::get_switch()
+{
+    return swaverage;
+}
+
+void Average::get_fieldlist(std::vector<std::string>* list)
+{
+    // The running means contain all fields that appear in the mean, variance or covariance lists.
+    for (std::map<std::string, double*>::const_iterator it=means.begin(); it!=means.end(); ++it)
+        list->push_back(it->first);
+}
+
+bool Average::do_average()
+{
+    if (swaverage == "0")
+        return false;
+
+    const unsigned long itime = model->timeloop->get_itime();
+    if (itime % isampletime == 0 && itime > istarttime)
+        return true;
+    else
+        return false;
+}
+
+/**
+ * This function adds the current fields to the running statistics. The update of the sums of the
+ * products of the deviations uses the means of the previous samples, and is thus done before the
+ * update of the means. This avoids the loss of precision of the sum of squares minus the squared mean.
+ */
+void Average::exec()
+{
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+
+    const double nnew = nsamples + 1;
+    const double fac  = nsamples / nnew;
+
+    for (std::vector<Covariance>::iterator it=covs.begin(); it!=covs.end(); ++it)
+    {
+        double* restrict cov   = it->data;
+        const double* restrict a     = fields->a[it->name1]->data;
+        const double* restrict b     = fields->a[it->name2]->data;
+        const double* restrict meana = means[it->name1];
+        const double* restrict meanb = means[it->name2];
+
+        for (int k=grid->kstart; k<grid->kend; ++k)
+            for (int j=grid->jstart; j<grid->jend; ++j)
+#pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    cov[ijk] += fac * (a[ijk]-meana[ijk]) * (b[ijk]-meanb[ijk]);
+                }
+    }
+
+    for (std::map<std::string, double*>::iterator it=means.begin(); it!=means.end(); ++it)
+    {
+        double* restrict mean = it->second;
+        const double* restrict a = fields->a[it->first]->data;
+
+        for (int k=grid->kstart; k<grid->kend; ++k)
+            for (int j=grid->jstart; j<grid->jend; ++j)
+#pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    mean[ijk] += (a[ijk]-mean[ijk]) / nnew;
+                }
+    }
+
+    ++nsamples;
+
+    // Save the averages at the end of the window and start a new one.
+    if (model->timeloop->get_itime() % iaveragetime != 0)
+        return;
+
+    for (std::vector<std::string>::const_iterator it=meanlist.begin(); it!=meanlist.end(); ++it)
+        save(means[*it], 1., *it + ".mean");
+
+    for (std::vector<Covariance>::const_iterator it=covs.begin(); it!=covs.end(); ++it)
+    {
+        if (it->name1 == it->name2)
+            save(it->data, 1./nsamples, it->name1 + ".var");
+        else
+            save(it->data, 1./nsamples, it->name1 + "_" + it->name2 + ".cov");
+    }
+
+    for (std::map<std::string, double*>::iterator it=means.begin(); it!=means.end(); ++it)
+        for (int n=0; n<grid->ncells; ++n)
+            it->second[n] = 0.;
+
+    for (std::vector<Covariance>::iterator it=covs.begin(); it!=covs.end(); ++it)
+        for (int n=0; n<grid->ncells; ++n)
+            it->data[n] = 0.;
+
+    nsamples = 0;
+}
+
+/**
+ * This function saves the running statistics along with the restart files of the fields. The sample at
+ * the time of the restart is taken in the statistics step after the save, and a restarted run skips it,
+ * thus in that case the running statistics are saved directly after that sample has been added.
+ */
+void Average::save(int iotime)
+{
+    if (swaverage == "0")
+        return;
+
+    const unsigned long itime = model->timeloop->get_itime();
+
+    if (itime % isampletime == 0 && itime > istarttime)
+    {
+        savepending = true;
+        saveiotime  = iotime;
+        isavetime   = itime;
+    }
+    else
+        save_restart(iotime);
+}
+
+void Average::exec_save()
+{
+    if (savepending && model->timeloop->get_itime() == isavetime)
+    {
+        savepending = false;
+        save_restart(saveiotime);
+    }
+}
+
+void Average::save_restart(int iotime)
+{
+    const double NoOffset = 0.;
+
+    double* restrict tmp1 = fields->atmp["tmp1"]->data;
+    double* restrict tmp2 = fields->atmp["tmp2"]->data;
+
+    int nerror = 0;
+
+    // The number of samples is saved by the main process.
+    if (master->mpiid == 0)
+    {
+        char filename[256];
+        std::sprintf(filename, "average.%07d", iotime);
+        master->print_message("Saving \"%s\" ... ", filename);
+
+        FILE *pFile = std::fopen(filename, "wbx");
+        if (pFile == NULL)
+        {
+            master->print_message("FAILED\n");
+            ++nerror;
+        }
+        else
+        {
+            std::fwrite(&nsamples, sizeof(int), 1, pFile);
+            std::fclose(pFile);
+            master->print_message("OK\n");
+        }
+    }
+
+    master->broadcast(&nerror, 1);
+
+    for (std::map<std::string, double*>::const_iterator it=means.begin(); it!=means.end(); ++it)
+    {
+        char filename[256];
+        std::sprintf(filename, "%s.avgmean.%07d", it->first.c_str(), iotime);
+        master->print_message("Saving \"%s\" ... ", filename);
+
+        if (grid->save_field3d(it->second, tmp1, tmp2, filename, NoOffset, true))
+        {
+            master->print_message("FAILED\n");
+            ++nerror;
+        }
+        else
+            master->print_message("OK\n");
+    }
+
+    for (std::vector<Covariance>::const_iterator it=covs.begin(); it!=covs.end(); ++it)
+    {
+        char filename[256];
+        std::sprintf(filename, "%s_%s.avgcov.%07d", it->name1.c_str(), it->name2.c_str(), iotime);
+        master->print_message("Saving \"%s\" ... ", filename);
+
+        if (grid->save_field3d(it->data, tmp1, tmp2, filename, NoOffset, true))
+        {
+            master->print_message("FAILED\n");
+            ++nerror;
+        }
+        else
+            master->print_message("OK\n");
+    }
+
+    if (nerror)
+        throw 1;
+}
+
+void Average::load(int iotime)
+{
+    if (swaverage == "0")
+        return;
+
+    const double NoOffset = 0.;
+
+    double* restrict tmp1 = fields->atmp["tmp1"]->data;
+    double* restrict tmp2 = fields->atmp["tmp2"]->data;
+
+    // A run that starts without running statistics, for instance from the initial fields,
+    // starts with an empty window.
+    int nerror = 0;
+    int found  = 0;
+
+    if (master->mpiid == 0)
+    {
+        char filename[256];
+        std::sprintf(filename, "average.%07d", iotime);
+
+        FILE *pFile = std::fopen(filename, "rb");
+        if (pFile != NULL)
+        {
+            master->print_message("Loading \"%s\" ... ", filename);
+            if (std::fread(&nsamples, sizeof(int), 1, pFile) == 1)
+            {
+                found = 1;
+                master->print_message("OK\n");
+            }
+            else
+            {
+                master->print_message("FAILED\n");
+                ++nerror;
+            }
+            std::fclose(pFile);
+        }
+    }
+
+    master->broadcast(&nerror, 1);
+    if (nerror)
+        throw 1;
+
+    master->broadcast(&found, 1);
+    if (!found)
+    {
+        if (model->timeloop->get_itime() % iaveragetime != 0)
+            master->print_warning("no running averages found for time %d, the first window is incomplete\n", iotime);
+        nsamples = 0;
+        return;
+    }
+
+    master->broadcast(&nsamples, 1);
+
+    for (std::map<std::string, double*>::const_iterator it=means.begin(); it!=means.end(); ++it)
+    {
+        char filename[256];
+        std::sprintf(filename, "%s.avgmean.%07d", it->first.c_str(), iotime);
+        master->print_message("Loading \"%s\" ... ", filename);
+
+        if (grid->load_field3d(it->second, tmp1, tmp2, filename, NoOffset))
+        {
+            master->print_message("FAILED\n");
+            ++nerror;
+        }
+        else
+            master->print_message("OK\n");
+    }
+
+    for (std::vector<Covariance>::const_iterator it=covs.begin(); it!=covs.end(); ++it)
+    {
+        char filename[256];
+        std::sprintf(filename, "%s_%s.avgcov.%07d", it->name1.c_str(), it->name2.c_str(), iotime);
+        master->print_message("Loading \"%s\" ... ", filename);
+
+        if (grid->load_field3d(it->data, tmp1, tmp2, filename, NoOffset))
+        {
+            master->print_message("FAILED\n");
+            ++nerror;
+        }
+        else
+            master->print_message("OK\n");
+    }
+
+    if (nerror)
+        throw 1;
+}
+
+void Average::save(double* restrict data, const double fac, std::string name)
+{
+    const double NoOffset = 0.;
+
+    double* restrict tmp1 = fields->atmp["tmp1"]->data;
+    double* restrict tmp2 = fields->atmp["tmp2"]->data;
+    double* restrict tmp3 = fields->atmp["tmp3"]->data;
+
+    for (int n=0; n<grid->ncells; ++n)
+        tmp3[n] = fac*data[n];
+
+    char filename[256];
+    std::sprintf(filename, "%s.%07d", name.c_str(), model->timeloop->get_iotime());
+    master->print_message("Saving \"%s\" ... ", filename);
+
+    if (grid->save_field3d(tmp3, tmp1, tmp2, filename, NoOffset, false))
+    {
+        master->print_message("FAILED\n");
+        throw 1;
+    }
+    else
+        master->print_message("OK\n");
+}
@@ -288,14 +288,31 @@ void Boundary::set_values()
 
 #ifndef USECUDA
 void Boundary::exec()
+{
+    exec_start();
+    exec_end();
+}
+
+void Boundary::exec_start()
 {
     // Cyclic boundary conditions, do this before the bottom BC's
-    grid->boundary_cyclic(fields->u->data);
-    grid->boundary_cyclic(fields->v->data);
-    grid->boundary_cyclic(fields->w->data);
+    // The exchange is only started here, such that computations that do not
+    // need the ghost cells can be done before calling exec_end().
+    // The ghost cells of all prognostic fields are exchanged together, with one message per neighbor.
+    cyclic_fields.clear();
+    cyclic_fields.push_back(fields->u->data);
+    cyclic_fields.push_back(fields->v->data);
+    cyclic_fields.push_back(fields->w->data);
 
     for (FieldMap::const_iterator it = fields->sp.begin(); it!=fields->sp.end(); ++it)
-        grid->boundary_cyclic(it->second->data);
+        cyclic_fields.push_back(it->second->data);
+
+    grid->boundary_cyclic_start(cyclic_fields);
+}
+
+void Boundary::exec_end()
+{
+    grid->boundary_cyclic_end(cyclic_fields);
 
     // Update the boundary values.
     update_bcs();
@@ -352,6 +369,16 @@ void Boundary::set_ghost_cells_w(const Boundary_w_type boundary_w_type)
         }
     }
 }
+#else
+// The GPU does not overlap the ghost cell exchange, the complete update is done at the start.
+void Boundary::exec_start()
+{
+    exec();
+}
+
+void Boundary::exec_end()
+{
+}
 #endif
 
 void Boundary::exec_cross()
@@ -362,6 +389,10 @@ void Boundary::exec_stats(Mask* m)
 {
 }
 
+void Boundary::exec_column()
+{
+}
+
 // Computational kernel for boundary calculation.
 namespace
 {
@@ -35,6 +35,7 @@
 #include "model.h"
 #include "master.h"
 #include "cross.h"
+#include "column.h"
 #include "monin_obukhov.h"
 
 namespace
@@ -87,6 +88,13 @@ void Boundary_surface::create(Input *inputin)
         stats->add_time_series("ustar", "Surface friction velocity", "m s-1");
         stats->add_time_series("obuk", "Obukhov length", "m");
     }
+
+    // add variables to the columns
+    if (model->column->get_switch() == "1")
+    {
+        model->column->add_time_series("ustar", "Surface friction velocity", "m s-1");
+        model->column->add_time_series("obuk", "Obukhov length", "m");
+    }
 }
 
 void Boundary_surface::init(Input *inputin)
@@ -221,6 +229,12 @@ void Boundary_surface::exec_cross()
         throw 1;
 }
 
+void Boundary_surface::exec_column()
+{
+    model->column->calc_time_series("ustar", ustar);
+    model->column->calc_time_series("obuk" , obuk );
+}
+
 void Boundary_surface::exec_stats(Mask *m)
 {
     stats->calc_mean2d(&m->tseries["obuk"].data , obuk , 0., fields->atmp["tmp4"]->databot, &stats->nmaskbot);
@@ -0,0 +1,402 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2015 Chiel van Heerwaarden
+ * Copyright (c) 2011-2015 Thijs Heus
+ * Copyright (c) 2014-2015 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cmath>
+#include "master.h"
+#include "grid.h"
+#include "fields.h"
+#include "column.h"
+#include "model.h"
+#include "timeloop.h"
+#include "constants.h"
+#include "defines.h"
+#include <netcdfcpp.h>
+
+Column::Column(Model* modelin, Input* inputin)
+{
+    model  = modelin;
+    grid   = model->grid;
+    fields = model->fields;
+    master = model->master;
+
+    dataFile  = 0;
+    nstats    = 0;
+    nbuffered = 0;
+
+    int nerror = 0;
+    nerror += inputin->get_item(&swcolumn, "column", "swcolumn", "", "0");
+
+    if (swcolumn == "1")
+    {
+        nerror += inputin->get_item(&synctime, "column", "synctime", "");
+        nerror += inputin->get_list(&coordx, "column", "x", "");
+        nerror += inputin->get_list(&coordy, "column", "y", "");
+        nerror += inputin->get_list(&columnlist, "column", "columnlist", "");
+
+        if (coordx.size() != coordy.size())
+        {
+            ++nerror;
+            master->print_error("the number of x and y coordinates of the columns differs\n");
+        }
+    }
+    else if (swcolumn != "0")
+    {
+        ++nerror;
+        master->print_error("\"%s\" is an illegal value for swcolumn\n", swcolumn.c_str());
+    }
+
+    if (nerror)
+        throw 1;
+}
+
+Column::~Column()
+{
+    delete dataFile;
+}
+
+void Column::init(double ifactor)
+{
+    if (swcolumn == "0")
+        return;
+
+    isynctime = (unsigned long)(ifactor * synctime);
+
+    if (coordx.empty())
+    {
+        master->print_error("no coordinates given for the columns\n");
+        throw 1;
+    }
+
+    if (isynctime == 0)
+    {
+        master->print_error("synctime of the columns has to be larger than zero\n");
+        throw 1;
+    }
+
+    // find the nearest full grid point of every column
+    for (size_t n=0; n<coordx.size(); ++n)
+    {
+        if (coordx[n] < 0. || coordx[n] >= grid->xsize || coordy[n] < 0. || coordy[n] >= grid->ysize)
+        {
+            master->print_error("column at x = %f, y = %f is outside of the domain\n", coordx[n], coordy[n]);
+            throw 1;
+        }
+
+        icol.push_back((int) std::floor(coordx[n]/grid->dx));
+        jcol.push_back((int) std::floor(coordy[n]/grid->dy));
+
+        // the samples of a column are kept by the process that contains it
+        const int i = icol[n] - master->mpicoordx*grid->imax;
+        const int j = jcol[n] - master->mpicoordy*grid->jmax;
+        if (i >= 0 && i < grid->imax && j >= 0 && j < grid->jmax)
+            colown.push_back(n);
+    }
+
+    // let the main process know which columns are kept by which process
+    int nown = colown.size();
+    std::vector<int> ones(master->nprocs, 1);
+    if (master->mpiid == 0)
+    {
+        ncolproc.resize(master->nprocs);
+        colproc.resize(icol.size());
+    }
+    master->gather(&nown, 1, master->mpiid == 0 ? &ncolproc[0] : 0, &ones[0]);
+    master->gather(nown > 0 ? &colown[0] : 0, nown, master->mpiid == 0 ? &colproc[0] : 0, master->mpiid == 0 ? &ncolproc[0] : 0);
+}
+
+void Column::create(int n)
+{
+    if (swcolumn == "0")
+        return;
+
+    int nerror = 0;
+
+    // the file with all columns is written by the master process
+    if (master->mpiid == 0)
+    {
+        char filename[256];
+        std::sprintf(filename, "%s.%s.%07d.nc", master->simname.c_str(), "column", n);
+        dataFile = new NcFile(filename, NcFile::New);
+        if (!dataFile->is_valid())
+            ++nerror;
+    }
+
+    // crash on all processes in case the file could not be written
+    master->broadcast(&nerror, 1);
+    if (nerror)
+    {
+        master->print_error("cannot write the column file\n");
+        throw 1;
+    }
+
+    if (master->mpiid == 0)
+    {
+        const int ncol = icol.size();
+
+        z_dim   = dataFile->add_dim("z" , grid->kmax);
+        zh_dim  = dataFile->add_dim("zh", grid->kmax+1);
+        col_dim = dataFile->add_dim("column", ncol);
+        t_dim   = dataFile->add_dim("t");
+
+        iter_var = dataFile->add_var("iter", ncInt, t_dim);
+        iter_var->add_att("units", "-");
+        iter_var->add_att("long_name", "Iteration number");
+
+        t_var = dataFile->add_var("t", ncDouble, t_dim);
+        t_var->add_att("units", "s");
+        t_var->add_att("long_name", "Time");
+
+        NcVar* z_var = dataFile->add_var("z", ncDouble, z_dim);
+        z_var->add_att("units", "m");
+        z_var->add_att("long_name", "Full level height");
+
+        NcVar* zh_var = dataFile->add_var("zh", ncDouble, zh_dim);
+        zh_var->add_att("units", "m");
+        zh_var->add_att("long_name", "Half level height");
+
+        NcVar* x_var = dataFile->add_var("x", ncDouble, col_dim);
+        x_var->add_att("units", "m");
+        x_var->add_att("long_name", "X-position of the column");
+
+        NcVar* y_var = dataFile->add_var("y", ncDouble, col_dim);
+        y_var->add_att("units", "m");
+        y_var->add_att("long_name", "Y-position of the column");
+
+        z_var ->put(&grid->z [grid->kstart], grid->kmax  );
+        zh_var->put(&grid->zh[grid->kstart], grid->kmax+1);
+
+        std::vector<double> x(ncol), y(ncol);
+        for (int n=0; n<ncol; ++n)
+        {
+            x[n] = (icol[n]+0.5)*grid->dx;
+            y[n] = (jcol[n]+0.5)*grid->dy;
+        }
+        x_var->put(&x[0], ncol);
+        y_var->put(&y[0], ncol);
+
+        dataFile->sync();
+    }
+}
+
+unsigned long Column::get_time_limit(unsigned long itime)
+{
+    if (swcolumn == "0")
+        return Constants::ulhuge;
+
+    return isynctime - itime % isynctime;
+}
+
+std::string Column::get_switch()
+{
+    return swcolumn;
+}
+
+std::vector<std::string>* Column::get_columnlist()
+{
+    return &columnlist;
+}
+
+bool Column::do_column()
+{
+    return (swcolumn == "1");
+}
+
+void Column::add_prof(std::string name, std::string longname, std::string unit, std::string zloc)
+{
+    Column_var* var = &vars[name];
+
+    if (master->mpiid == 0)
+    {
+        NcDim* kdim = (zloc == "zh") ? zh_dim : z_dim;
+        var->ncvar = dataFile->add_var(name.c_str(), ncDouble, t_dim, col_dim, kdim);
+        var->ncvar->add_att("units", unit.c_str());
+        var->ncvar->add_att("long_name", longname.c_str());
+        var->ncvar->add_att("_FillValue", NC_FILL_DOUBLE);
+    }
+
+    var->nlevels = (zloc == "zh") ? grid->kmax+1 : grid->kmax;
+}
+
+void Column::add_time_series(std::string name, std::string longname, std::string unit)
+{
+    Column_var* var = &vars[name];
+
+    if (master->mpiid == 0)
+    {
+        var->ncvar = dataFile->add_var(name.c_str(), ncDouble, t_dim, col_dim);
+        var->ncvar->add_att("units", unit.c_str());
+        var->ncvar->add_att("long_name", longname.c_str());
+        var->ncvar->add_att("_FillValue", NC_FILL_DOUBLE);
+    }
+
+    var->nlevels = 1;
+}
+
+/**
+ * This function appends the values of a 3d field in the columns of this process to the buffer.
+ */
+void Column::calc_column(std::string name, const double* restrict data, const double offset)
+{
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+
+    Column_var* var = &vars[name];
+    const int nlevels = var->nlevels;
+
+    for (std::vector<int>::const_iterator it=colown.begin(); it!=colown.end(); ++it)
+    {
+        const int i = icol[*it] - master->mpicoordx*grid->imax;
+        const int j = jcol[*it] - master->mpicoordy*grid->jmax;
+
+        for (int k=0; k<nlevels; ++k)
+        {
+            const int ijk = i+grid->istart + (j+grid->jstart)*jj + (k+grid->kstart)*kk;
+            var->buffer.push_back(data[ijk] + offset);
+        }
+    }
+}
+
+void Column::calc_time_series(std::string name, const double* restrict data)
+{
+    const int jj = grid->icells;
+
+    Column_var* var = &vars[name];
+
+    for (std::vector<int>::const_iterator it=colown.begin(); it!=colown.end(); ++it)
+    {
+        const int i = icol[*it] - master->mpicoordx*grid->imax;
+        const int j = jcol[*it] - master->mpicoordy*grid->jmax;
+
+        var->buffer.push_back(data[i+grid->istart + (j+grid->jstart)*jj]);
+    }
+}
+
+void Column::exec(int iteration, double time, unsigned long itime)
+{
+    tbuf   .push_back(time);
+    iterbuf.push_back(iteration);
+
+    ++nbuffered;
+
+    // write all samples in memory at once
+    if (itime % isynctime == 0)
+        write_buffer();
+}
+
+/**
+ * This function writes the samples in memory to the file. It has to be called by all processes,
+ * and is called at the end of the run to write the samples after the last sync time.
+ */
+void Column::write_buffer()
+{
+    if (swcolumn == "0" || nbuffered == 0)
+        return;
+
+    const int ncol = icol.size();
+
+    if (master->mpiid == 0)
+    {
+        t_var->set_cur(nstats);
+        t_var->put(&tbuf[0], nbuffered);
+
+        iter_var->set_cur(nstats);
+        iter_var->put(&iterbuf[0], nbuffered);
+    }
+
+    // collect the columns of all processes at the master process, one variable
+    // at a time to limit the memory use at the main process
+    std::vector<double> buffer;
+    for (Column_map::iterator it=vars.begin(); it!=vars.end(); ++it)
+    {
+        gather_buffer(it->second.buffer, buffer, it->second.nlevels);
+
+        if (master->mpiid == 0)
+        {
+            if (it->second.nlevels == 1)
+            {
+                it->second.ncvar->set_cur(nstats, 0);
+                it->second.ncvar->put(&buffer[0], nbuffered, ncol);
+            }
+            else
+            {
+                it->second.ncvar->set_cur(nstats, 0, 0);
+                it->second.ncvar->put(&buffer[0], nbuffered, ncol, it->second.nlevels);
+            }
+        }
+    }
+
+    if (master->mpiid == 0)
+        dataFile->sync();
+
+    tbuf.clear();
+    iterbuf.clear();
+    for (Column_map::iterator it=vars.begin(); it!=vars.end(); ++it)
+        it->second.buffer.clear();
+
+    nstats += nbuffered;
+    nbuffered = 0;
+}
+
+/**
+ * This function collects the buffered samples of the columns of all processes at the main process,
+ * and orders them by time, column and level, in the order of the columns in the ini file.
+ */
+void Column::gather_buffer(const std::vector<double>& sendbuf, std::vector<double>& buffer, const int nlevels)
+{
+    const int ncol  = icol.size();
+    const int nsend = sendbuf.size();
+
+    std::vector<double> recvbuf;
+    std::vector<int> recvsizes;
+
+    if (master->mpiid == 0)
+    {
+        recvbuf.resize(ncol*nbuffered*nlevels);
+        buffer .resize(ncol*nbuffered*nlevels);
+        for (int n=0; n<master->nprocs; ++n)
+            recvsizes.push_back(ncolproc[n]*nbuffered*nlevels);
+    }
+
+    master->gather(nsend > 0 ? const_cast<double*>(&sendbuf[0]) : 0, nsend,
+                   master->mpiid == 0 ? &recvbuf[0] : 0, master->mpiid == 0 ? &recvsizes[0] : 0);
+
+    if (master->mpiid != 0)
+        return;
+
+    // the samples of every process are ordered by time, column of the process and level
+    int offset = 0;
+    int ncolprev = 0;
+    for (int n=0; n<master->nprocs; ++n)
+    {
+        for (int t=0; t<nbuffered; ++t)
+            for (int c=0; c<ncolproc[n]; ++c)
+            {
+                const int col = colproc[ncolprev+c];
+                for (int k=0; k<nlevels; ++k)
+                    buffer[(t*ncol + col)*nlevels + k] = recvbuf[offset + (t*ncolproc[n] + c)*nlevels + k];
+            }
+
+        offset   += ncolproc[n]*nbuffered*nlevels;
+        ncolprev += ncolproc[n];
+    }
+}
@@ -22,6 +22,7 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <cmath>
 #include <algorithm>    // std::count
 #include "master.h"
@@ -43,6 +44,9 @@ Cross::Cross(Model* modelin, Input* inputin)
     fields = model->fields;
     master = model->master;
 
+    indexfile  = NULL;
+    fileoffset = 0;
+
     // Optional, by default switch cross off.
     int nerror = 0;
     nerror += inputin->get_item(&swcross, "cross", "swcross", "", "0");
@@ -52,6 +56,15 @@ Cross::Cross(Model* modelin, Input* inputin)
         // Get the time at which the cross sections are triggered.
         nerror += inputin->get_item(&sampletime, "cross", "sampletime", "");
 
+        // Write all cross sections of one time into a single file.
+        nerror += inputin->get_item(&swaggregate, "cross", "swaggregate", "", "0");
+
+        if (!(swaggregate == "0" || swaggregate == "1"))
+        {
+            ++nerror;
+            master->print_error("\"%s\" is an illegal value for swaggregate\n", swaggregate.c_str());
+        }
+
         // Get list of cross variables.
         nerror += inputin->get_list(&crosslist , "cross", "crosslist" , "");
 
@@ -92,6 +105,117 @@ int Cross::check_save(int error, char* filename)
     }
 }
 
+/**
+ * This function saves a slice of the given orientation at the given index, where an index of -1
+ * denotes a 2d plane. The slice is either written to its own file, or appended to the file
+ * of all cross sections of this time, of which the position is listed in the index file.
+ */
+int Cross::save_slice(double* restrict data, double* restrict tmp, std::string name, std::string orientation, int index)
+{
+    if (swaggregate == "1")
+    {
+        int nerror = 0;
+        int n1, n2;
+
+        if (orientation == "xz")
+        {
+            n1 = grid->itot; n2 = grid->kmax;
+            nerror += grid->write_xz_slice(data, tmp, index, fileoffset);
+        }
+        else if (orientation == "yz")
+        {
+            n1 = grid->jtot; n2 = grid->kmax;
+            nerror += grid->write_yz_slice(data, tmp, index, fileoffset);
+        }
+        else
+        {
+            n1 = grid->itot; n2 = grid->jtot;
+            nerror += grid->write_xy_slice(data, tmp, index, fileoffset);
+        }
+
+        if (master->mpiid == 0)
+            std::fprintf(indexfile, "%-16s %2s %5d %16lu %6d %6d\n",
+                    name.c_str(), orientation.c_str(), index, fileoffset, n1, n2);
+
+        fileoffset += (unsigned long)n1*n2*sizeof(double);
+
+        if (nerror)
+            master->print_error("cannot write cross section %s.%s.%05d\n", name.c_str(), orientation.c_str(), index);
+
+        return nerror;
+    }
+
+    char filename[256];
+    const int iotime = model->timeloop->get_iotime();
+
+    if (index == -1)
+    {
+        std::sprintf(filename, "%s.%s.%07d", name.c_str(), orientation.c_str(), iotime);
+        return check_save(grid->save_xy_slice(data, tmp, filename), filename);
+    }
+
+    std::sprintf(filename, "%s.%s.%05d.%07d", name.c_str(), orientation.c_str(), index, iotime);
+
+    if (orientation == "xz")
+        return check_save(grid->save_xz_slice(data, tmp, filename, index), filename);
+    else if (orientation == "yz")
+        return check_save(grid->save_yz_slice(data, tmp, filename, index), filename);
+    else
+        return check_save(grid->save_xy_slice(data, tmp, filename, index), filename);
+}
+
+void Cross::start_output()
+{
+    if (swaggregate == "0")
+        return;
+
+    int nerror = 0;
+    char filename[256];
+    std::sprintf(filename, "%s.%07d", "cross", model->timeloop->get_iotime());
+
+    master->print_message("Saving \"%s\" ... ", filename);
+    if (grid->open_slice_file(filename))
+        ++nerror;
+
+    // The index file lists name, orientation, index, byte offset and dimensions of each cross section.
+    if (master->mpiid == 0)
+    {
+        std::strcat(filename, ".idx");
+        indexfile = std::fopen(filename, "wx");
+        if (indexfile == NULL)
+            ++nerror;
+        else
+            std::fprintf(indexfile, "%-16s %2s %5s %16s %6s %6s\n",
+                    "NAME", "OR", "INDEX", "OFFSET", "N1", "N2");
+    }
+    master->broadcast(&nerror, 1);
+
+    if (nerror)
+    {
+        master->print_message("FAILED\n");
+        throw 1;
+    }
+
+    fileoffset = 0;
+}
+
+void Cross::finish_output()
+{
+    if (swaggregate == "0")
+        return;
+
+    if (master->mpiid == 0)
+    {
+        std::fclose(indexfile);
+        indexfile = NULL;
+    }
+
+    if (grid->close_slice_file())
+        master->print_message("FAILED\n");
+    else
+        master->print_message("OK\n");
+}
+
 void Cross::init(double ifactor)
 {
     if (swcross == "0")
@@ -290,23 +414,20 @@ bool Cross::do_cross()
 int Cross::cross_simple(double* restrict data, double* restrict tmp, std::string name)
 {
     int nerror = 0;
-    char filename[256];
 
     // loop over the index arrays to save all xz cross sections
     if (name == "v")
     {
         for (std::vector<int>::iterator it=jxzh.begin(); it<jxzh.end(); ++it)
         {
-            std::sprintf(filename, "%s.%s.%05d.%07d", name.c_str(), "xz", *it, model->timeloop->get_iotime());
-            nerror += check_save(grid->save_xz_slice(data, tmp, filename, *it), filename);    
+            nerror += save_slice(data, tmp, name, "xz", *it);
         }
     }
     else
     {
         for (std::vector<int>::iterator it=jxz.begin(); it<jxz.end(); ++it)
         {
-            std::sprintf(filename, "%s.%s.%05d.%07d", name.c_str(), "xz", *it, model->timeloop->get_iotime());
-            nerror += check_save(grid->save_xz_slice(data, tmp, filename, *it), filename);    
+            nerror += save_slice(data, tmp, name, "xz", *it);
         }
     }
     
@@ -315,16 +436,14 @@ int Cross::cross_simple(double* restrict data, double* restrict tmp, std::string
     {
         for (std::vector<int>::iterator it=ixzh.begin(); it<ixzh.end(); ++it)
         {
-            std::sprintf(filename, "%s.%s.%05d.%07d", name.c_str(), "yz", *it, model->timeloop->get_iotime());
-            nerror += check_save(grid->save_yz_slice(data, tmp, filename, *it), filename);    
+            nerror += save_slice(data, tmp, name, "yz", *it);
         }
     }
     else
     {
         for (std::vector<int>::iterator it=ixz.begin(); it<ixz.end(); ++it)
         {
-            std::sprintf(filename, "%s.%s.%05d.%07d", name.c_str(), "yz", *it, model->timeloop->get_iotime());
-            nerror += check_save(grid->save_yz_slice(data, tmp, filename, *it), filename);    
+            nerror += save_slice(data, tmp, name, "yz", *it);
         }
     }
 
@@ -333,16 +452,14 @@ int Cross::cross_simple(double* restrict data, double* restrict tmp, std::string
         // loop over the index arrays to save all xy cross sections
         for (std::vector<int>::iterator it=kxyh.begin(); it<kxyh.end(); ++it)
         {
-            std::sprintf(filename, "%s.%s.%05d.%07d", name.c_str(), "xy", *it, model->timeloop->get_iotime());
-            nerror += check_save(grid->save_xy_slice(data, tmp, filename, *it), filename);
+            nerror += save_slice(data, tmp, name, "xy", *it);
         }
     }
     else
     {
         for (std::vector<int>::iterator it=kxy.begin(); it<kxy.end(); ++it)
         {
-            std::sprintf(filename, "%s.%s.%05d.%07d", name.c_str(), "xy", *it, model->timeloop->get_iotime());
-            nerror += check_save(grid->save_xy_slice(data, tmp, filename, *it), filename);
+            nerror += save_slice(data, tmp, name, "xy", *it);
         }
     }
 
@@ -352,10 +469,8 @@ int Cross::cross_simple(double* restrict data, double* restrict tmp, std::string
 int Cross::cross_plane(double* restrict data, double* restrict tmp, std::string name)
 {
     int nerror = 0;
-    char filename[256];
 
-    std::sprintf(filename, "%s.%s.%07d", name.c_str(), "xy", model->timeloop->get_iotime());
-    nerror += check_save(grid->save_xy_slice(data, tmp, filename), filename);
+    nerror += save_slice(data, tmp, name, "xy", -1);
 
     return nerror;
 } 
@@ -381,7 +496,6 @@ int Cross::cross_lngrad(double* restrict a, double* restrict lngrad, double* res
     const double dyi = 1./grid->dy;
 
     int nerror = 0;
-    char filename[256];
 
     // calculate the log of the gradient
     // bottom
@@ -458,22 +572,19 @@ int Cross::cross_lngrad(double* restrict a, double* restrict lngrad, double* res
     // loop over the index arrays to save all xz cross sections
     for (std::vector<int>::iterator it=jxz.begin(); it<jxz.end(); ++it)
     {
-        std::sprintf(filename, "%s.%s.%05d.%07d", name.c_str(), "xz", *it, model->timeloop->get_iotime());
-        nerror += check_save(grid->save_xz_slice(lngrad, tmp, filename, *it),filename);
+        nerror += save_slice(lngrad, tmp, name, "xz", *it);
     }
     
     // loop over the index arrays to save all yz cross sections
     for (std::vector<int>::iterator it=ixz.begin(); it<ixz.end(); ++it)
     {
-        std::sprintf(filename, "%s.%s.%05d.%07d", name.c_str(), "yz", *it, model->timeloop->get_iotime());
-        nerror += check_save(grid->save_yz_slice(lngrad, tmp, filename, *it),filename);
+        nerror += save_slice(lngrad, tmp, name, "yz", *it);
     }
 
     // loop over the index arrays to save all xy cross sections
     for (std::vector<int>::iterator it=kxy.begin(); it<kxy.end(); ++it)
     {
-        std::sprintf(filename, "%s.%s.%05d.%07d", name.c_str(), "xy", *it, model->timeloop->get_iotime());
-        nerror += check_save(grid->save_xy_slice(lngrad, tmp, filename, *it),filename);
+        nerror += save_slice(lngrad, tmp, name, "xy", *it);
     }
 
     return nerror;
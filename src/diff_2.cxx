@@ -27,6 +27,7 @@
 #include "fields.h"
 #include "master.h"
 #include "diff_2.h"
+#include "advec.h"
 #include "defines.h"
 #include "model.h"
 
@@ -64,17 +65,65 @@ double Diff_2::get_dn(const double dt)
 #ifndef USECUDA
 void Diff_2::exec()
 {
-    diff_c(fields->ut->data, fields->u->data, grid->dzi, grid->dzhi, fields->visc);
-    diff_c(fields->vt->data, fields->v->data, grid->dzi, grid->dzhi, fields->visc);
-    diff_w(fields->wt->data, fields->w->data, grid->dzi, grid->dzhi, fields->visc);
+    exec_box(grid->istart, grid->iend, grid->jstart, grid->jend, grid->kstart, grid->kend);
+}
+
+void Diff_2::exec_interior()
+{
+    int ib, ie, jb, je, kb, ke;
+    grid->get_box(ib, ie, jb, je, kb, ke, 0);
+    exec_box(ib, ie, jb, je, kb, ke);
+}
+
+void Diff_2::exec_boundary()
+{
+    int ib, ie, jb, je, kb, ke;
+    for (int n=1; n<Grid::nboxes; ++n)
+    {
+        grid->get_box(ib, ie, jb, je, kb, ke, n);
+        exec_box(ib, ie, jb, je, kb, ke);
+    }
+}
+
+void Diff_2::exec_box(const int istart, const int iend, const int jstart, const int jend,
+                      const int kstart, const int kend)
+{
+    // The diffusion is already done if it is fused into the advection kernels.
+    if (model->advec->includes_diff())
+        return;
+
+    // The vertical velocity is not diffused at the bottom boundary.
+    const int kstarth = std::max(kstart, grid->kstart+1);
+
+    diff_w(fields->wt->data, fields->w->data, grid->dzi, grid->dzhi, fields->visc,
+           istart, iend, jstart, jend, kstarth, kend);
+
+    // Diffuse u, v and all scalars in one sweep.
+    std::vector<double*> atlist, alist;
+    std::vector<double> visclist;
+
+    atlist.push_back(fields->ut->data); alist.push_back(fields->u->data); visclist.push_back(fields->visc);
+    atlist.push_back(fields->vt->data); alist.push_back(fields->v->data); visclist.push_back(fields->visc);
 
     for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); it++)
-        diff_c(it->second->data, fields->sp[it->first]->data, grid->dzi, grid->dzhi, fields->sp[it->first]->visc);
+    {
+        atlist  .push_back(it->second->data);
+        alist   .push_back(fields->sp[it->first]->data);
+        visclist.push_back(fields->sp[it->first]->visc);
+    }
+
+    diff_c(atlist, alist, grid->dzi, grid->dzhi, visclist,
+           istart, iend, jstart, jend, kstart, kend);
 }
 #endif
 
-void Diff_2::diff_c(double* restrict at, double* restrict a, double* restrict dzi, double* restrict dzhi, double visc)
+void Diff_2::diff_c(const std::vector<double*>& atlist, const std::vector<double*>& alist,
+                    double* restrict dzi, double* restrict dzhi, const std::vector<double>& visclist,
+                    const int istart, const int iend, const int jstart, const int jend,
+                    const int kstart, const int kend)
 {
+    const int nsc = atlist.size();
+
     const int ii = 1;
     const int jj = grid->icells;
     const int kk = grid->ijcells;
@@ -82,23 +131,32 @@ void Diff_2::diff_c(double* restrict at, double* restrict a, double* restrict dz
     const double dxidxi = 1./(grid->dx * grid->dx);
     const double dyidyi = 1./(grid->dy * grid->dy);
 
-    for (int k=grid->kstart; k<grid->kend; k++)
-        for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
+#pragma omp parallel for
+    for (int k=kstart; k<kend; k++)
+        for (int j=jstart; j<jend; j++)
+            for (int n=0; n<nsc; ++n)
             {
-                const int ijk = i + j*jj + k*kk;
-                at[ijk] += visc * (
-                        + ( (a[ijk+ii] - a[ijk   ]) 
-                          - (a[ijk   ] - a[ijk-ii]) ) * dxidxi 
-                        + ( (a[ijk+jj] - a[ijk   ]) 
-                          - (a[ijk   ] - a[ijk-jj]) ) * dyidyi
-                        + ( (a[ijk+kk] - a[ijk   ]) * dzhi[k+1]
-                          - (a[ijk   ] - a[ijk-kk]) * dzhi[k]   ) * dzi[k] );
+                double* restrict at = atlist[n];
+                double* restrict a  = alist[n];
+                const double visc = visclist[n];
+#pragma ivdep
+                for (int i=istart; i<iend; i++)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    at[ijk] += visc * (
+                            + ( (a[ijk+ii] - a[ijk   ]) 
+                              - (a[ijk   ] - a[ijk-ii]) ) * dxidxi 
+                            + ( (a[ijk+jj] - a[ijk   ]) 
+                              - (a[ijk   ] - a[ijk-jj]) ) * dyidyi
+                            + ( (a[ijk+kk] - a[ijk   ]) * dzhi[k+1]
+                              - (a[ijk   ] - a[ijk-kk]) * dzhi[k]   ) * dzi[k] );
+                }
             }
 }
 
-void Diff_2::diff_w(double* restrict wt, double* restrict w, double* restrict dzi, double* restrict dzhi, double visc)
+void Diff_2::diff_w(double* restrict wt, double* restrict w, double* restrict dzi, double* restrict dzhi, double visc,
+                    const int istart, const int iend, const int jstart, const int jend,
+                    const int kstart, const int kend)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -107,10 +165,11 @@ void Diff_2::diff_w(double* restrict wt, double* restrict w, double* restrict dz
     const double dxidxi = 1./(grid->dx*grid->dx);
     const double dyidyi = 1./(grid->dy*grid->dy);
 
-    for (int k=grid->kstart+1; k<grid->kend; k++)
-        for (int j=grid->jstart; j<grid->jend; j++)
+#pragma omp parallel for
+    for (int k=kstart; k<kend; k++)
+        for (int j=jstart; j<jend; j++)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
+            for (int i=istart; i<iend; i++)
             {
                 const int ijk = i + j*jj + k*kk;
                 wt[ijk] += visc * (
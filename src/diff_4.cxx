@@ -67,31 +67,44 @@ double Diff_4::get_dn(double dt)
 #ifndef USECUDA
 void Diff_4::exec()
 {
+    // Diffuse u, v and all scalars in one sweep.
+    std::vector<double*> atlist, alist;
+    std::vector<double> visclist;
+
+    atlist.push_back(fields->ut->data); alist.push_back(fields->u->data); visclist.push_back(fields->visc);
+    if (grid->jtot != 1)
+    {
+        atlist.push_back(fields->vt->data); alist.push_back(fields->v->data); visclist.push_back(fields->visc);
+    }
+
+    for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); it++)
+    {
+        atlist  .push_back(it->second->data);
+        alist   .push_back(fields->sp[it->first]->data);
+        visclist.push_back(fields->sp[it->first]->visc);
+    }
+
     // In case of a two-dimensional run, strip v component out of all kernels and do 
     // not calculate v-diffusion tendency.
     if (grid->jtot == 1)
     {
-        diff_c<false>(fields->ut->data, fields->u->data, grid->dzi4, grid->dzhi4, fields->visc);
+        diff_c<false>(atlist, alist, grid->dzi4, grid->dzhi4, visclist);
         diff_w<false>(fields->wt->data, fields->w->data, grid->dzi4, grid->dzhi4, fields->visc);
-
-        for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); it++)
-            diff_c<false>(it->second->data, fields->sp[it->first]->data, grid->dzi4, grid->dzhi4, fields->sp[it->first]->visc);
     }
     else
     {
-        diff_c<true>(fields->ut->data, fields->u->data, grid->dzi4, grid->dzhi4, fields->visc);
-        diff_c<true>(fields->vt->data, fields->v->data, grid->dzi4, grid->dzhi4, fields->visc);
+        diff_c<true>(atlist, alist, grid->dzi4, grid->dzhi4, visclist);
         diff_w<true>(fields->wt->data, fields->w->data, grid->dzi4, grid->dzhi4, fields->visc);
-
-        for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); it++)
-            diff_c<true>(it->second->data, fields->sp[it->first]->data, grid->dzi4, grid->dzhi4, fields->sp[it->first]->visc);
     }
 }
 #endif
 
 template<bool dim3>
-void Diff_4::diff_c(double* restrict at, double* restrict a, double* restrict dzi4, double* restrict dzhi4, const double visc)
+void Diff_4::diff_c(const std::vector<double*>& atlist, const std::vector<double*>& alist,
+                    double* restrict dzi4, double* restrict dzhi4, const std::vector<double>& visclist)
 {
+    const int nsc = atlist.size();
+
     const int ii1 = 1;
     const int ii2 = 2;
     const int ii3 = 3;
@@ -109,51 +122,72 @@ void Diff_4::diff_c(double* restrict at, double* restrict a, double* restrict dz
     const double dyidyi = 1./(grid->dy * grid->dy);
 
     // bottom boundary
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-        for (int i=grid->istart; i<grid->iend; i++)
+        for (int n=0; n<nsc; ++n)
         {
-            const int ijk = i + j*jj1 + kstart*kk1;
-            at[ijk] += visc * (cdg3*a[ijk-ii3] + cdg2*a[ijk-ii2] + cdg1*a[ijk-ii1] + cdg0*a[ijk] + cdg1*a[ijk+ii1] + cdg2*a[ijk+ii2] + cdg3*a[ijk+ii3])*dxidxi;
-            if (dim3)
-                at[ijk] += visc * (cdg3*a[ijk-jj3] + cdg2*a[ijk-jj2] + cdg1*a[ijk-jj1] + cdg0*a[ijk] + cdg1*a[ijk+jj1] + cdg2*a[ijk+jj2] + cdg3*a[ijk+jj3])*dyidyi;
-            at[ijk] += visc * ( cg0*(bg0*a[ijk-kk2] + bg1*a[ijk-kk1] + bg2*a[ijk    ] + bg3*a[ijk+kk1]) * dzhi4[kstart-1]
-                              + cg1*(cg0*a[ijk-kk2] + cg1*a[ijk-kk1] + cg2*a[ijk    ] + cg3*a[ijk+kk1]) * dzhi4[kstart  ]
-                              + cg2*(cg0*a[ijk-kk1] + cg1*a[ijk    ] + cg2*a[ijk+kk1] + cg3*a[ijk+kk2]) * dzhi4[kstart+1]
-                              + cg3*(cg0*a[ijk    ] + cg1*a[ijk+kk1] + cg2*a[ijk+kk2] + cg3*a[ijk+kk3]) * dzhi4[kstart+2] )
-                            * dzi4[kstart];
-        }
-
-    for (int k=grid->kstart+1; k<grid->kend-1; k++)
-        for (int j=grid->jstart; j<grid->jend; j++)
+            double* restrict at = atlist[n];
+            double* restrict a  = alist[n];
+            const double visc = visclist[n];
 #pragma ivdep
             for (int i=grid->istart; i<grid->iend; i++)
             {
-                const int ijk = i + j*jj1 + k*kk1;
+                const int ijk = i + j*jj1 + kstart*kk1;
                 at[ijk] += visc * (cdg3*a[ijk-ii3] + cdg2*a[ijk-ii2] + cdg1*a[ijk-ii1] + cdg0*a[ijk] + cdg1*a[ijk+ii1] + cdg2*a[ijk+ii2] + cdg3*a[ijk+ii3])*dxidxi;
                 if (dim3)
                     at[ijk] += visc * (cdg3*a[ijk-jj3] + cdg2*a[ijk-jj2] + cdg1*a[ijk-jj1] + cdg0*a[ijk] + cdg1*a[ijk+jj1] + cdg2*a[ijk+jj2] + cdg3*a[ijk+jj3])*dyidyi;
-                at[ijk] += visc * ( cg0*(cg0*a[ijk-kk3] + cg1*a[ijk-kk2] + cg2*a[ijk-kk1] + cg3*a[ijk    ]) * dzhi4[k-1]
-                                  + cg1*(cg0*a[ijk-kk2] + cg1*a[ijk-kk1] + cg2*a[ijk    ] + cg3*a[ijk+kk1]) * dzhi4[k  ]
-                                  + cg2*(cg0*a[ijk-kk1] + cg1*a[ijk    ] + cg2*a[ijk+kk1] + cg3*a[ijk+kk2]) * dzhi4[k+1]
-                                  + cg3*(cg0*a[ijk    ] + cg1*a[ijk+kk1] + cg2*a[ijk+kk2] + cg3*a[ijk+kk3]) * dzhi4[k+2] )
-                                * dzi4[k];
+                at[ijk] += visc * ( cg0*(bg0*a[ijk-kk2] + bg1*a[ijk-kk1] + bg2*a[ijk    ] + bg3*a[ijk+kk1]) * dzhi4[kstart-1]
+                                  + cg1*(cg0*a[ijk-kk2] + cg1*a[ijk-kk1] + cg2*a[ijk    ] + cg3*a[ijk+kk1]) * dzhi4[kstart  ]
+                                  + cg2*(cg0*a[ijk-kk1] + cg1*a[ijk    ] + cg2*a[ijk+kk1] + cg3*a[ijk+kk2]) * dzhi4[kstart+1]
+                                  + cg3*(cg0*a[ijk    ] + cg1*a[ijk+kk1] + cg2*a[ijk+kk2] + cg3*a[ijk+kk3]) * dzhi4[kstart+2] )
+                                * dzi4[kstart];
+            }
+        }
+
+#pragma omp parallel for
+    for (int k=grid->kstart+1; k<grid->kend-1; k++)
+        for (int j=grid->jstart; j<grid->jend; j++)
+            for (int n=0; n<nsc; ++n)
+            {
+                double* restrict at = atlist[n];
+                double* restrict a  = alist[n];
+                const double visc = visclist[n];
+#pragma ivdep
+                for (int i=grid->istart; i<grid->iend; i++)
+                {
+                    const int ijk = i + j*jj1 + k*kk1;
+                    at[ijk] += visc * (cdg3*a[ijk-ii3] + cdg2*a[ijk-ii2] + cdg1*a[ijk-ii1] + cdg0*a[ijk] + cdg1*a[ijk+ii1] + cdg2*a[ijk+ii2] + cdg3*a[ijk+ii3])*dxidxi;
+                    if (dim3)
+                        at[ijk] += visc * (cdg3*a[ijk-jj3] + cdg2*a[ijk-jj2] + cdg1*a[ijk-jj1] + cdg0*a[ijk] + cdg1*a[ijk+jj1] + cdg2*a[ijk+jj2] + cdg3*a[ijk+jj3])*dyidyi;
+                    at[ijk] += visc * ( cg0*(cg0*a[ijk-kk3] + cg1*a[ijk-kk2] + cg2*a[ijk-kk1] + cg3*a[ijk    ]) * dzhi4[k-1]
+                                      + cg1*(cg0*a[ijk-kk2] + cg1*a[ijk-kk1] + cg2*a[ijk    ] + cg3*a[ijk+kk1]) * dzhi4[k  ]
+                                      + cg2*(cg0*a[ijk-kk1] + cg1*a[ijk    ] + cg2*a[ijk+kk1] + cg3*a[ijk+kk2]) * dzhi4[k+1]
+                                      + cg3*(cg0*a[ijk    ] + cg1*a[ijk+kk1] + cg2*a[ijk+kk2] + cg3*a[ijk+kk3]) * dzhi4[k+2] )
+                                    * dzi4[k];
+                }
             }
 
     // top boundary
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-        for (int i=grid->istart; i<grid->iend; i++)
+        for (int n=0; n<nsc; ++n)
         {
-            const int ijk = i + j*jj1 + (kend-1)*kk1;
-            at[ijk] += visc * (cdg3*a[ijk-ii3] + cdg2*a[ijk-ii2] + cdg1*a[ijk-ii1] + cdg0*a[ijk] + cdg1*a[ijk+ii1] + cdg2*a[ijk+ii2] + cdg3*a[ijk+ii3])*dxidxi;
-            if (dim3)
-                at[ijk] += visc * (cdg3*a[ijk-jj3] + cdg2*a[ijk-jj2] + cdg1*a[ijk-jj1] + cdg0*a[ijk] + cdg1*a[ijk+jj1] + cdg2*a[ijk+jj2] + cdg3*a[ijk+jj3])*dyidyi;
-            at[ijk] += visc * ( cg0*(cg0*a[ijk-kk3] + cg1*a[ijk-kk2] + cg2*a[ijk-kk1] + cg3*a[ijk    ]) * dzhi4[kend-2]
-                              + cg1*(cg0*a[ijk-kk2] + cg1*a[ijk-kk1] + cg2*a[ijk    ] + cg3*a[ijk+kk1]) * dzhi4[kend-1]
-                              + cg2*(cg0*a[ijk-kk1] + cg1*a[ijk    ] + cg2*a[ijk+kk1] + cg3*a[ijk+kk2]) * dzhi4[kend  ]
-                              + cg3*(tg0*a[ijk-kk1] + tg1*a[ijk    ] + tg2*a[ijk+kk1] + tg3*a[ijk+kk2]) * dzhi4[kend+1] )
-                            * dzi4[kend-1];
+            double* restrict at = atlist[n];
+            double* restrict a  = alist[n];
+            const double visc = visclist[n];
+#pragma ivdep
+            for (int i=grid->istart; i<grid->iend; i++)
+            {
+                const int ijk = i + j*jj1 + (kend-1)*kk1;
+                at[ijk] += visc * (cdg3*a[ijk-ii3] + cdg2*a[ijk-ii2] + cdg1*a[ijk-ii1] + cdg0*a[ijk] + cdg1*a[ijk+ii1] + cdg2*a[ijk+ii2] + cdg3*a[ijk+ii3])*dxidxi;
+                if (dim3)
+                    at[ijk] += visc * (cdg3*a[ijk-jj3] + cdg2*a[ijk-jj2] + cdg1*a[ijk-jj1] + cdg0*a[ijk] + cdg1*a[ijk+jj1] + cdg2*a[ijk+jj2] + cdg3*a[ijk+jj3])*dyidyi;
+                at[ijk] += visc * ( cg0*(cg0*a[ijk-kk3] + cg1*a[ijk-kk2] + cg2*a[ijk-kk1] + cg3*a[ijk    ]) * dzhi4[kend-2]
+                                  + cg1*(cg0*a[ijk-kk2] + cg1*a[ijk-kk1] + cg2*a[ijk    ] + cg3*a[ijk+kk1]) * dzhi4[kend-1]
+                                  + cg2*(cg0*a[ijk-kk1] + cg1*a[ijk    ] + cg2*a[ijk+kk1] + cg3*a[ijk+kk2]) * dzhi4[kend  ]
+                                  + cg3*(tg0*a[ijk-kk1] + tg1*a[ijk    ] + tg2*a[ijk+kk1] + tg3*a[ijk+kk2]) * dzhi4[kend+1] )
+                                * dzi4[kend-1];
+            }
         }
 }
 
@@ -177,6 +211,7 @@ void Diff_4::diff_w(double* restrict at, double* restrict a, double* restrict dz
     const double dyidyi = 1./(grid->dy * grid->dy);
 
     // bottom boundary
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; i++)
@@ -192,6 +227,7 @@ void Diff_4::diff_w(double* restrict at, double* restrict a, double* restrict dz
                             * dzhi4[kstart+1];
         }
 
+#pragma omp parallel for
     for (int k=grid->kstart+2; k<grid->kend-1; k++)
         for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
@@ -209,6 +245,7 @@ void Diff_4::diff_w(double* restrict at, double* restrict a, double* restrict dz
             }
 
     // top boundary
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; i++)
@@ -146,6 +146,16 @@ void Diff_smag_2::exec_viscosity()
 #ifndef USECUDA
 void Diff_smag_2::exec()
 {
+    // Collect the scalars, such that the eddy viscosity is loaded once for all of them.
+    std::vector<double*> stlist, slist, fluxbotlist, fluxtoplist;
+    for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); ++it)
+    {
+        stlist     .push_back(it->second->data);
+        slist      .push_back(fields->sp[it->first]->data);
+        fluxbotlist.push_back(fields->sp[it->first]->datafluxbot);
+        fluxtoplist.push_back(fields->sp[it->first]->datafluxtop);
+    }
+
     if(model->boundary->get_switch() == "surface")
     {
         diff_u<false>(fields->ut->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
@@ -155,9 +165,8 @@ void Diff_smag_2::exec()
         diff_w(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
                fields->rhoref, fields->rhorefh);
 
-        for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); ++it)
-            diff_c(it->second->data, fields->sp[it->first]->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
-                   fields->sp[it->first]->datafluxbot, fields->sp[it->first]->datafluxtop, fields->rhoref, fields->rhorefh, this->tPr);
+        diff_c(stlist, slist, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
+               fluxbotlist, fluxtoplist, fields->rhoref, fields->rhorefh, this->tPr);
     }
     else
     {
@@ -168,10 +177,8 @@ void Diff_smag_2::exec()
         diff_w(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
                fields->rhoref, fields->rhorefh);
 
-        for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); ++it)
-            diff_c(it->second->data, fields->sp[it->first]->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
-                   fields->sp[it->first]->datafluxbot, fields->sp[it->first]->datafluxtop, fields->rhoref, fields->rhorefh, this->tPr);
-
+        diff_c(stlist, slist, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
+               fluxbotlist, fluxtoplist, fields->rhoref, fields->rhorefh, this->tPr);
     }
 }
 #endif
@@ -196,6 +203,7 @@ void Diff_smag_2::calc_strain2(double* restrict strain2,
     // If the wall isn't resolved, calculate du/dz and dv/dz at lowest grid height using MO
     if (!resolved_wall)
     {
+        #pragma omp parallel for
         for (int j=grid->jstart; j<grid->jend; ++j)
             #pragma ivdep
             for (int i=grid->istart; i<grid->iend; ++i)
@@ -242,6 +250,7 @@ void Diff_smag_2::calc_strain2(double* restrict strain2,
             }
     }
 
+    #pragma omp parallel for
     for (int k=grid->kstart+k_offset; k<grid->kend; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
             #pragma ivdep
@@ -311,6 +320,7 @@ void Diff_smag_2::calc_evisc(double* restrict evisc,
     double tPr = this->tPr;
     double cs  = this->cs;
 
+    #pragma omp parallel for private(RitPrratio)
     for (int j=grid->jstart; j<grid->jend; ++j)
         #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -324,6 +334,7 @@ void Diff_smag_2::calc_evisc(double* restrict evisc,
             evisc[ijk] = fac * std::sqrt(evisc[ijk]) * std::sqrt(1.-RitPrratio);
         }
 
+    #pragma omp parallel for private(mlen, mlen0, fac, RitPrratio)
     for (int k=grid->kstart+1; k<grid->kend; ++k)
     {
         // calculate smagorinsky constant times filter width squared, use wall damping according to Mason
@@ -365,6 +376,7 @@ void Diff_smag_2::calc_evisc_neutral(double* restrict evisc,
 
     if (resolved_wall)
     {
+        #pragma omp parallel for
         for (int k=grid->kstart; k<grid->kend; ++k)
         {
             const double mlen = pow(cs*std::pow(dx*dy*dz[k], 1./3.), 2);
@@ -383,6 +395,7 @@ void Diff_smag_2::calc_evisc_neutral(double* restrict evisc,
         // is zero, so set ghost cell such that the viscosity interpolated to the surface equals the molecular viscosity.
         const int kb = grid->kstart;
         const int kt = grid->kend-1;
+        #pragma omp parallel for
         for (int j=0; j<grid->jcells; ++j)
             #pragma ivdep
             for (int i=0; i<grid->icells; ++i)
@@ -395,6 +408,7 @@ void Diff_smag_2::calc_evisc_neutral(double* restrict evisc,
     }
     else
     {
+        #pragma omp parallel for
         for (int k=grid->kstart; k<grid->kend; ++k)
         {
             // Calculate smagorinsky constant times filter width squared, use wall damping according to Mason's paper.
@@ -438,6 +452,7 @@ void Diff_smag_2::diff_u(double* restrict ut, double* restrict u, double* restri
     if(!resolved_wall)
     {
         // bottom boundary
+        #pragma omp parallel for private(eviscn, eviscs, eviscb, evisct)
         for (int j=grid->jstart; j<grid->jend; ++j)
             #pragma ivdep
             for (int i=grid->istart; i<grid->iend; ++i)
@@ -462,6 +477,7 @@ void Diff_smag_2::diff_u(double* restrict ut, double* restrict u, double* restri
             }
 
         // top boundary
+        #pragma omp parallel for private(eviscn, eviscs, eviscb, evisct)
         for (int j=grid->jstart; j<grid->jend; ++j)
             #pragma ivdep
             for (int i=grid->istart; i<grid->iend; ++i)
@@ -485,6 +501,7 @@ void Diff_smag_2::diff_u(double* restrict ut, double* restrict u, double* restri
             }
     }
 
+    #pragma omp parallel for private(eviscn, eviscs, eviscb, evisct)
     for (int k=grid->kstart+k_offset; k<grid->kend-k_offset; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
             #pragma ivdep
@@ -530,6 +547,7 @@ void Diff_smag_2::diff_v(double* restrict vt, double* restrict u, double* restri
     if(!resolved_wall)
     {
         // bottom boundary
+        #pragma omp parallel for private(evisce, eviscw, eviscb, evisct)
         for (int j=grid->jstart; j<grid->jend; ++j)
             #pragma ivdep
             for (int i=grid->istart; i<grid->iend; ++i)
@@ -553,6 +571,7 @@ void Diff_smag_2::diff_v(double* restrict vt, double* restrict u, double* restri
             }
 
         // top boundary
+        #pragma omp parallel for private(evisce, eviscw, eviscb, evisct)
         for (int j=grid->jstart; j<grid->jend; ++j)
             #pragma ivdep
             for (int i=grid->istart; i<grid->iend; ++i)
@@ -576,6 +595,7 @@ void Diff_smag_2::diff_v(double* restrict vt, double* restrict u, double* restri
             }
     }
 
+    #pragma omp parallel for private(evisce, eviscw, eviscb, evisct)
     for (int k=grid->kstart+k_offset; k<grid->kend-k_offset; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
             #pragma ivdep
@@ -612,6 +632,7 @@ void Diff_smag_2::diff_w(double* restrict wt, double* restrict u, double* restri
 
     double evisce, eviscw, eviscn, eviscs;
 
+    #pragma omp parallel for private(evisce, eviscw, eviscn, eviscs)
     for (int k=grid->kstart+1; k<grid->kend; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
             #pragma ivdep
@@ -635,11 +656,13 @@ void Diff_smag_2::diff_w(double* restrict wt, double* restrict u, double* restri
             }
 }
 
-void Diff_smag_2::diff_c(double* restrict at, double* restrict a,
+void Diff_smag_2::diff_c(const std::vector<double*>& atlist, const std::vector<double*>& alist,
                          double* restrict dzi, double* restrict dzhi, double* restrict evisc,
-                         double* restrict fluxbot, double* restrict fluxtop, 
+                         const std::vector<double*>& fluxbotlist, const std::vector<double*>& fluxtoplist,
                          double* restrict rhoref, double* restrict rhorefh, double tPr)
 {
+    const int nsc = atlist.size();
+
     const int ii = 1;
     const int jj = grid->icells;
     const int kk = grid->ijcells;
@@ -652,34 +675,18 @@ void Diff_smag_2::diff_c(double* restrict at, double* restrict a,
     double evisce,eviscw,eviscn,eviscs,evisct,eviscb;
 
     // bottom boundary
+    #pragma omp parallel for private(evisce, eviscw, eviscn, eviscs, evisct, eviscb)
     for (int j=grid->jstart; j<grid->jend; ++j)
-        #pragma ivdep
-        for (int i=grid->istart; i<grid->iend; ++i)
+        for (int n=0; n<nsc; ++n)
         {
-            const int ij  = i + j*jj;
-            const int ijk = i + j*jj + kstart*kk;
-            evisce = 0.5*(evisc[ijk   ]+evisc[ijk+ii])/tPr;
-            eviscw = 0.5*(evisc[ijk-ii]+evisc[ijk   ])/tPr;
-            eviscn = 0.5*(evisc[ijk   ]+evisc[ijk+jj])/tPr;
-            eviscs = 0.5*(evisc[ijk-jj]+evisc[ijk   ])/tPr;
-            evisct = 0.5*(evisc[ijk   ]+evisc[ijk+kk])/tPr;
-            eviscb = 0.5*(evisc[ijk-kk]+evisc[ijk   ])/tPr;
-
-            at[ijk] +=
-                     + ( evisce*(a[ijk+ii]-a[ijk   ]) 
-                       - eviscw*(a[ijk   ]-a[ijk-ii]) ) * dxidxi 
-                     + ( eviscn*(a[ijk+jj]-a[ijk   ]) 
-                       - eviscs*(a[ijk   ]-a[ijk-jj]) ) * dyidyi
-                     + ( rhorefh[kstart+1] * evisct*(a[ijk+kk]-a[ijk   ])*dzhi[kstart+1]
-                       + rhorefh[kstart  ] * fluxbot[ij] ) / rhoref[kstart] * dzi[kstart];
-        }
-
-    for (int k=grid->kstart+1; k<grid->kend-1; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+            double* restrict at      = atlist[n];
+            double* restrict a       = alist[n];
+            double* restrict fluxbot = fluxbotlist[n];
             #pragma ivdep
             for (int i=grid->istart; i<grid->iend; ++i)
             {
-                const int ijk = i + j*jj + k*kk;
+                const int ij  = i + j*jj;
+                const int ijk = i + j*jj + kstart*kk;
                 evisce = 0.5*(evisc[ijk   ]+evisc[ijk+ii])/tPr;
                 eviscw = 0.5*(evisc[ijk-ii]+evisc[ijk   ])/tPr;
                 eviscn = 0.5*(evisc[ijk   ]+evisc[ijk+jj])/tPr;
@@ -692,31 +699,67 @@ void Diff_smag_2::diff_c(double* restrict at, double* restrict a,
                            - eviscw*(a[ijk   ]-a[ijk-ii]) ) * dxidxi 
                          + ( eviscn*(a[ijk+jj]-a[ijk   ]) 
                            - eviscs*(a[ijk   ]-a[ijk-jj]) ) * dyidyi
-                         + ( rhorefh[k+1] * evisct*(a[ijk+kk]-a[ijk   ])*dzhi[k+1]
-                           - rhorefh[k  ] * eviscb*(a[ijk   ]-a[ijk-kk])*dzhi[k]  ) / rhoref[k] * dzi[k];
+                         + ( rhorefh[kstart+1] * evisct*(a[ijk+kk]-a[ijk   ])*dzhi[kstart+1]
+                           + rhorefh[kstart  ] * fluxbot[ij] ) / rhoref[kstart] * dzi[kstart];
+            }
+        }
+
+    #pragma omp parallel for private(evisce, eviscw, eviscn, eviscs, evisct, eviscb)
+    for (int k=grid->kstart+1; k<grid->kend-1; ++k)
+        for (int j=grid->jstart; j<grid->jend; ++j)
+            for (int n=0; n<nsc; ++n)
+            {
+                double* restrict at      = atlist[n];
+                double* restrict a       = alist[n];
+                #pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    evisce = 0.5*(evisc[ijk   ]+evisc[ijk+ii])/tPr;
+                    eviscw = 0.5*(evisc[ijk-ii]+evisc[ijk   ])/tPr;
+                    eviscn = 0.5*(evisc[ijk   ]+evisc[ijk+jj])/tPr;
+                    eviscs = 0.5*(evisc[ijk-jj]+evisc[ijk   ])/tPr;
+                    evisct = 0.5*(evisc[ijk   ]+evisc[ijk+kk])/tPr;
+                    eviscb = 0.5*(evisc[ijk-kk]+evisc[ijk   ])/tPr;
+
+                    at[ijk] +=
+                             + ( evisce*(a[ijk+ii]-a[ijk   ]) 
+                               - eviscw*(a[ijk   ]-a[ijk-ii]) ) * dxidxi 
+                             + ( eviscn*(a[ijk+jj]-a[ijk   ]) 
+                               - eviscs*(a[ijk   ]-a[ijk-jj]) ) * dyidyi
+                             + ( rhorefh[k+1] * evisct*(a[ijk+kk]-a[ijk   ])*dzhi[k+1]
+                               - rhorefh[k  ] * eviscb*(a[ijk   ]-a[ijk-kk])*dzhi[k]  ) / rhoref[k] * dzi[k];
+                }
             }
 
     // top boundary
+    #pragma omp parallel for private(evisce, eviscw, eviscn, eviscs, evisct, eviscb)
     for (int j=grid->jstart; j<grid->jend; ++j)
-        #pragma ivdep
-        for (int i=grid->istart; i<grid->iend; ++i)
+        for (int n=0; n<nsc; ++n)
         {
-            const int ij  = i + j*jj;
-            const int ijk = i + j*jj + (kend-1)*kk;
-            evisce = 0.5*(evisc[ijk   ]+evisc[ijk+ii])/tPr;
-            eviscw = 0.5*(evisc[ijk-ii]+evisc[ijk   ])/tPr;
-            eviscn = 0.5*(evisc[ijk   ]+evisc[ijk+jj])/tPr;
-            eviscs = 0.5*(evisc[ijk-jj]+evisc[ijk   ])/tPr;
-            evisct = 0.5*(evisc[ijk   ]+evisc[ijk+kk])/tPr;
-            eviscb = 0.5*(evisc[ijk-kk]+evisc[ijk   ])/tPr;
-
-            at[ijk] +=
-                     + ( evisce*(a[ijk+ii]-a[ijk   ]) 
-                       - eviscw*(a[ijk   ]-a[ijk-ii]) ) * dxidxi 
-                     + ( eviscn*(a[ijk+jj]-a[ijk   ]) 
-                       - eviscs*(a[ijk   ]-a[ijk-jj]) ) * dyidyi
-                     + (-rhorefh[kend  ] * fluxtop[ij]
-                       - rhorefh[kend-1] * eviscb*(a[ijk   ]-a[ijk-kk])*dzhi[kend-1] ) / rhoref[kend-1] * dzi[kend-1];
+            double* restrict at      = atlist[n];
+            double* restrict a       = alist[n];
+            double* restrict fluxtop = fluxtoplist[n];
+            #pragma ivdep
+            for (int i=grid->istart; i<grid->iend; ++i)
+            {
+                const int ij  = i + j*jj;
+                const int ijk = i + j*jj + (kend-1)*kk;
+                evisce = 0.5*(evisc[ijk   ]+evisc[ijk+ii])/tPr;
+                eviscw = 0.5*(evisc[ijk-ii]+evisc[ijk   ])/tPr;
+                eviscn = 0.5*(evisc[ijk   ]+evisc[ijk+jj])/tPr;
+                eviscs = 0.5*(evisc[ijk-jj]+evisc[ijk   ])/tPr;
+                evisct = 0.5*(evisc[ijk   ]+evisc[ijk+kk])/tPr;
+                eviscb = 0.5*(evisc[ijk-kk]+evisc[ijk   ])/tPr;
+
+                at[ijk] +=
+                         + ( evisce*(a[ijk+ii]-a[ijk   ]) 
+                           - eviscw*(a[ijk   ]-a[ijk-ii]) ) * dxidxi 
+                         + ( eviscn*(a[ijk+jj]-a[ijk   ]) 
+                           - eviscs*(a[ijk   ]-a[ijk-jj]) ) * dyidyi
+                         + (-rhorefh[kend  ] * fluxtop[ij]
+                           - rhorefh[kend-1] * eviscb*(a[ijk   ]-a[ijk-kk])*dzhi[kend-1] ) / rhoref[kend-1] * dzi[kend-1];
+            }
         }
 }
 
@@ -21,6 +21,8 @@
  */
 
 #include <cstdio>
+#include <cmath>
+#include <algorithm>
 #include "master.h"
 #include "grid.h"
 #include "fields.h"
@@ -45,10 +47,38 @@ Dump::Dump(Model *modelin, Input *inputin)
     {  
         nerror += inputin->get_item(&sampletime, "dump", "sampletime", "");
         nerror += inputin->get_list(&dumplist ,  "dump", "dumplist" ,  "");
+        nerror += inputin->get_item(&dumpformat, "dump", "dumpformat", "", "double");
+        nerror += inputin->get_item(&swcompress, "dump", "swcompress", "", "0");
+
+        // region of interest, by default the full domain
+        nerror += inputin->get_item(&xmin, "dump", "xmin", "", 0.);
+        nerror += inputin->get_item(&xmax, "dump", "xmax", "", grid->xsize);
+        nerror += inputin->get_item(&ymin, "dump", "ymin", "", 0.);
+        nerror += inputin->get_item(&ymax, "dump", "ymax", "", grid->ysize);
+        nerror += inputin->get_item(&zmin, "dump", "zmin", "", 0.);
+        nerror += inputin->get_item(&zmax, "dump", "zmax", "", grid->zsize);
+
+        nerror += inputin->get_item(&coarse[0], "dump", "coarsex", "", 1);
+        nerror += inputin->get_item(&coarse[1], "dump", "coarsey", "", 1);
+        nerror += inputin->get_item(&coarse[2], "dump", "coarsez", "", 1);
     }  
 
     if (nerror)
         throw 1;
+
+    if (swdump == "1")
+    {
+        if (dumpformat != "double" && dumpformat != "float")
+        {
+            master->print_error("\"%s\" is an illegal value for dumpformat\n", dumpformat.c_str());
+            throw 1;
+        }
+        if (swcompress != "0" && swcompress != "1")
+        {
+            master->print_error("\"%s\" is an illegal value for swcompress\n", swcompress.c_str());
+            throw 1;
+        }
+    }
 }
 
 Dump::~Dump()
@@ -65,6 +95,9 @@ void Dump::init(double ifactor)
 
 void Dump::create()
 {  
+    if (swdump == "1")
+        init_region();
+
     /* All classes (fields, thermo) have removed their dump-variables from
        dumplist by now. If it isnt empty, print warnings for invalid variables */
     if (dumplist.size() > 0)
@@ -103,15 +136,139 @@ bool Dump::do_dump()
         return false;
 }
 
+/**
+ * This function converts the bounds of the region of interest into indices. The region is extended such that
+ * it covers all cells that are partly inside the bounds and that its start and size are multiples of the
+ * coarsening factors. As the blocks may not cross the boundaries of the subdomains, the number of grid points
+ * per process has to be a multiple of the coarsening factors as well. In the vertical, the number of grid points
+ * has to be a multiple of coarsez, such that the extended region never exceeds the top of the domain.
+ */
+void Dump::init_region()
+{
+    const int itot = grid->itot;
+    const int jtot = grid->jtot;
+    const int ktot = grid->ktot;
+
+    if (coarse[0] < 1 || coarse[1] < 1 || coarse[2] < 1)
+    {
+        master->print_error("the coarsening factors of the dumps have to be positive\n");
+        throw 1;
+    }
+    if (grid->imax % coarse[0] != 0 || grid->jmax % coarse[1] != 0)
+    {
+        master->print_error("the number of grid points per process has to be a multiple of coarsex and coarsey\n");
+        throw 1;
+    }
+    if (ktot % coarse[2] != 0)
+    {
+        master->print_error("ktot has to be a multiple of coarsez\n");
+        throw 1;
+    }
+
+    // find the cells in the horizontal directions
+    region[0] = std::max((int)std::floor(xmin/grid->dx), 0);
+    region[1] = std::min((int)std::ceil (xmax/grid->dx), itot);
+    region[2] = std::max((int)std::floor(ymin/grid->dy), 0);
+    region[3] = std::min((int)std::ceil (ymax/grid->dy), jtot);
+
+    // find the cells in the vertical direction using the half level heights
+    region[4] = 0;
+    while (region[4] < ktot-1 && grid->zh[region[4]+1+grid->kstart] <= zmin)
+        ++region[4];
+    region[5] = ktot;
+    while (region[5] > region[4]+1 && grid->zh[region[5]-1+grid->kstart] >= zmax)
+        --region[5];
+
+    // extend the region to complete blocks
+    for (int n=0; n<3; ++n)
+    {
+        region[2*n  ] = (region[2*n]/coarse[n]) * coarse[n];
+        region[2*n+1] = ((region[2*n+1]+coarse[n]-1)/coarse[n]) * coarse[n];
+    }
+
+    if (region[1] <= region[0] || region[3] <= region[2])
+    {
+        master->print_error("the region of the dumps is empty or does not fit the coarsening factors\n");
+        throw 1;
+    }
+
+    subdump = !(region[0] == 0 && region[1] == itot &&
+                region[2] == 0 && region[3] == jtot &&
+                region[4] == 0 && region[5] == ktot &&
+                coarse[0] == 1 && coarse[1] == 1 && coarse[2] == 1);
+
+    if (subdump)
+    {
+        if (dumpformat != "double" || swcompress != "0")
+        {
+            master->print_error("dumps of a region or coarsened dumps only support dumpformat=double and swcompress=0\n");
+            throw 1;
+        }
+
+        master->print_message("Dumps cover i = [%d, %d), j = [%d, %d), k = [%d, %d) with %d x %d x %d values\n",
+                              region[0], region[1], region[2], region[3], region[4], region[5],
+                              (region[1]-region[0])/coarse[0], (region[3]-region[2])/coarse[1], (region[5]-region[4])/coarse[2]);
+    }
+}
+
+/**
+ * This function calculates the offset and scale that map a field onto the range [-1, 1],
+ * which retains the relative precision of the fluctuations if the field is stored in single precision.
+ */
+void Dump::calc_packing(double* restrict data, double* restrict offset, double* restrict scale)
+{
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+
+    double sum = 0.;
+    for (int k=grid->kstart; k<grid->kend; ++k)
+        for (int j=grid->jstart; j<grid->jend; ++j)
+            for (int i=grid->istart; i<grid->iend; ++i)
+                sum += data[i + j*jj + k*kk];
+
+    grid->get_sum(&sum);
+    *offset = sum / ((double)grid->itot*grid->jtot*grid->ktot);
+
+    double maxdev = 0.;
+    for (int k=grid->kstart; k<grid->kend; ++k)
+        for (int j=grid->jstart; j<grid->jend; ++j)
+            for (int i=grid->istart; i<grid->iend; ++i)
+                maxdev = std::max(maxdev, std::abs(data[i + j*jj + k*kk] - *offset));
+
+    grid->get_max(&maxdev);
+    *scale = (maxdev > 0.) ? 1./maxdev : 1.;
+}
+
 void Dump::save_dump(double * restrict data, double * restrict tmp, std::string varname)
 {
     const double NoOffset = 0.;
     char filename[256];
 
+    // the vertical velocity is located at the half levels
+    const int loc[3] = {0, 0, varname == "w"};
+
     std::sprintf(filename, "%s.%07d", varname.c_str(), model->timeloop->get_iotime());
     master->print_message("Saving \"%s\" ... ", filename);
 
-    if (grid->save_field3d(data, tmp, fields->atmp["tmp2"]->data, filename, NoOffset))
+    int nerror = 0;
+    if (subdump)
+        nerror = grid->save_field3d_sub(data, tmp, filename, NoOffset, region, coarse, loc);
+    else if (dumpformat == "double" && swcompress == "0")
+        nerror = grid->save_field3d(data, tmp, fields->atmp["tmp2"]->data, filename, NoOffset, false);
+    else
+    {
+        const bool single = (dumpformat == "float");
+
+        double offset = 0.;
+        double scale  = 1.;
+        if (single)
+            calc_packing(data, &offset, &scale);
+
+        nerror = grid->save_field3d_packed(data, tmp, fields->atmp["tmp2"]->data, filename,
+                                           offset, scale, single, swcompress == "1");
+    }
+
+    if (nerror)
     {
         master->print_message("FAILED\n");
         throw 1;
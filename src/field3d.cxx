@@ -96,9 +96,12 @@ int Field3d::init()
         throw;
     }
 
-    // set all values to zero
-    for (int n=0; n<grid->ncells; ++n)
-        data[n] = 0.;
+    // set all values to zero, touch the pages with the same k-partitioning
+    // as the threaded kernels to have them placed in the right memory domain
+#pragma omp parallel for
+    for (int k=0; k<grid->kcells; ++k)
+        for (int n=0; n<grid->ijcells; ++n)
+            data[n + k*grid->ijcells] = 0.;
 
     for (int n=0; n<grid->kcells; ++n)
         datamean[n] = 0.;
@@ -33,6 +33,9 @@
 #include "stats.h"
 #include "cross.h"
 #include "dump.h"
+#include "column.h"
+#include "average.h"
+#include "thermo.h"
 #include "diff_smag2.h"
 
 Fields::Fields(Model *modelin, Input *inputin)
@@ -42,6 +45,8 @@ Fields::Fields(Model *modelin, Input *inputin)
     master = model->master;
 
     calc_mean_profs = false;
+    savepending     = false;
+    prefetchtime    = -1;
 
     // Initialize the pointers.
     rhoref  = 0;
@@ -59,6 +64,10 @@ Fields::Fields(Model *modelin, Input *inputin)
     // obligatory parameters
     nerror += inputin->get_item(&visc, "fields", "visc", "");
 
+    // optional parameters
+    nerror += inputin->get_item(&swasyncsave, "fields", "swasyncsave", "", "0");
+    nerror += inputin->get_item(&swprefetch , "fields", "swprefetch" , "", "0");
+
     // read the name of the passive scalars
     std::vector<std::string> slist;
     nerror += inputin->get_list(&slist, "fields", "slist", "");
@@ -73,6 +82,18 @@ Fields::Fields(Model *modelin, Input *inputin)
     if (nerror)
         throw 1;
 
+    if (!(swasyncsave == "0" || swasyncsave == "1"))
+    {
+        master->print_error("\"%s\" is an illegal value for swasyncsave\n", swasyncsave.c_str());
+        throw 1;
+    }
+
+    if (!(swprefetch == "0" || swprefetch == "1"))
+    {
+        master->print_error("\"%s\" is an illegal value for swprefetch\n", swprefetch.c_str());
+        throw 1;
+    }
+
     // initialize the basic set of fields
     init_momentum_field(u, ut, "u", "U velocity", "m s-1");
     init_momentum_field(v, vt, "v", "V velocity", "m s-1");
@@ -130,6 +151,9 @@ Fields::~Fields()
     delete[] umodel;
     delete[] vmodel;
 
+    for (std::vector<double*>::iterator it=savebufs.begin(); it!=savebufs.end(); ++it)
+        delete[] *it;
+
 #ifdef USECUDA
     clear_device();
 #endif
@@ -398,137 +422,135 @@ void Fields::exec_stats(Mask *m)
 
     const double NoOffset = 0.;
 
+    const bool smag2 = (model->diff->get_switch() == "smag2");
+    Diff_smag_2 *diffptr = static_cast<Diff_smag_2 *>(model->diff);
+
     // save the area coverage of the mask
     stats->calc_area(m->profs["area" ].data, sloc, stats->nmask );
     stats->calc_area(m->profs["areah"].data, wloc, stats->nmaskh);
 
-    // start with the stats on the w location, to make the wmean known for the flux calculations
+    // The statistics are computed in two passes, of which the sums of all profiles are reduced
+    // at once. The first pass calculates the means, which are needed for the moments and fluxes.
+    stats->begin_deferred_sums();
+
     stats->calc_mean(m->profs["w"].data, w->data, NoOffset, wloc, atmp["tmp4"]->data, stats->nmaskh);
-    for (int n=2; n<5; ++n)
-    {
-        std::stringstream ss;
-        ss << n;
-        std::string sn = ss.str();
-        stats->calc_moment(w->data, m->profs["w"].data, m->profs["w"+sn].data, n, wloc,
-                          atmp["tmp4"]->data, stats->nmaskh);
-    }
 
-    // calculate the stats on the u location
-    // interpolate the mask horizontally onto the u coordinate
+    // interpolate the mask horizontally onto the u and v coordinate
     grid->interpolate_2nd(atmp["tmp1"]->data, atmp["tmp3"]->data, sloc, uloc);
+    grid->interpolate_2nd(atmp["tmp2"]->data, atmp["tmp3"]->data, sloc, vloc);
     stats->calc_mean(m->profs["u"].data, u->data, grid->utrans, uloc, atmp["tmp1"]->data, stats->nmask);
     stats->calc_mean(umodel            , u->data, NoOffset   , uloc, atmp["tmp1"]->data, stats->nmask);
-    for (int n=2; n<5; ++n)
-    {
-        std::stringstream ss;
-        ss << n;
-        std::string sn = ss.str();
-        stats->calc_moment(u->data, umodel, m->profs["u"+sn].data, n, uloc,
-                          atmp["tmp1"]->data, stats->nmask);
-    }
+    stats->calc_mean(m->profs["v"].data, v->data, grid->vtrans, vloc, atmp["tmp2"]->data, stats->nmask);
+    stats->calc_mean(vmodel            , v->data, NoOffset   , vloc, atmp["tmp2"]->data, stats->nmask);
 
-    // interpolate the mask on half level horizontally onto the u coordinate
-    grid->interpolate_2nd(atmp["tmp1"]->data, atmp["tmp4"]->data, wloc, uwloc);
+    // the scalars that are not loaded in post processing mode have no statistics
+    for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
+        if (is_loaded(it->first))
+            stats->calc_mean(m->profs[it->first].data, it->second->data, NoOffset, sloc, atmp["tmp3"]->data, stats->nmask);
+
+    stats->calc_mean(m->profs["p"].data, sd["p"]->data, NoOffset, sloc, atmp["tmp3"]->data, stats->nmask);
+
+    if (smag2)
+        stats->calc_mean(m->profs["evisc"].data, sd["evisc"]->data, NoOffset, sloc, atmp["tmp3"]->data, stats->nmask);
+
+    stats->end_deferred_sums();
+
+    // The second pass calculates the moments, gradients and fluxes, with a single sweep
+    // per field for the second order scheme.
+    stats->begin_deferred_sums();
+
+    stats->calc_stats_2nd(w->data, m->profs["w"].data, w->data, m->profs["w"].data,
+                          m->profs["w2"].data, m->profs["w3"].data, m->profs["w4"].data, 0, 0, 0,
+                          grid->dzhi, visc, wloc,
+                          atmp["tmp4"]->data, stats->nmaskh, atmp["tmp4"]->data, stats->nmaskh);
+
+    // calculate the stats on the u location, with the mask on the full and half level
+    grid->interpolate_2nd(atmp["tmp1"]->data, atmp["tmp3"]->data, sloc, uloc);
+    grid->interpolate_2nd(atmp["tmp2"]->data, atmp["tmp4"]->data, wloc, uwloc);
     if (grid->swspatialorder == "2")
     {
-        stats->calc_grad_2nd(u->data, m->profs["ugrad"].data, grid->dzhi, uloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-        stats->calc_flux_2nd(u->data, umodel, w->data, m->profs["w"].data,
-                            m->profs["uw"].data, atmp["tmp2"]->data, uloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-        if (model->diff->get_switch() == "smag2")
+        stats->calc_stats_2nd(u->data, umodel, w->data, m->profs["w"].data,
+                              m->profs["u2"].data, m->profs["u3"].data, m->profs["u4"].data,
+                              m->profs["ugrad"].data, m->profs["uw"].data, smag2 ? 0 : m->profs["udiff"].data,
+                              grid->dzhi, visc, uloc,
+                              atmp["tmp1"]->data, stats->nmask, atmp["tmp2"]->data, stats->nmaskh);
+        if (smag2)
             stats->calc_diff_2nd(u->data, w->data, sd["evisc"]->data,
                                 m->profs["udiff"].data, grid->dzhi,
                                 u->datafluxbot, u->datafluxtop, 1., uloc,
-                                atmp["tmp1"]->data, stats->nmaskh);
-        else
-            stats->calc_diff_2nd(u->data, m->profs["udiff"].data, grid->dzhi, visc, uloc,
-                                atmp["tmp1"]->data, stats->nmaskh);
-
+                                atmp["tmp2"]->data, stats->nmaskh);
     }
     else if (grid->swspatialorder == "4")
     {
+        stats->calc_stats_2nd(u->data, umodel, w->data, m->profs["w"].data,
+                              m->profs["u2"].data, m->profs["u3"].data, m->profs["u4"].data, 0, 0, 0,
+                              grid->dzhi, visc, uloc,
+                              atmp["tmp1"]->data, stats->nmask, atmp["tmp2"]->data, stats->nmaskh);
         stats->calc_grad_4th(u->data, m->profs["ugrad"].data, grid->dzhi4, uloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-        stats->calc_flux_4th(u->data, w->data, m->profs["uw"].data, atmp["tmp2"]->data, uloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
+                            atmp["tmp2"]->data, stats->nmaskh);
+        stats->calc_flux_4th(u->data, w->data, m->profs["uw"].data, atmp["tmp1"]->data, uloc,
+                            atmp["tmp2"]->data, stats->nmaskh);
         stats->calc_diff_4th(u->data, m->profs["udiff"].data, grid->dzhi4, visc, uloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
+                            atmp["tmp2"]->data, stats->nmaskh);
     }
 
-    // calculate the stats on the v location
+    // calculate the stats on the v location, with the mask on the full and half level
     grid->interpolate_2nd(atmp["tmp1"]->data, atmp["tmp3"]->data, sloc, vloc);
-    stats->calc_mean(m->profs["v"].data, v->data, grid->vtrans, vloc, atmp["tmp1"]->data, stats->nmask);
-    stats->calc_mean(vmodel            , v->data, NoOffset   , vloc, atmp["tmp1"]->data, stats->nmask);
-    for (int n=2; n<5; ++n)
-    {
-        std::stringstream ss;
-        ss << n;
-        std::string sn = ss.str();
-        stats->calc_moment(v->data, vmodel, m->profs["v"+sn].data, n, vloc,
-                          atmp["tmp1"]->data, stats->nmask);
-    }
-
-    // interpolate the mask on half level horizontally onto the u coordinate
-    grid->interpolate_2nd(atmp["tmp1"]->data, atmp["tmp4"]->data, wloc, vwloc);
+    grid->interpolate_2nd(atmp["tmp2"]->data, atmp["tmp4"]->data, wloc, vwloc);
     if (grid->swspatialorder == "2")
     {
-        stats->calc_grad_2nd(v->data, m->profs["vgrad"].data, grid->dzhi, vloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-        stats->calc_flux_2nd(v->data, vmodel, w->data, m->profs["w"].data,
-                            m->profs["vw"].data, atmp["tmp2"]->data, vloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-        if (model->diff->get_switch() == "smag2")
+        stats->calc_stats_2nd(v->data, vmodel, w->data, m->profs["w"].data,
+                              m->profs["v2"].data, m->profs["v3"].data, m->profs["v4"].data,
+                              m->profs["vgrad"].data, m->profs["vw"].data, smag2 ? 0 : m->profs["vdiff"].data,
+                              grid->dzhi, visc, vloc,
+                              atmp["tmp1"]->data, stats->nmask, atmp["tmp2"]->data, stats->nmaskh);
+        if (smag2)
             stats->calc_diff_2nd(v->data, w->data, sd["evisc"]->data,
                                 m->profs["vdiff"].data, grid->dzhi,
                                 v->datafluxbot, v->datafluxtop, 1., vloc,
-                                atmp["tmp1"]->data, stats->nmaskh);
-        else
-            stats->calc_diff_2nd(v->data, m->profs["vdiff"].data, grid->dzhi, visc, vloc,
-                                atmp["tmp1"]->data, stats->nmaskh);
-
+                                atmp["tmp2"]->data, stats->nmaskh);
     }
     else if (grid->swspatialorder == "4")
     {
+        stats->calc_stats_2nd(v->data, vmodel, w->data, m->profs["w"].data,
+                              m->profs["v2"].data, m->profs["v3"].data, m->profs["v4"].data, 0, 0, 0,
+                              grid->dzhi, visc, vloc,
+                              atmp["tmp1"]->data, stats->nmask, atmp["tmp2"]->data, stats->nmaskh);
         stats->calc_grad_4th(v->data, m->profs["vgrad"].data, grid->dzhi4, vloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-        stats->calc_flux_4th(v->data, w->data, m->profs["vw"].data, atmp["tmp2"]->data, vloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
+                            atmp["tmp2"]->data, stats->nmaskh);
+        stats->calc_flux_4th(v->data, w->data, m->profs["vw"].data, atmp["tmp1"]->data, vloc,
+                            atmp["tmp2"]->data, stats->nmaskh);
         stats->calc_diff_4th(v->data, m->profs["vdiff"].data, grid->dzhi4, visc, vloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
+                            atmp["tmp2"]->data, stats->nmaskh);
     }
 
     // calculate stats for the prognostic scalars
-    Diff_smag_2 *diffptr = static_cast<Diff_smag_2 *>(model->diff);
     for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
     {
-        stats->calc_mean(m->profs[it->first].data, it->second->data, NoOffset, sloc, atmp["tmp3"]->data, stats->nmask);
-        for (int n=2; n<5; ++n)
-        {
-            std::stringstream ss;
-            ss << n;
-            std::string sn = ss.str();
-            stats->calc_moment(it->second->data, m->profs[it->first].data, m->profs[it->first+sn].data, n, sloc,
-                    atmp["tmp3"]->data, stats->nmask);
-        }
+        if (!is_loaded(it->first))
+            continue;
+
         if (grid->swspatialorder == "2")
         {
-            stats->calc_grad_2nd(it->second->data, m->profs[it->first+"grad"].data, grid->dzhi, sloc,
-                                atmp["tmp4"]->data, stats->nmaskh);
-            stats->calc_flux_2nd(it->second->data, m->profs[it->first].data, w->data, m->profs["w"].data,
-                                m->profs[it->first+"w"].data, atmp["tmp1"]->data, sloc,
-                                atmp["tmp4"]->data, stats->nmaskh);
-            if (model->diff->get_switch() == "smag2")
+            stats->calc_stats_2nd(it->second->data, m->profs[it->first].data, w->data, m->profs["w"].data,
+                                  m->profs[it->first+"2"].data, m->profs[it->first+"3"].data, m->profs[it->first+"4"].data,
+                                  m->profs[it->first+"grad"].data, m->profs[it->first+"w"].data,
+                                  smag2 ? 0 : m->profs[it->first+"diff"].data,
+                                  grid->dzhi, it->second->visc, sloc,
+                                  atmp["tmp3"]->data, stats->nmask, atmp["tmp4"]->data, stats->nmaskh);
+            if (smag2)
                 stats->calc_diff_2nd(it->second->data, w->data, sd["evisc"]->data,
                                     m->profs[it->first+"diff"].data, grid->dzhi,
                                     it->second->datafluxbot, it->second->datafluxtop, diffptr->tPr, sloc,
                                     atmp["tmp4"]->data, stats->nmaskh);
-            else
-                stats->calc_diff_2nd(it->second->data, m->profs[it->first+"diff"].data, grid->dzhi, it->second->visc, sloc,
-                                    atmp["tmp4"]->data, stats->nmaskh);
         }
         else if (grid->swspatialorder == "4")
         {
+            stats->calc_stats_2nd(it->second->data, m->profs[it->first].data, w->data, m->profs["w"].data,
+                                  m->profs[it->first+"2"].data, m->profs[it->first+"3"].data, m->profs[it->first+"4"].data,
+                                  0, 0, 0,
+                                  grid->dzhi, it->second->visc, sloc,
+                                  atmp["tmp3"]->data, stats->nmask, atmp["tmp4"]->data, stats->nmaskh);
             stats->calc_grad_4th(it->second->data, m->profs[it->first+"grad"].data, grid->dzhi4, sloc,
                                 atmp["tmp4"]->data, stats->nmaskh);
             stats->calc_flux_4th(it->second->data, w->data, m->profs[it->first+"w"].data, atmp["tmp1"]->data, sloc,
@@ -538,34 +560,35 @@ void Fields::exec_stats(Mask *m)
         }
     }
 
-    // Calculate pressure statistics
-    stats->calc_mean(m->profs["p"].data, sd["p"]->data, NoOffset, sloc, atmp["tmp3"]->data, stats->nmask);
-    stats->calc_moment(sd["p"]->data, m->profs["p"].data, m->profs["p2"].data, 2, sloc,
-                      atmp["tmp1"]->data, stats->nmask);
+    // Calculate pressure statistics, all with the mask at the scalar location in tmp3,
+    // where earlier versions computed p2 with the mask at the v location in tmp1.
     if (grid->swspatialorder == "2")
     {
-        stats->calc_grad_2nd(sd["p"]->data, m->profs["pgrad"].data, grid->dzhi, sloc,
-                             atmp["tmp4"]->data, stats->nmaskh);
-        stats->calc_flux_2nd(sd["p"]->data, m->profs["p"].data, w->data, m->profs["w"].data,
-                            m->profs["pw"].data, atmp["tmp1"]->data, sloc,
-                            atmp["tmp4"]->data, stats->nmaskh);
+        stats->calc_stats_2nd(sd["p"]->data, m->profs["p"].data, w->data, m->profs["w"].data,
+                              m->profs["p2"].data, 0, 0, m->profs["pgrad"].data, m->profs["pw"].data, 0,
+                              grid->dzhi, 0., sloc,
+                              atmp["tmp3"]->data, stats->nmask, atmp["tmp4"]->data, stats->nmaskh);
     }
     else if (grid->swspatialorder == "4")
     {
+        stats->calc_stats_2nd(sd["p"]->data, m->profs["p"].data, w->data, m->profs["w"].data,
+                              m->profs["p2"].data, 0, 0, 0, 0, 0,
+                              grid->dzhi, 0., sloc,
+                              atmp["tmp3"]->data, stats->nmask, atmp["tmp4"]->data, stats->nmaskh);
         stats->calc_grad_4th(sd["p"]->data, m->profs["pgrad"].data, grid->dzhi4, sloc,
                              atmp["tmp4"]->data, stats->nmaskh);
         stats->calc_flux_4th(sd["p"]->data, w->data, m->profs["pw"].data, atmp["tmp1"]->data, sloc,
                              atmp["tmp4"]->data, stats->nmaskh);
     }
 
+    stats->end_deferred_sums();
+
     // calculate the total fluxes
     stats->add_fluxes(m->profs["uflux"].data, m->profs["uw"].data, m->profs["udiff"].data);
     stats->add_fluxes(m->profs["vflux"].data, m->profs["vw"].data, m->profs["vdiff"].data);
     for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
-        stats->add_fluxes(m->profs[it->first+"flux"].data, m->profs[it->first+"w"].data, m->profs[it->first+"diff"].data);
-
-    if (model->diff->get_switch() == "smag2")
-        stats->calc_mean(m->profs["evisc"].data, sd["evisc"]->data, NoOffset, sloc, atmp["tmp3"]->data, stats->nmask);
+        if (is_loaded(it->first))
+            stats->add_fluxes(m->profs[it->first+"flux"].data, m->profs[it->first+"w"].data, m->profs[it->first+"diff"].data);
 }
 
 void Fields::set_calc_mean_profs(bool sw)
@@ -803,14 +826,39 @@ void Fields::load(int n)
     const double NoOffset = 0.;
 
     int nerror = 0;
+    int nbuf = 0;
 
     for (FieldMap::const_iterator it=ap.begin(); it!=ap.end(); ++it)
     {
         // the offset is kept at zero, otherwise bitwise identical restarts is not possible
         char filename[256];
         std::sprintf(filename, "%s.%07d", it->second->name.c_str(), n);
+
+        // fields that are not needed in post processing mode are not read
+        if (!is_loaded(it->first))
+        {
+            ++nbuf;
+            continue;
+        }
+
         master->print_message("Loading \"%s\" ... ", filename);
-        if (grid->load_field3d(it->second->data, atmp["tmp1"]->data, atmp["tmp2"]->data, filename, NoOffset))
+
+        // complete the prefetch, which is discarded if it belongs to another time
+        int error = 0;
+        bool done = false;
+        if (prefetchtime != -1 && prefetched[nbuf])
+        {
+            char prefetchname[256];
+            std::sprintf(prefetchname, "%s.%07d", it->second->name.c_str(), prefetchtime);
+            error = grid->load_field3d_end(it->second->data, atmp["tmp1"]->data, atmp["tmp2"]->data, prefetchname, NoOffset);
+            done = (prefetchtime == n);
+        }
+        ++nbuf;
+
+        if (!done)
+            error = grid->load_field3d(it->second->data, atmp["tmp1"]->data, atmp["tmp2"]->data, filename, NoOffset);
+
+        if (error)
         {
             master->print_message("FAILED\n");
             ++nerror;
@@ -821,6 +869,8 @@ void Fields::load(int n)
         }  
     }
 
+    prefetchtime = -1;
+
     if (nerror)
         throw 1;
 }
@@ -837,8 +887,10 @@ void Fields::create_stats()
         stats->add_prof(v->name, v->longname, v->unit, "z" );
         stats->add_prof(w->name, w->longname, w->unit, "zh" );
 
+        // the scalars that are not loaded in post processing mode have no statistics
         for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
-            stats->add_prof(it->first,it->second->longname, it->second->unit, "z");
+            if (is_loaded(it->first))
+                stats->add_prof(it->first,it->second->longname, it->second->unit, "z");
 
         stats->add_prof(sd["p"]->name, sd["p"]->longname, sd["p"]->unit, "z");
         std::string sn("2");
@@ -860,43 +912,111 @@ void Fields::create_stats()
             stats->add_prof(v->name + sn,"Moment "+ sn + " of the " + v->longname,"(" + v->unit + ")"+sn, "z" );
             stats->add_prof(w->name + sn,"Moment "+ sn + " of the " + w->longname,"(" + w->unit + ")"+sn, "zh" );
             for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
-                stats->add_prof(it->first + sn,"Moment "+ sn + " of the " + it->second->longname,"(" + it->second->unit + ")"+sn, "z" );
+                if (is_loaded(it->first))
+                    stats->add_prof(it->first + sn,"Moment "+ sn + " of the " + it->second->longname,"(" + it->second->unit + ")"+sn, "z" );
         }
 
         // gradients
         stats->add_prof(u->name + "grad", "Gradient of the " + u->longname,"s-1","zh");
         stats->add_prof(v->name + "grad", "Gradient of the " + v->longname,"s-1","zh");
         for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
-            stats->add_prof(it->first+"grad", "Gradient of the " + it->second->longname, it->second->unit + " m-1", "zh");
+            if (is_loaded(it->first))
+                stats->add_prof(it->first+"grad", "Gradient of the " + it->second->longname, it->second->unit + " m-1", "zh");
 
         // turbulent fluxes
         stats->add_prof("uw", "Turbulent flux of the " + u->longname, "m2 s-2", "zh");
         stats->add_prof("vw", "Turbulent flux of the " + v->longname, "m2 s-2", "zh");
         for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
-            stats->add_prof(it->first+"w", "Turbulent flux of the " + it->second->longname, it->second->unit + " m s-1", "zh");
+            if (is_loaded(it->first))
+                stats->add_prof(it->first+"w", "Turbulent flux of the " + it->second->longname, it->second->unit + " m s-1", "zh");
 
         // Diffusive fluxes
         stats->add_prof("udiff", "Diffusive flux of the " + u->longname, "m2 s-2", "zh");
         stats->add_prof("vdiff", "Diffusive flux of the " + v->longname, "m2 s-2", "zh");
         for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
-            stats->add_prof(it->first+"diff", "Diffusive flux of the " + it->second->longname, it->second->unit + " m s-1", "zh");
+            if (is_loaded(it->first))
+                stats->add_prof(it->first+"diff", "Diffusive flux of the " + it->second->longname, it->second->unit + " m s-1", "zh");
 
         //Total fluxes
         stats->add_prof("uflux", "Total flux of the " + u->longname, "m2 s-2", "zh");
         stats->add_prof("vflux", "Total flux of the " + v->longname, "m2 s-2", "zh");
         for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
-            stats->add_prof(it->first+"flux", "Total flux of the " + it->second->longname, it->second->unit + " m s-1", "zh");
+            if (is_loaded(it->first))
+                stats->add_prof(it->first+"flux", "Total flux of the " + it->second->longname, it->second->unit + " m s-1", "zh");
+
+        // spectra
+        std::vector<std::string>* spectralist_global = stats->get_spectralist();
+        for (std::vector<std::string>::const_iterator it=spectralist_global->begin(); it!=spectralist_global->end(); ++it)
+        {
+            if (a.count(*it))
+            {
+                stats->add_spectra(*it, a[*it]->longname, a[*it]->unit);
+                spectralist.push_back(*it);
+            }
+            else
+                master->print_warning("field %s in [stats][spectralist] is illegal\n", it->c_str());
+        }
+    }
+
+    // add the profiles to the columns
+    if (model->column->get_switch() == "1")
+    {
+        std::vector<std::string>* columnlist_global = model->column->get_columnlist();
+        for (std::vector<std::string>::const_iterator it=columnlist_global->begin(); it!=columnlist_global->end(); ++it)
+        {
+            if (a.count(*it))
+            {
+                // the vertical velocity is the only field at the half levels
+                const std::string zloc = (*it == "w") ? "zh" : "z";
+                model->column->add_prof(*it, a[*it]->longname, a[*it]->unit, zloc);
+                columnlist.push_back(*it);
+            }
+            else
+                master->print_warning("field %s in [column][columnlist] is illegal\n", it->c_str());
+        }
     }
 
     if (nerror)
         throw 1;
 }
 
+void Fields::exec_column()
+{
+    for (std::vector<std::string>::const_iterator it=columnlist.begin(); it!=columnlist.end(); ++it)
+    {
+        // add the grid translation velocity, as for the profiles in the statistics
+        double offset = 0.;
+        if (*it == "u")
+            offset = grid->utrans;
+        else if (*it == "v")
+            offset = grid->vtrans;
+
+        model->column->calc_column(*it, a[*it]->data, offset);
+    }
+}
+
+void Fields::exec_spectra()
+{
+    for (std::vector<std::string>::const_iterator it=spectralist.begin(); it!=spectralist.end(); ++it)
+        stats->calc_spectra(*it, a[*it]->data, atmp["tmp1"]->data, atmp["tmp2"]->data, atmp["tmp3"]->data);
+}
+
 void Fields::save(int n)
 {
     const double NoOffset = 0.;
 
+    if (swasyncsave == "1")
+    {
+        // The staging buffers of the previous save can only be reused once it is complete.
+        finish_save();
+
+        if (savebufs.empty())
+            for (size_t nbuf=0; nbuf<ap.size(); ++nbuf)
+                savebufs.push_back(new double[grid->ncells]);
+    }
+
     int nerror = 0;
+    int nbuf = 0;
     for (FieldMap::const_iterator it=ap.begin(); it!=ap.end(); ++it)
     {
         char filename[256];
@@ -904,21 +1024,135 @@ void Fields::save(int n)
         master->print_message("Saving \"%s\" ... ", filename);
 
         // the offset is kept at zero, because otherwise bitwise identical restarts is not possible
-        if (grid->save_field3d(it->second->data, atmp["tmp1"]->data, atmp["tmp2"]->data, filename, NoOffset))
+        int error;
+        if (swasyncsave == "1")
+            error = grid->save_field3d_start(it->second->data, atmp["tmp1"]->data, savebufs[nbuf++], filename, NoOffset, true);
+        else
+            error = grid->save_field3d(it->second->data, atmp["tmp1"]->data, atmp["tmp2"]->data, filename, NoOffset, true);
+
+        if (error)
         {
             master->print_message("FAILED\n");
             ++nerror;
         }  
         else
         {
-            master->print_message("OK\n");
+            master->print_message(swasyncsave == "1" ? "STARTED\n" : "OK\n");
         }
     }
 
+    if (swasyncsave == "1")
+        savepending = true;
+
     if (nerror)
         throw 1;
 }
 
+// Selects the prognostic fields that are read from disk, which in post processing mode are only those that are needed.
+void Fields::create_loadlist()
+{
+    loadlist.clear();
+
+    // In run mode, all prognostic fields are required for a restart.
+    if (master->mode != "post")
+    {
+        for (FieldMap::const_iterator it=ap.begin(); it!=ap.end(); ++it)
+            loadlist.push_back(it->first);
+        return;
+    }
+
+    // The velocity components are always needed, as the tendencies and the status are computed
+    // from them, and so are the prognostic variables of the thermodynamics.
+    for (FieldMap::const_iterator it=mp.begin(); it!=mp.end(); ++it)
+        loadlist.push_back(it->first);
+    model->thermo->get_prog_vars(&loadlist);
+
+    // Collect the fields that are requested by the output modules. The cross sections of the fields
+    // have been moved from the global list into the lists of this class by init, without their suffix.
+    std::vector<std::string> outputlist;
+    const std::vector<std::string>* crosslists[] = {&crosssimple, &crosslngrad, &crossbot, &crosstop, &crossfluxbot, &crossfluxtop};
+    for (int n=0; n<6; ++n)
+        outputlist.insert(outputlist.end(), crosslists[n]->begin(), crosslists[n]->end());
+    outputlist.insert(outputlist.end(), model->column->get_columnlist()->begin(), model->column->get_columnlist()->end());
+    outputlist.insert(outputlist.end(), stats->get_spectralist()->begin(), stats->get_spectralist()->end());
+    model->average->get_fieldlist(&outputlist);
+
+    // A passive scalar is only loaded if an output module requests it, its statistics are skipped otherwise.
+    for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
+        if (!is_loaded(it->first) && std::find(outputlist.begin(), outputlist.end(), it->first) != outputlist.end())
+            loadlist.push_back(it->first);
+
+    // The fields that are not read are set to zero once.
+    for (FieldMap::const_iterator it=ap.begin(); it!=ap.end(); ++it)
+        if (!is_loaded(it->first))
+        {
+            master->print_message("Field \"%s\" is not needed and is not loaded\n", it->first.c_str());
+            for (int n=0; n<grid->ncells; ++n)
+                it->second->data[n] = 0.;
+        }
+}
+
+bool Fields::is_loaded(std::string name)
+{
+    return std::find(loadlist.begin(), loadlist.end(), name) != loadlist.end();
+}
+
+/**
+ * This function starts reading the prognostic fields of the given time into a second set of buffers,
+ * such that the reading overlaps with the statistics of the current time. The fields are stored
+ * when load is called for this time.
+ */
+void Fields::prefetch(int n)
+{
+    if (swprefetch == "0" || n == -1)
+        return;
+
+    prefetched.assign(ap.size(), 0);
+
+    int nbuf = 0;
+    for (FieldMap::const_iterator it=ap.begin(); it!=ap.end(); ++it)
+    {
+        char filename[256];
+        std::sprintf(filename, "%s.%07d", it->second->name.c_str(), n);
+
+        // a failing prefetch is not an error yet, the field is loaded the normal way instead
+        if (is_loaded(it->first))
+            prefetched[nbuf] = (grid->load_field3d_start(filename) == 0);
+        ++nbuf;
+    }
+
+    prefetchtime = n;
+}
+
+void Fields::progress_save()
+{
+    if (savepending)
+        grid->progress_field3d_save();
+}
+
+void Fields::progress_prefetch()
+{
+    if (prefetchtime != -1)
+        grid->progress_field3d_load();
+}
+
+void Fields::finish_save()
+{
+    if (!savepending)
+        return;
+
+    savepending = false;
+
+    master->print_message("Completing the asynchronous save ... ");
+    if (grid->save_field3d_end())
+    {
+        master->print_message("FAILED\n");
+        throw 1;
+    }
+    else
+        master->print_message("OK\n");
+}
+
 #ifndef USECUDA
 double Fields::check_momentum()
 {
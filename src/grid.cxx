@@ -23,6 +23,9 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
+#include <cctype>
+#include <unistd.h>
+#include <zlib.h>
 #include "master.h"
 #include "grid.h"
 #include "input.h"
@@ -45,6 +48,8 @@ Grid::Grid(Model *modelin, Input *inputin)
     mpitypes  = false;
     fftwplan  = false;
 
+    deferreductions = false;
+
     // Initialize the pointers to zero.
     x  = 0;
     xh = 0;
@@ -74,6 +79,12 @@ Grid::Grid(Model *modelin, Input *inputin)
     fftinj  = 0;
     fftoutj = 0;
 
+#ifdef USEMPI
+    halobuf     = 0;
+    nhalobuf    = 0;
+    nhalofields = 0;
+#endif
+
     int nerror = 0;
     nerror += inputin->get_item(&xsize, "grid", "xsize", "");
     nerror += inputin->get_item(&ysize, "grid", "ysize", "");
@@ -88,6 +99,13 @@ Grid::Grid(Model *modelin, Input *inputin)
 
     nerror += inputin->get_item(&swspatialorder, "grid", "swspatialorder", "");
 
+    nerror += inputin->get_item(&fftchunk, "grid", "fftchunk", "", 0);
+
+    std::string swfftwplanner;
+    nerror += inputin->get_item(&swfftwplanner, "grid", "fftwplanner"  , "", "exhaustive");
+    nerror += inputin->get_item(&fftwtimelimit, "grid", "fftwtimelimit", "", -1.);
+    nerror += inputin->get_item(&fftwwisdomdir, "grid", "fftwwisdomdir", "", "");
+
     if (nerror)
         throw 1;
 
@@ -96,6 +114,21 @@ Grid::Grid(Model *modelin, Input *inputin)
         master->print_error("\"%s\" is an illegal value for swspatialorder\n", swspatialorder.c_str());
         throw 1;
     }
+
+    if (swfftwplanner == "estimate")
+        fftwflags = FFTW_ESTIMATE;
+    else if (swfftwplanner == "measure")
+        fftwflags = FFTW_MEASURE;
+    else if (swfftwplanner == "patient")
+        fftwflags = FFTW_PATIENT;
+    else if (swfftwplanner == "exhaustive")
+        fftwflags = FFTW_EXHAUSTIVE;
+    else
+    {
+        master->print_error("\"%s\" is an illegal value for fftwplanner\n", swfftwplanner.c_str());
+        throw 1;
+    }
+
     // 2nd order scheme requires only 1 ghost cell
     if (swspatialorder == "2")
     {
@@ -185,6 +218,12 @@ void Grid::init()
         master->print_error("ERROR ktot = %d is not a multiple of npx = %d\n", ktot, master->npx);
         throw 1;
     }
+    // The pipelined transposes split the kblock levels of each block into equal chunks.
+    if (fftchunk < 0 || (fftchunk > 0 && (ktot / master->npx) % fftchunk != 0))
+    {
+        master->print_error("fftchunk = %d is not a divisor of ktot/npx = %d\n", fftchunk, ktot / master->npx);
+        throw 1;
+    }
 
     // Calculate the total number of grid cells.
     ntot = itot*jtot*ktot;
@@ -439,6 +478,151 @@ void Grid::set_minimum_ghost_cells(const int igcin, const int jgcin, const int k
     //check_ghost_cells(); 
 }
 
+/**
+ * This function returns the bounds of one of the boxes the domain is split in
+ * to overlap the ghost cell exchange with computations. Box 0 is the interior
+ * of the domain, for which stencils that do not reach further than the number of
+ * ghost cells do not touch any ghost cell. Boxes 1 to 6 cover the remainder.
+ * @param ib,ie Start and end index of the box in the x-direction.
+ * @param jb,je Start and end index of the box in the y-direction.
+ * @param kb,ke Start and end index of the box in the z-direction.
+ * @param n Number of the box.
+ */
+void Grid::get_box(int& ib, int& ie, int& jb, int& je, int& kb, int& ke, const int n)
+{
+    // Limit the interior to an empty box in case the domain is too thin.
+    const int iib = std::min(istart+igc, iend);
+    const int iie = std::max(iend-igc, iib);
+    const int jib = std::min(jstart+jgc, jend);
+    const int jie = std::max(jend-jgc, jib);
+    const int kib = std::min(kstart+kgc, kend);
+    const int kie = std::max(kend-kgc, kib);
+
+    // Default to the interior and widen the box in the directions that need it.
+    ib = iib; ie = iie;
+    jb = jib; je = jie;
+    kb = kib; ke = kie;
+
+    if (n == 1)      // bottom levels
+    {
+        ib = istart; ie = iend; jb = jstart; je = jend; kb = kstart; ke = kib;
+    }
+    else if (n == 2) // top levels
+    {
+        ib = istart; ie = iend; jb = jstart; je = jend; kb = kie; ke = kend;
+    }
+    else if (n == 3) // south edge
+    {
+        ib = istart; ie = iend; jb = jstart; je = jib;
+    }
+    else if (n == 4) // north edge
+    {
+        ib = istart; ie = iend; jb = jie; je = jend;
+    }
+    else if (n == 5) // west edge
+    {
+        ib = istart; ie = iib;
+    }
+    else if (n == 6) // east edge
+    {
+        ib = iie; ie = iend;
+    }
+}
+
+/**
+ * This function creates the FFTW3 plans with the planner level and time limit
+ * from the input file. Wisdom that is imported before the call is reused, which makes
+ * the plans, and thus the results, identical to those of the run that created it.
+ */
+void Grid::create_fftw_plans()
+{
+    // use the FFTW3 many interface in order to reduce function call overhead
+    int rank = 1;
+    int ni[] = {itot};
+    int nj[] = {jtot};
+    int istride = 1;
+    int jstride = iblock;
+    int idist = itot;
+    int jdist = 1;
+
+    fftw_r2r_kind kindf[] = {FFTW_R2HC};
+    fftw_r2r_kind kindb[] = {FFTW_HC2R};
+
+    fftw_set_timelimit(fftwtimelimit);
+
+    iplanf = fftw_plan_many_r2r(rank, ni, jmax, fftini, ni, istride, idist,
+                                fftouti, ni, istride, idist, kindf, fftwflags);
+    iplanb = fftw_plan_many_r2r(rank, ni, jmax, fftini, ni, istride, idist,
+                                fftouti, ni, istride, idist, kindb, fftwflags);
+    jplanf = fftw_plan_many_r2r(rank, nj, iblock, fftinj, nj, jstride, jdist,
+                                fftoutj, nj, jstride, jdist, kindf, fftwflags);
+    jplanb = fftw_plan_many_r2r(rank, nj, iblock, fftinj, nj, jstride, jdist,
+                                fftoutj, nj, jstride, jdist, kindb, fftwflags);
+
+    fftwplan = true;
+}
+
+/**
+ * This function returns the name of the file in the wisdom cache for this grid. The plans
+ * depend on the transform lengths, the number of transforms per call and the FFTW version.
+ * An empty string is returned if no cache directory is set.
+ */
+std::string Grid::get_wisdom_cache_name()
+{
+    if (fftwwisdomdir == "")
+        return "";
+
+    // strip the characters from the version that do not belong in a file name
+    std::string version(fftw_version);
+    for (std::string::iterator it=version.begin(); it!=version.end(); ++it)
+        if (!(std::isalnum(*it) || *it == '.' || *it == '-'))
+            *it = '_';
+
+    char filename[256];
+    std::sprintf(filename, "fftwwisdom.%d.%d.%d.%d.", itot, jtot, iblock, jmax);
+
+    return fftwwisdomdir + "/" + filename + version;
+}
+
+/**
+ * This function imports the wisdom of this grid from the cache.
+ * @return True if the wisdom is found, false otherwise.
+ */
+bool Grid::import_wisdom_cache()
+{
+    const std::string filename = get_wisdom_cache_name();
+    if (filename == "")
+        return false;
+
+    return fftw_import_wisdom_from_filename(filename.c_str()) != 0;
+}
+
+/**
+ * This function stores the current wisdom in the cache. The file is written under a
+ * temporary name and moved in place afterwards, such that cases that start at the same
+ * time never read a partially written file.
+ */
+void Grid::export_wisdom_cache()
+{
+    const std::string filename = get_wisdom_cache_name();
+    if (filename == "")
+        return;
+
+    char tmpname[512];
+    std::sprintf(tmpname, "%s.%d.tmp", filename.c_str(), static_cast<int>(getpid()));
+
+    master->print_message("Saving \"%s\" ... ", filename.c_str());
+
+    if (fftw_export_wisdom_to_filename(tmpname) == 0 || std::rename(tmpname, filename.c_str()) != 0)
+    {
+        std::remove(tmpname);
+        master->print_message("FAILED\n");
+        master->print_warning("the wisdom cache is not updated\n");
+    }
+    else
+        master->print_message("OK\n");
+}
+
 /**
  * This function does a second order horizontal interpolation in the x-direction
  * to the selected location on the grid.
@@ -530,3 +714,208 @@ void Grid::calc_mean(double* restrict prof, const double* restrict data, const i
     for (int k=0; k<krange; ++k)
         prof[k] /= n;
 }
+
+namespace
+{
+    // The header of a 3d field starts with the characters MHH3 in little endian.
+    const int field3dmagic   = 0x3348484d;
+    const int field3dversion = 1;
+    const int field3dlayout  = 0; // the values of the full domain in k, j, i order
+
+    // The header of a packed 3d field starts with the characters MHP3 in little endian.
+    const int field3dpackedmagic    = 0x3350484d;
+    const int field3dpackedversion  = 1;
+    const int field3dpackedsingle   = 1; // flag for values in single precision
+    const int field3dpackedcompress = 2; // flag for values that are compressed per block
+}
+
+/**
+ * This function fills the header of a 3d field. The header describes the size of the
+ * full domain and the layout of the data, such that the field can be read back on any
+ * decomposition over the processes.
+ * @param header Array of field3dheaderlength integers.
+ */
+void Grid::set_field3d_header(int* header)
+{
+    header[0] = field3dmagic;
+    header[1] = field3dversion;
+    header[2] = itot;
+    header[3] = jtot;
+    header[4] = ktot;
+    header[5] = field3dlayout;
+    header[6] = sizeof(double);
+    header[7] = 0;
+}
+
+/**
+ * This function fills the header of a packed 3d field, which is followed by the offset and scale.
+ * Besides the size of the domain, it holds the format of the values and the number of blocks per level.
+ * @param header Array of field3dheaderlength integers.
+ * @param single Values are stored in single precision.
+ * @param compress Values are compressed per block.
+ */
+void Grid::set_field3d_packed_header(int* header, const bool single, const bool compress)
+{
+    header[0] = field3dpackedmagic;
+    header[1] = field3dpackedversion;
+    header[2] = itot;
+    header[3] = jtot;
+    header[4] = ktot;
+    header[5] = (single ? field3dpackedsingle : 0) | (compress ? field3dpackedcompress : 0);
+    header[6] = master->npy;
+    header[7] = 0;
+}
+
+/**
+ * This function checks whether a 3d field fits the grid of the model. Fields without header,
+ * written by older versions, are accepted if the size of the file matches the grid.
+ * @param header The first field3dheaderlength integers of the file.
+ * @param filesize Size of the file in bytes.
+ * @param dataoffset Position of the data in the file in bytes on return.
+ * @param filename Name of the file for the error messages.
+ * @return 0 if the field fits, 1 otherwise.
+ */
+int Grid::check_field3d_header(const int* header, const long long filesize, long long* dataoffset, char* filename)
+{
+    const long long datasize = (long long)itot*jtot*ktot*sizeof(double);
+    const long long headersize = field3dheaderlength*sizeof(int);
+
+    // A field without header is recognized by its size, as its first bytes could match the header.
+    if (filesize == datasize)
+    {
+        *dataoffset = 0;
+        return 0;
+    }
+
+    if (filesize >= headersize && header[0] == field3dmagic)
+    {
+        if (header[1] != field3dversion || header[5] != field3dlayout || header[6] != sizeof(double))
+        {
+            master->print_error("\"%s\" has an unsupported version %d or layout %d\n", filename, header[1], header[5]);
+            return 1;
+        }
+        if (header[2] != itot || header[3] != jtot || header[4] != ktot)
+        {
+            master->print_error("\"%s\" has a grid of %dx%dx%d, while the model grid is %dx%dx%d\n",
+                                filename, header[2], header[3], header[4], itot, jtot, ktot);
+            return 1;
+        }
+        if (filesize != headersize + datasize)
+        {
+            master->print_error("\"%s\" is truncated\n", filename);
+            return 1;
+        }
+        *dataoffset = headersize;
+        return 0;
+    }
+
+    master->print_error("\"%s\" has a size of %lld bytes, which does not match the model grid\n", filename, filesize);
+    return 1;
+}
+
+/**
+ * This function averages a region of the subdomain over blocks of cells. The vertical average is weighted
+ * with the thickness of the layers. The blocks are stored with the x-direction as the fastest index.
+ * @param out Pointer to the block averages.
+ * @param data Pointer to the 3d field including ghost cells.
+ * @param offset Offset that is added to the data.
+ * @param range Start and end indices of the region in x, y and z including the ghost cells.
+ * @param coarse Number of cells per block in x, y and z, the size of the region is a multiple of it.
+ * @param loc Location of the field, a field at the half levels is weighted with dzh.
+ */
+void Grid::calc_coarse_block(double* restrict out, const double* restrict data, const double offset,
+                             const int range[6], const int coarse[3], const int loc[3])
+{
+    const int jj = icells;
+    const int kk = ijcells;
+
+    const double* restrict dzloc = loc[2] ? dzh : dz;
+
+    const int ni = (range[1]-range[0]) / coarse[0];
+    const int nj = (range[3]-range[2]) / coarse[1];
+    const int nk = (range[5]-range[4]) / coarse[2];
+
+    const double nhorfac = 1./(coarse[0]*coarse[1]);
+
+    for (int kc=0; kc<nk; ++kc)
+    {
+        const int kb = range[4] + kc*coarse[2];
+
+        double dzsum = 0.;
+        for (int k=kb; k<kb+coarse[2]; ++k)
+            dzsum += dzloc[k];
+
+        for (int jc=0; jc<nj; ++jc)
+            for (int ic=0; ic<ni; ++ic)
+            {
+                const int ib = range[0] + ic*coarse[0];
+                const int jb = range[2] + jc*coarse[1];
+
+                double sum = 0.;
+                for (int k=kb; k<kb+coarse[2]; ++k)
+                {
+                    double sumk = 0.;
+                    for (int j=jb; j<jb+coarse[1]; ++j)
+                        for (int i=ib; i<ib+coarse[0]; ++i)
+                            sumk += data[i + j*jj + k*kk];
+                    sum += sumk*dzloc[k];
+                }
+
+                out[ic + jc*ni + kc*ni*nj] = sum*nhorfac/dzsum + offset;
+            }
+    }
+}
+
+/**
+ * This function compresses a block of values without loss. The bytes of the values are shuffled first,
+ * such that the bytes of equal significance are contiguous, which makes the deflate much more effective.
+ * @param out Vector that contains the compressed block on return.
+ * @param in Pointer to the values.
+ * @param nvalues Number of values in the block.
+ * @param typesize Size of a single value in bytes.
+ */
+int Grid::compress_block(std::vector<unsigned char>& out, const unsigned char* in, const int nvalues, const int typesize)
+{
+    const int nbytes = nvalues*typesize;
+
+    std::vector<unsigned char> shuffled(nbytes);
+    for (int n=0; n<nvalues; ++n)
+        for (int b=0; b<typesize; ++b)
+            shuffled[b*nvalues + n] = in[n*typesize + b];
+
+    uLongf outsize = compressBound(nbytes);
+    out.resize(outsize);
+
+    if (compress2(&out[0], &outsize, &shuffled[0], nbytes, Z_BEST_SPEED) != Z_OK)
+        return 1;
+
+    out.resize(outsize);
+
+    return 0;
+}
+
+/**
+ * This function lets get_max and get_sum return the local value of the process,
+ * such that the values of several modules can be reduced at once with exec_reductions.
+ */
+void Grid::begin_deferred_reductions()
+{
+    deferreductions = true;
+}
+
+void Grid::end_deferred_reductions()
+{
+    deferreductions = false;
+}
+
+void Grid::add_max(double* var)
+{
+    reducevars.push_back(var);
+    reduceops.push_back(1);
+}
+
+void Grid::add_sum(double* var)
+{
+    reducevars.push_back(var);
+    reduceops.push_back(0);
+}
@@ -23,10 +23,30 @@
 #ifdef USEMPI
 #include <fftw3.h>
 #include <cstdio>
+#include <algorithm>
+#include <stdint.h>
 #include "master.h"
 #include "grid.h"
 #include "defines.h"
 
+namespace
+{
+    // Reduction of pairs of a reduction type and a value, the type is 0 for a sum and 1 for a maximum.
+    void reduce_sum_max(void* invec, void* inoutvec, int* len, MPI_Datatype* datatype)
+    {
+        const double* in    = static_cast<double*>(invec);
+        double*       inout = static_cast<double*>(inoutvec);
+
+        for (int n=0; n<*len; ++n)
+        {
+            if (in[2*n] == 0.)
+                inout[2*n+1] += in[2*n+1];
+            else
+                inout[2*n+1] = std::max(inout[2*n+1], in[2*n+1]);
+        }
+    }
+}
+
 // MPI functions
 void Grid::init_mpi()
 {
@@ -61,6 +81,19 @@ void Grid::init_mpi()
     MPI_Type_vector(datacount, datablock, datastride, MPI_DOUBLE, &northsouthedge2d);
     MPI_Type_commit(&northsouthedge2d);
 
+    // east west without corners, north south without corners and the corners for the split-phase exchange
+    int totsizeijk   [3] = {kcells, jcells, icells};
+    int substartijk  [3] = {0, 0, 0};
+    int subsizeew    [3] = {kcells, jmax, igc };
+    int subsizens    [3] = {kcells, jgc , imax};
+    int subsizecorner[3] = {kcells, jgc , igc };
+    MPI_Type_create_subarray(3, totsizeijk, subsizeew, substartijk, MPI_ORDER_C, MPI_DOUBLE, &eastwestface);
+    MPI_Type_commit(&eastwestface);
+    MPI_Type_create_subarray(3, totsizeijk, subsizens, substartijk, MPI_ORDER_C, MPI_DOUBLE, &northsouthface);
+    MPI_Type_commit(&northsouthface);
+    MPI_Type_create_subarray(3, totsizeijk, subsizecorner, substartijk, MPI_ORDER_C, MPI_DOUBLE, &corneredge);
+    MPI_Type_commit(&corneredge);
+
     // transposez
     datacount = imax*jmax*kblock;
     MPI_Type_contiguous(datacount, MPI_DOUBLE, &transposez);
@@ -99,6 +132,30 @@ void Grid::init_mpi()
     MPI_Type_vector(datacount, datablock, datastride, MPI_DOUBLE, &transposey2);
     MPI_Type_commit(&transposey2);
 
+    // chunks of fftchunk levels of the transpose types for the pipelined fft
+    if (fftchunk > 0)
+    {
+        datacount = imax*jmax*fftchunk;
+        MPI_Type_contiguous(datacount, MPI_DOUBLE, &transposezchunk);
+        MPI_Type_commit(&transposezchunk);
+
+        datacount = iblock*jblock*fftchunk;
+        MPI_Type_contiguous(datacount, MPI_DOUBLE, &transposez2chunk);
+        MPI_Type_commit(&transposez2chunk);
+
+        MPI_Type_vector(jmax*fftchunk, imax, itot, MPI_DOUBLE, &transposexchunk);
+        MPI_Type_commit(&transposexchunk);
+
+        MPI_Type_vector(jmax*fftchunk, iblock, itot, MPI_DOUBLE, &transposex2chunk);
+        MPI_Type_commit(&transposex2chunk);
+
+        MPI_Type_vector(fftchunk, iblock*jmax, iblock*jtot, MPI_DOUBLE, &transposeychunk);
+        MPI_Type_commit(&transposeychunk);
+
+        MPI_Type_vector(fftchunk, iblock*jblock, iblock*jtot, MPI_DOUBLE, &transposey2chunk);
+        MPI_Type_commit(&transposey2chunk);
+    }
+
     // file saving and loading, take C-ordering into account
     int totsizei  = itot;
     int subsizei  = imax;
@@ -143,6 +200,11 @@ void Grid::init_mpi()
     MPI_Type_create_subarray(2, totxysize, subxysize, subxystart, MPI_ORDER_C, MPI_DOUBLE, &subxyslice);
     MPI_Type_commit(&subxyslice);
 
+    // create the MPI type and operation for the combined reduction of sums and maxima
+    MPI_Type_contiguous(2, MPI_DOUBLE, &reducepair);
+    MPI_Type_commit(&reducepair);
+    MPI_Op_create(&reduce_sum_max, 1, &reduceop);
+
     // allocate the array for the profiles
     profl = new double[kcells];
 
@@ -157,20 +219,59 @@ void Grid::exit_mpi()
         MPI_Type_free(&northsouthedge);
         MPI_Type_free(&eastwestedge2d);
         MPI_Type_free(&northsouthedge2d);
+        MPI_Type_free(&eastwestface);
+        MPI_Type_free(&northsouthface);
+        MPI_Type_free(&corneredge);
         MPI_Type_free(&transposez);
         MPI_Type_free(&transposez2);
         MPI_Type_free(&transposex);
         MPI_Type_free(&transposex2);
         MPI_Type_free(&transposey);
         MPI_Type_free(&transposey2);
+        if (fftchunk > 0)
+        {
+            MPI_Type_free(&transposezchunk);
+            MPI_Type_free(&transposez2chunk);
+            MPI_Type_free(&transposexchunk);
+            MPI_Type_free(&transposex2chunk);
+            MPI_Type_free(&transposeychunk);
+            MPI_Type_free(&transposey2chunk);
+        }
         MPI_Type_free(&subi);
         MPI_Type_free(&subj);
         MPI_Type_free(&subarray);
         MPI_Type_free(&subxzslice);
         MPI_Type_free(&subyzslice);
         MPI_Type_free(&subxyslice);
+        MPI_Type_free(&reducepair);
+        MPI_Op_free(&reduceop);
 
         delete[] profl;
+        delete[] halobuf;
+
+        // complete the loads that have not been used and free their buffers
+        for (size_t n=0; n<loadnames.size(); ++n)
+        {
+#if MPI_VERSION > 3 || (MPI_VERSION == 3 && MPI_SUBVERSION >= 1)
+            MPI_Wait(&loadreqs[n], MPI_STATUS_IGNORE);
+#else
+            MPI_File_read_all_end(loadfiles[n], loadbuffers[n], MPI_STATUS_IGNORE);
+#endif
+            MPI_File_close(&loadfiles[n]);
+            delete[] loadbuffers[n];
+        }
+        for (std::vector<double*>::iterator it=loadpool.begin(); it!=loadpool.end(); ++it)
+            delete[] *it;
+
+        // free the persistent requests
+        for (std::map<double*, std::vector<MPI_Request> >::iterator it=haloreqs.begin(); it!=haloreqs.end(); ++it)
+            free_requests(it->second);
+        free_requests(halobufreqs);
+
+        Request_map* transposereqs[6] = {&zxreqs, &xzreqs, &xyreqs, &yxreqs, &yzreqs, &zyreqs};
+        for (int n=0; n<6; ++n)
+            for (Request_map::iterator it=transposereqs[n]->begin(); it!=transposereqs[n]->end(); ++it)
+                free_requests(it->second);
     }
 }
 
@@ -178,7 +279,17 @@ void Grid::boundary_cyclic(double* restrict data, Edge edge)
 {
     const int ncount = 1;
 
-    if (edge == East_west_edge || edge == Both_edges)
+    // Exchange all edges including the corners in a single step.
+    if (edge == Both_edges)
+    {
+        boundary_cyclic_start(data);
+        boundary_cyclic_end(data);
+        return;
+    }
+
+    master->start_timer("halo");
+
+    if (edge == East_west_edge)
     {
         // Communicate east-west edges.
         const int eastout = iend-igc;
@@ -199,7 +310,7 @@ void Grid::boundary_cyclic(double* restrict data, Edge edge)
         master->wait_all();
     }
 
-    if (edge == North_south_edge || edge == Both_edges)
+    if (edge == North_south_edge)
     {
         // If the run is 3D, perform the cyclic boundary routine for the north-south direction.
         if (jtot > 1)
@@ -240,10 +351,300 @@ void Grid::boundary_cyclic(double* restrict data, Edge edge)
                     }
         }
     }
+
+    master->stop_timer("halo");
+}
+
+void Grid::init_halo_requests(std::vector<MPI_Request>& reqs, double* restrict data)
+{
+    const int ncount = 1;
+    const int jj = icells;
+
+    MPI_Request req;
+
+    // The corners are exchanged with the diagonal neighbors, such that all messages can
+    // be in flight at the same time and no wait is needed between the two directions.
+    // Send and receive the ghost cells in east-west direction.
+    const int eastout = iend-igc + jstart*jj;
+    const int westin  = 0        + jstart*jj;
+    const int westout = istart   + jstart*jj;
+    const int eastin  = iend     + jstart*jj;
+
+    MPI_Send_init(&data[eastout], ncount, eastwestface, master->neast, 1, master->commxy, &req);
+    reqs.push_back(req);
+    MPI_Recv_init(&data[westin], ncount, eastwestface, master->nwest, 1, master->commxy, &req);
+    reqs.push_back(req);
+    MPI_Send_init(&data[westout], ncount, eastwestface, master->nwest, 2, master->commxy, &req);
+    reqs.push_back(req);
+    MPI_Recv_init(&data[eastin], ncount, eastwestface, master->neast, 2, master->commxy, &req);
+    reqs.push_back(req);
+
+    // In case of 2D, the ghost cells in the y-direction are filled in boundary_cyclic_end.
+    if (jtot == 1)
+        return;
+
+    // Send and receive the ghost cells in the north-south direction.
+    const int northout = istart + (jend-jgc)*jj;
+    const int southin  = istart;
+    const int southout = istart + jstart*jj;
+    const int northin  = istart + jend*jj;
+
+    MPI_Send_init(&data[northout], ncount, northsouthface, master->nnorth, 3, master->commxy, &req);
+    reqs.push_back(req);
+    MPI_Recv_init(&data[southin], ncount, northsouthface, master->nsouth, 3, master->commxy, &req);
+    reqs.push_back(req);
+    MPI_Send_init(&data[southout], ncount, northsouthface, master->nsouth, 4, master->commxy, &req);
+    reqs.push_back(req);
+    MPI_Recv_init(&data[northin], ncount, northsouthface, master->nnorth, 4, master->commxy, &req);
+    reqs.push_back(req);
+
+    // Send and receive the corners.
+    const int northeastout = iend-igc + (jend-jgc)*jj;
+    const int southwestin  = 0;
+    const int southwestout = istart   + jstart*jj;
+    const int northeastin  = iend     + jend*jj;
+    const int northwestout = istart   + (jend-jgc)*jj;
+    const int southeastin  = iend;
+    const int southeastout = iend-igc + jstart*jj;
+    const int northwestin  = 0        + jend*jj;
+
+    MPI_Send_init(&data[northeastout], ncount, corneredge, master->nnortheast, 5, master->commxy, &req);
+    reqs.push_back(req);
+    MPI_Recv_init(&data[southwestin], ncount, corneredge, master->nsouthwest, 5, master->commxy, &req);
+    reqs.push_back(req);
+    MPI_Send_init(&data[southwestout], ncount, corneredge, master->nsouthwest, 6, master->commxy, &req);
+    reqs.push_back(req);
+    MPI_Recv_init(&data[northeastin], ncount, corneredge, master->nnortheast, 6, master->commxy, &req);
+    reqs.push_back(req);
+    MPI_Send_init(&data[northwestout], ncount, corneredge, master->nnorthwest, 7, master->commxy, &req);
+    reqs.push_back(req);
+    MPI_Recv_init(&data[southeastin], ncount, corneredge, master->nsoutheast, 7, master->commxy, &req);
+    reqs.push_back(req);
+    MPI_Send_init(&data[southeastout], ncount, corneredge, master->nsoutheast, 8, master->commxy, &req);
+    reqs.push_back(req);
+    MPI_Recv_init(&data[northwestin], ncount, corneredge, master->nnorthwest, 8, master->commxy, &req);
+    reqs.push_back(req);
+}
+
+void Grid::boundary_cyclic_start(double* data)
+{
+    master->start_timer("halo");
+
+    // Create the persistent requests the first time the ghost cells of this field are exchanged.
+    std::vector<MPI_Request>& reqs = haloreqs[data];
+    if (reqs.empty())
+        init_halo_requests(reqs, data);
+
+    MPI_Startall(reqs.size(), &reqs[0]);
+
+    master->stop_timer("halo");
+}
+
+void Grid::boundary_cyclic_end(double* data)
+{
+    master->start_timer("halo");
+
+    std::vector<MPI_Request>& reqs = haloreqs[data];
+    MPI_Waitall(reqs.size(), &reqs[0], MPI_STATUSES_IGNORE);
+
+    // In case of 2D, fill all the ghost cells in the y-direction with the same value.
+    if (jtot == 1)
+    {
+        const int jj = icells;
+        const int kk = icells*jcells;
+
+        for (int k=kstart; k<kend; k++)
+            for (int j=0; j<jgc; j++)
+#pragma ivdep
+                for (int i=0; i<icells; i++)
+                {
+                    const int ijkref   = i + jstart*jj   + k*kk;
+                    const int ijknorth = i + j*jj        + k*kk;
+                    const int ijksouth = i + (jend+j)*jj + k*kk;
+                    data[ijknorth] = data[ijkref];
+                    data[ijksouth] = data[ijkref];
+                }
+    }
+
+    master->stop_timer("halo");
+}
+
+void Grid::start_wait_all(std::vector<MPI_Request>& reqs)
+{
+    MPI_Startall(reqs.size(), &reqs[0]);
+    MPI_Waitall(reqs.size(), &reqs[0], MPI_STATUSES_IGNORE);
+}
+
+void Grid::free_requests(std::vector<MPI_Request>& reqs)
+{
+    for (std::vector<MPI_Request>::iterator it=reqs.begin(); it!=reqs.end(); ++it)
+        MPI_Request_free(&(*it));
+    reqs.clear();
+}
+
+void Grid::pack_halo(double* restrict buf, const double* restrict data,
+                     const int is, const int ni, const int js, const int nj)
+{
+    const int jj = icells;
+    const int kk = icells*jcells;
+
+    for (int k=0; k<kcells; k++)
+        for (int j=0; j<nj; j++)
+#pragma ivdep
+            for (int i=0; i<ni; i++)
+            {
+                const int ijk = i+is + (j+js)*jj + k*kk;
+                const int n   = i + j*ni + k*ni*nj;
+                buf[n] = data[ijk];
+            }
+}
+
+void Grid::unpack_halo(double* restrict data, const double* restrict buf,
+                       const int is, const int ni, const int js, const int nj)
+{
+    const int jj = icells;
+    const int kk = icells*jcells;
+
+    for (int k=0; k<kcells; k++)
+        for (int j=0; j<nj; j++)
+#pragma ivdep
+            for (int i=0; i<ni; i++)
+            {
+                const int ijk = i+is + (j+js)*jj + k*kk;
+                const int n   = i + j*ni + k*ni*nj;
+                data[ijk] = buf[n];
+            }
+}
+
+void Grid::boundary_cyclic_start(const std::vector<double*>& fields)
+{
+    master->start_timer("halo");
+
+    const int nfields = fields.size();
+
+    // The ghost cells of all fields are packed into one buffer per neighbor, the eight
+    // directions are east, west, north, south, northeast, southwest, northwest and southeast.
+    // In case of 2D, only the east-west directions are communicated.
+    const int ndirs = (jtot > 1) ? 8 : 2;
+
+    const int ni[8] = {igc , igc   , imax  , imax  , igc     , igc   , igc   , igc     };
+    const int nj[8] = {jmax, jmax  , jgc   , jgc   , jgc     , jgc   , jgc   , jgc     };
+    const int is[8] = {iend-igc, istart, istart, istart, iend-igc, istart, istart, iend-igc};
+    const int js[8] = {jstart, jstart, jend-jgc, jstart, jend-jgc, jstart, jend-jgc, jstart};
+    const int nout[8] = {master->neast, master->nwest, master->nnorth, master->nsouth,
+                         master->nnortheast, master->nsouthwest, master->nnorthwest, master->nsoutheast};
+    const int nin [8] = {master->nwest, master->neast, master->nsouth, master->nnorth,
+                         master->nsouthwest, master->nnortheast, master->nsoutheast, master->nnorthwest};
+
+    // Make sure the buffers are large enough to hold all fields.
+    int nbuf = 0;
+    for (int d=0; d<ndirs; ++d)
+        nbuf += ni[d]*nj[d]*kcells*nfields;
+
+    // The persistent requests are bound to the buffers, thus they are created again
+    // in case the number of fields changes.
+    if (nfields != nhalofields)
+    {
+        free_requests(halobufreqs);
+
+        if (2*nbuf > nhalobuf)
+        {
+            delete[] halobuf;
+            nhalobuf = 2*nbuf;
+            halobuf  = new double[nhalobuf];
+        }
+
+        double* sendbuf = halobuf;
+        double* recvbuf = &halobuf[nbuf];
+
+        halobufreqs.resize(2*ndirs);
+        int offset = 0;
+        for (int d=0; d<ndirs; ++d)
+        {
+            const int ncount = ni[d]*nj[d]*kcells*nfields;
+            MPI_Recv_init(&recvbuf[offset], ncount, MPI_DOUBLE, nin [d], d+1, master->commxy, &halobufreqs[2*d  ]);
+            MPI_Send_init(&sendbuf[offset], ncount, MPI_DOUBLE, nout[d], d+1, master->commxy, &halobufreqs[2*d+1]);
+            offset += ncount;
+        }
+
+        nhalofields = nfields;
+    }
+
+    // Pack the data per direction and start the communication.
+    double* sendbuf = halobuf;
+    int offset = 0;
+    for (int d=0; d<ndirs; ++d)
+    {
+        const int nblock = ni[d]*nj[d]*kcells;
+        for (int n=0; n<nfields; ++n)
+            pack_halo(&sendbuf[offset + n*nblock], fields[n], is[d], ni[d], js[d], nj[d]);
+        offset += nblock*nfields;
+    }
+
+    MPI_Startall(halobufreqs.size(), &halobufreqs[0]);
+
+    master->stop_timer("halo");
+}
+
+void Grid::boundary_cyclic_end(const std::vector<double*>& fields)
+{
+    master->start_timer("halo");
+
+    const int nfields = fields.size();
+    const int ndirs = (jtot > 1) ? 8 : 2;
+
+    // The receiving ghost cells, in the same order of directions as in boundary_cyclic_start.
+    const int ni[8] = {igc , igc   , imax  , imax  , igc     , igc   , igc   , igc     };
+    const int nj[8] = {jmax, jmax  , jgc   , jgc   , jgc     , jgc   , jgc   , jgc     };
+    const int is[8] = {0     , iend  , istart, istart, 0     , iend  , iend  , 0   };
+    const int js[8] = {jstart, jstart, 0     , jend  , 0     , jend  , 0     , jend};
+
+    MPI_Waitall(halobufreqs.size(), &halobufreqs[0], MPI_STATUSES_IGNORE);
+
+    int nbuf = 0;
+    for (int d=0; d<ndirs; ++d)
+        nbuf += ni[d]*nj[d]*kcells*nfields;
+
+    const double* recvbuf = &halobuf[nbuf];
+    int offset = 0;
+    for (int d=0; d<ndirs; ++d)
+    {
+        const int nblock = ni[d]*nj[d]*kcells;
+        for (int n=0; n<nfields; ++n)
+            unpack_halo(fields[n], &recvbuf[offset + n*nblock], is[d], ni[d], js[d], nj[d]);
+        offset += nblock*nfields;
+    }
+
+    // In case of 2D, fill all the ghost cells in the y-direction with the same value.
+    if (jtot == 1)
+    {
+        const int jj = icells;
+        const int kk = icells*jcells;
+
+        for (int n=0; n<nfields; ++n)
+        {
+            double* restrict data = fields[n];
+            for (int k=kstart; k<kend; k++)
+                for (int j=0; j<jgc; j++)
+#pragma ivdep
+                    for (int i=0; i<icells; i++)
+                    {
+                        const int ijkref   = i + jstart*jj   + k*kk;
+                        const int ijknorth = i + j*jj        + k*kk;
+                        const int ijksouth = i + (jend+j)*jj + k*kk;
+                        data[ijknorth] = data[ijkref];
+                        data[ijksouth] = data[ijkref];
+                    }
+        }
+    }
+
+    master->stop_timer("halo");
 }
 
 void Grid::boundary_cyclic_2d(double* restrict data)
 {
+    master->start_timer("halo");
+
     int ncount = 1;
 
     // communicate east-west edges
@@ -301,6 +702,8 @@ void Grid::boundary_cyclic_2d(double* restrict data)
                 data[ijsouth] = data[ijref];
             }
     }
+
+    master->stop_timer("halo");
 }
 
 void Grid::transpose_zx(double* restrict ar, double* restrict as)
@@ -311,19 +714,26 @@ void Grid::transpose_zx(double* restrict ar, double* restrict as)
     const int jj = imax;
     const int kk = imax*jmax;
 
-    for (int n=0; n<master->npx; n++)
+    // Create the persistent requests the first time this pair of arrays is transposed.
+    std::vector<MPI_Request>& reqs = zxreqs[std::make_pair(ar, as)];
+    if (reqs.empty())
     {
-        // determine where to fetch the data and where to store it
-        const int ijks = n*kblock*kk;
-        const int ijkr = n*jj;
+        reqs.resize(2*master->npx);
+        for (int n=0; n<master->npx; n++)
+        {
+            // determine where to fetch the data and where to store it
+            const int ijks = n*kblock*kk;
+            const int ijkr = n*jj;
 
-        // send and receive the data
-        MPI_Isend(&as[ijks], ncount, transposez, n, tag, master->commx, &master->reqs[master->reqsn]);
-        master->reqsn++;
-        MPI_Irecv(&ar[ijkr], ncount, transposex, n, tag, master->commx, &master->reqs[master->reqsn]);
-        master->reqsn++;
+            // send and receive the data
+            MPI_Send_init(&as[ijks], ncount, transposez, n, tag, master->commx, &reqs[2*n  ]);
+            MPI_Recv_init(&ar[ijkr], ncount, transposex, n, tag, master->commx, &reqs[2*n+1]);
+        }
     }
-    master->wait_all();
+
+    master->start_timer("transpose");
+    start_wait_all(reqs);
+    master->stop_timer("transpose");
 }
 
 void Grid::transpose_xz(double* restrict ar, double* restrict as)
@@ -334,19 +744,26 @@ void Grid::transpose_xz(double* restrict ar, double* restrict as)
     const int jj = imax;
     const int kk = imax*jmax;
 
-    for (int n=0; n<master->npx; n++)
+    // Create the persistent requests the first time this pair of arrays is transposed.
+    std::vector<MPI_Request>& reqs = xzreqs[std::make_pair(ar, as)];
+    if (reqs.empty())
     {
-        // determine where to fetch the data and where to store it
-        const int ijks = n*jj;
-        const int ijkr = n*kblock*kk;
+        reqs.resize(2*master->npx);
+        for (int n=0; n<master->npx; n++)
+        {
+            // determine where to fetch the data and where to store it
+            const int ijks = n*jj;
+            const int ijkr = n*kblock*kk;
 
-        // send and receive the data
-        MPI_Isend(&as[ijks], ncount, transposex, n, tag, master->commx, &master->reqs[master->reqsn]);
-        master->reqsn++;
-        MPI_Irecv(&ar[ijkr], ncount, transposez, n, tag, master->commx, &master->reqs[master->reqsn]);
-        master->reqsn++;
+            // send and receive the data
+            MPI_Send_init(&as[ijks], ncount, transposex, n, tag, master->commx, &reqs[2*n  ]);
+            MPI_Recv_init(&ar[ijkr], ncount, transposez, n, tag, master->commx, &reqs[2*n+1]);
+        }
     }
-    master->wait_all();
+
+    master->start_timer("transpose");
+    start_wait_all(reqs);
+    master->stop_timer("transpose");
 }
 
 void Grid::transpose_xy(double* restrict ar, double* restrict as)
@@ -357,19 +774,26 @@ void Grid::transpose_xy(double* restrict ar, double* restrict as)
     const int jj = iblock;
     const int kk = iblock*jmax;
 
-    for (int n=0; n<master->npy; n++)
+    // Create the persistent requests the first time this pair of arrays is transposed.
+    std::vector<MPI_Request>& reqs = xyreqs[std::make_pair(ar, as)];
+    if (reqs.empty())
     {
-        // determine where to fetch the data and where to store it
-        const int ijks = n*jj;
-        const int ijkr = n*kk;
+        reqs.resize(2*master->npy);
+        for (int n=0; n<master->npy; n++)
+        {
+            // determine where to fetch the data and where to store it
+            const int ijks = n*jj;
+            const int ijkr = n*kk;
 
-        // send and receive the data
-        MPI_Isend(&as[ijks], ncount, transposex2, n, tag, master->commy, &master->reqs[master->reqsn]);
-        master->reqsn++;
-        MPI_Irecv(&ar[ijkr], ncount, transposey , n, tag, master->commy, &master->reqs[master->reqsn]);
-        master->reqsn++;
+            // send and receive the data
+            MPI_Send_init(&as[ijks], ncount, transposex2, n, tag, master->commy, &reqs[2*n  ]);
+            MPI_Recv_init(&ar[ijkr], ncount, transposey, n, tag, master->commy, &reqs[2*n+1]);
+        }
     }
-    master->wait_all();
+
+    master->start_timer("transpose");
+    start_wait_all(reqs);
+    master->stop_timer("transpose");
 }
 
 void Grid::transpose_yx(double* restrict ar, double* restrict as)
@@ -380,19 +804,26 @@ void Grid::transpose_yx(double* restrict ar, double* restrict as)
     const int jj = iblock;
     const int kk = iblock*jmax;
 
-    for (int n=0; n<master->npy; n++)
+    // Create the persistent requests the first time this pair of arrays is transposed.
+    std::vector<MPI_Request>& reqs = yxreqs[std::make_pair(ar, as)];
+    if (reqs.empty())
     {
-        // determine where to fetch the data and where to store it
-        const int ijks = n*kk;
-        const int ijkr = n*jj;
+        reqs.resize(2*master->npy);
+        for (int n=0; n<master->npy; n++)
+        {
+            // determine where to fetch the data and where to store it
+            const int ijks = n*kk;
+            const int ijkr = n*jj;
 
-        // send and receive the data
-        MPI_Isend(&as[ijks], ncount, transposey , n, tag, master->commy, &master->reqs[master->reqsn]);
-        master->reqsn++;
-        MPI_Irecv(&ar[ijkr], ncount, transposex2, n, tag, master->commy, &master->reqs[master->reqsn]);
-        master->reqsn++;
+            // send and receive the data
+            MPI_Send_init(&as[ijks], ncount, transposey, n, tag, master->commy, &reqs[2*n  ]);
+            MPI_Recv_init(&ar[ijkr], ncount, transposex2, n, tag, master->commy, &reqs[2*n+1]);
+        }
     }
-    master->wait_all();
+
+    master->start_timer("transpose");
+    start_wait_all(reqs);
+    master->stop_timer("transpose");
 }
 
 void Grid::transpose_yz(double* restrict ar, double* restrict as)
@@ -403,19 +834,26 @@ void Grid::transpose_yz(double* restrict ar, double* restrict as)
     const int jj = iblock;
     const int kk = iblock*jblock;
 
-    for (int n=0; n<master->npx; n++)
+    // Create the persistent requests the first time this pair of arrays is transposed.
+    std::vector<MPI_Request>& reqs = yzreqs[std::make_pair(ar, as)];
+    if (reqs.empty())
     {
-        // determine where to fetch the data and where to store it
-        const int ijks = n*jblock*jj;
-        const int ijkr = n*kblock*kk;
+        reqs.resize(2*master->npx);
+        for (int n=0; n<master->npx; n++)
+        {
+            // determine where to fetch the data and where to store it
+            const int ijks = n*jblock*jj;
+            const int ijkr = n*kblock*kk;
 
-        // send and receive the data
-        MPI_Isend(&as[ijks], ncount, transposey2, n, tag, master->commx, &master->reqs[master->reqsn]);
-        master->reqsn++;
-        MPI_Irecv(&ar[ijkr], ncount, transposez2, n, tag, master->commx, &master->reqs[master->reqsn]);
-        master->reqsn++;
+            // send and receive the data
+            MPI_Send_init(&as[ijks], ncount, transposey2, n, tag, master->commx, &reqs[2*n  ]);
+            MPI_Recv_init(&ar[ijkr], ncount, transposez2, n, tag, master->commx, &reqs[2*n+1]);
+        }
     }
-    master->wait_all();
+
+    master->start_timer("transpose");
+    start_wait_all(reqs);
+    master->stop_timer("transpose");
 }
 
 void Grid::transpose_zy(double* restrict ar, double* restrict as)
@@ -426,29 +864,42 @@ void Grid::transpose_zy(double* restrict ar, double* restrict as)
     const int jj = iblock;
     const int kk = iblock*jblock;
 
-    for (int n=0; n<master->npx; n++)
+    // Create the persistent requests the first time this pair of arrays is transposed.
+    std::vector<MPI_Request>& reqs = zyreqs[std::make_pair(ar, as)];
+    if (reqs.empty())
     {
-        // determine where to fetch the data and where to store it
-        const int ijks = n*kblock*kk;
-        const int ijkr = n*jblock*jj;
+        reqs.resize(2*master->npx);
+        for (int n=0; n<master->npx; n++)
+        {
+            // determine where to fetch the data and where to store it
+            const int ijks = n*kblock*kk;
+            const int ijkr = n*jblock*jj;
 
-        // send and receive the data
-        MPI_Isend(&as[ijks], ncount, transposez2, n, tag, master->commx, &master->reqs[master->reqsn]);
-        master->reqsn++;
-        MPI_Irecv(&ar[ijkr], ncount, transposey2, n, tag, master->commx, &master->reqs[master->reqsn]);
-        master->reqsn++;
+            // send and receive the data
+            MPI_Send_init(&as[ijks], ncount, transposez2, n, tag, master->commx, &reqs[2*n  ]);
+            MPI_Recv_init(&ar[ijkr], ncount, transposey2, n, tag, master->commx, &reqs[2*n+1]);
+        }
     }
-    master->wait_all();
+
+    master->start_timer("transpose");
+    start_wait_all(reqs);
+    master->stop_timer("transpose");
 }
 
 void Grid::get_max(double *var)
 {
+    if (deferreductions)
+        return;
+
     double varl = *var;
     MPI_Allreduce(&varl, var, 1, MPI_DOUBLE, MPI_MAX, master->commxy);
 }
 
 void Grid::get_sum(double *var)
 {
+    if (deferreductions)
+        return;
+
     double varl = *var;
     MPI_Allreduce(&varl, var, 1, MPI_DOUBLE, MPI_SUM, master->commxy);
 }
@@ -461,6 +912,37 @@ void Grid::get_prof(double *prof, int kcellsin)
     MPI_Allreduce(profl, prof, kcellsin, MPI_DOUBLE, MPI_SUM, master->commxy);
 }
 
+void Grid::get_min(unsigned long *var, int nvar)
+{
+    std::vector<unsigned long> varl(var, var+nvar);
+    MPI_Allreduce(&varl[0], var, nvar, MPI_UNSIGNED_LONG, MPI_MIN, master->commxy);
+}
+
+void Grid::exec_reductions()
+{
+    const int nvar = reducevars.size();
+
+    if (nvar > 0)
+    {
+        std::vector<double> sendbuf(2*nvar);
+        std::vector<double> recvbuf(2*nvar);
+
+        for (int n=0; n<nvar; ++n)
+        {
+            sendbuf[2*n  ] = reduceops[n];
+            sendbuf[2*n+1] = *reducevars[n];
+        }
+
+        MPI_Allreduce(&sendbuf[0], &recvbuf[0], nvar, reducepair, reduceop, master->commxy);
+
+        for (int n=0; n<nvar; ++n)
+            *reducevars[n] = recvbuf[2*n+1];
+    }
+
+    reducevars.clear();
+    reduceops.clear();
+}
+
 // IO functions
 void Grid::save()
 {
@@ -519,28 +1001,9 @@ void Grid::save()
     master->print_message("OK\n");
 
     // SAVE THE FFTW PLAN IN ORDER TO ENSURE BITWISE IDENTICAL RESTARTS
-    // use the FFTW3 many interface in order to reduce function call overhead
-    int rank = 1;
-    int ni[] = {itot};
-    int nj[] = {jtot};
-    int istride = 1;
-    int jstride = iblock;
-    int idist = itot;
-    int jdist = 1;
-
-    fftw_r2r_kind kindf[] = {FFTW_R2HC};
-    fftw_r2r_kind kindb[] = {FFTW_HC2R};
-
-    iplanf = fftw_plan_many_r2r(rank, ni, jmax, fftini, ni, istride, idist,
-                                fftouti, ni, istride, idist, kindf, FFTW_EXHAUSTIVE);
-    iplanb = fftw_plan_many_r2r(rank, ni, jmax, fftini, ni, istride, idist,
-                                fftouti, ni, istride, idist, kindb, FFTW_EXHAUSTIVE);
-    jplanf = fftw_plan_many_r2r(rank, nj, iblock, fftinj, nj, jstride, jdist,
-                                fftoutj, nj, jstride, jdist, kindf, FFTW_EXHAUSTIVE);
-    jplanb = fftw_plan_many_r2r(rank, nj, iblock, fftinj, nj, jstride, jdist,
-                                fftoutj, nj, jstride, jdist, kindb, FFTW_EXHAUSTIVE);
-
-    fftwplan = true;
+    // start from the wisdom cache if available, to avoid planning a known grid again
+    import_wisdom_cache();
+    create_fftw_plans();
 
     if (master->mpiid == 0)
     {
@@ -557,6 +1020,8 @@ void Grid::save()
         }
         else
             master->print_message("OK\n");
+
+        export_wisdom_cache();
     }
 }
 
@@ -617,31 +1082,13 @@ void Grid::load()
     else
         master->print_message("OK\n");
 
-    // use the FFTW3 many interface in order to reduce function call overhead
-    int rank = 1;
-    int ni[] = {itot};
-    int nj[] = {jtot};
-    int istride = 1;
-    int jstride = iblock;
-    int idist = itot;
-    int jdist = 1;
-    fftw_r2r_kind kindf[] = {FFTW_R2HC};
-    fftw_r2r_kind kindb[] = {FFTW_HC2R};
-    iplanf = fftw_plan_many_r2r(rank, ni, jmax, fftini, ni, istride, idist,
-                                fftouti, ni, istride, idist, kindf, FFTW_EXHAUSTIVE);
-    iplanb = fftw_plan_many_r2r(rank, ni, jmax, fftini, ni, istride, idist,
-                                fftouti, ni, istride, idist, kindb, FFTW_EXHAUSTIVE);
-    jplanf = fftw_plan_many_r2r(rank, nj, iblock, fftinj, nj, jstride, jdist,
-                                fftoutj, nj, jstride, jdist, kindf, FFTW_EXHAUSTIVE);
-    jplanb = fftw_plan_many_r2r(rank, nj, iblock, fftinj, nj, jstride, jdist,
-                                fftoutj, nj, jstride, jdist, kindb, FFTW_EXHAUSTIVE);
-
-    fftwplan = true;
+    create_fftw_plans();
 
     fftw_forget_wisdom();
 }
 
-int Grid::save_field3d(double* restrict data, double* restrict tmp1, double* restrict tmp2, char* filename, double offset)
+int Grid::save_field3d(double* restrict data, double* restrict tmp1, double* restrict tmp2, char* filename, double offset,
+                       bool header)
 {
     // save the data in transposed order to have large chunks of contiguous disk space
     // MPI-IO is not stable on Juqueen and supermuc otherwise
@@ -674,6 +1121,13 @@ int Grid::save_field3d(double* restrict data, double* restrict tmp1, double* res
     MPI_Offset fileoff = 0; // the offset within the file (header size)
     char name[] = "native";
 
+    if (header)
+    {
+        fileoff = field3dheaderlength*sizeof(int);
+        if (write_field3d_header(fh))
+            return 1;
+    }
+
     if (MPI_File_set_view(fh, fileoff, MPI_DOUBLE, subarray, name, MPI_INFO_NULL))
         return 1;
 
@@ -686,38 +1140,42 @@ int Grid::save_field3d(double* restrict data, double* restrict tmp1, double* res
     return 0;
 }
 
-int Grid::load_field3d(double* restrict data, double* restrict tmp1, double* restrict tmp2, char* filename, double offset)
+/**
+ * This function writes the header of a 3d field from the master process.
+ */
+int Grid::write_field3d_header(MPI_File fh)
 {
-    // save the data in transposed order to have large chunks of contiguous disk space
-    // MPI-IO is not stable on Juqueen and supermuc otherwise
-
-    // read the file
-    MPI_File fh;
-    if (MPI_File_open(master->commxy, filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh))
-        return 1;
-
-    // select noncontiguous part of 3d array to store the selected data
-    MPI_Offset fileoff = 0; // the offset within the file (header size)
-    char name[] = "native";
-    MPI_File_set_view(fh, fileoff, MPI_DOUBLE, subarray, name, MPI_INFO_NULL);
-
-    // extract the data from the 3d field without the ghost cells
-    int count = imax*jmax*kmax;
+    int nerror = 0;
 
-    if (MPI_File_read_all(fh, tmp1, count, MPI_DOUBLE, MPI_STATUS_IGNORE))
-        return 1;
+    if (master->mpiid == 0)
+    {
+        int header[field3dheaderlength];
+        set_field3d_header(header);
+        if (MPI_File_write_at(fh, 0, header, field3dheaderlength, MPI_INT, MPI_STATUS_IGNORE))
+            ++nerror;
+    }
 
-    if (MPI_File_close(&fh))
-        return 1;
+    master->broadcast(&nerror, 1);
 
-    // transpose the data back
-    transpose_xz(tmp2, tmp1);
+    return nerror;
+}
 
+/**
+ * This function starts the saving of a 3d field with a nonblocking collective write, such that
+ * the model can continue while the data is written. The data is transposed into tmp2, which is
+ * written to disk and thus has to remain untouched until save_field3d_end has been called.
+ */
+int Grid::save_field3d_start(double* restrict data, double* restrict tmp1, double* tmp2, char* filename, double offset,
+                             bool header)
+{
+    // extract the data from the 3d field without the ghost cells
     const int jj  = icells;
     const int kk  = icells*jcells;
     const int jjb = imax;
     const int kkb = imax*jmax;
 
+    int count = imax*jmax*kmax;
+
     for (int k=0; k<kmax; k++)
         for (int j=0; j<jmax; j++)
 #pragma ivdep
@@ -725,47 +1183,506 @@ int Grid::load_field3d(double* restrict data, double* restrict tmp1, double* res
             {
                 const int ijk  = i+igc + (j+jgc)*jj + (k+kgc)*kk;
                 const int ijkb = i + j*jjb + k*kkb;
-                data[ijk] = tmp2[ijkb] - offset;
+                tmp1[ijkb] = data[ijk] + offset;
             }
 
-    return 0;
-}
+    transpose_zx(tmp2, tmp1);
 
-void Grid::fft_forward(double* restrict data,   double* restrict tmp1,
-                       double* restrict fftini, double* restrict fftouti,
-                       double* restrict fftinj, double* restrict fftoutj)
-{
-    // transpose the pressure field
-    transpose_zx(tmp1,data);
+    MPI_File fh;
+    if (MPI_File_open(master->commxy, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY | MPI_MODE_EXCL, MPI_INFO_NULL, &fh))
+        return 1;
 
-    int kk = itot*jmax;
+    MPI_Offset fileoff = 0;
+    char name[] = "native";
 
-    // process the fourier transforms slice by slice
-    for (int k=0; k<kblock; k++)
+    // The header is small and is written directly, only the data is written in the background.
+    if (header)
     {
-#pragma ivdep
-        for (int n=0; n<itot*jmax; n++)
-        {
-            const int ij  = n;
-            const int ijk = n + k*kk;
-            fftini[ij] = tmp1[ijk];
-        }
-
-        fftw_execute(iplanf);
-
-#pragma ivdep
-        for (int n=0; n<itot*jmax; n++)
-        {
-            const int ij  = n;
-            const int ijk = n + k*kk;
-            tmp1[ijk] = fftouti[ij];
-        }
+        fileoff = field3dheaderlength*sizeof(int);
+        if (write_field3d_header(fh))
+            return 1;
     }
 
-    // transpose again
-    transpose_xy(data,tmp1);
-
-    kk = iblock*jtot;
+    if (MPI_File_set_view(fh, fileoff, MPI_DOUBLE, subarray, name, MPI_INFO_NULL))
+        return 1;
+
+    // Nonblocking collective writes are available from MPI 3.1 on, use a split collective otherwise.
+    MPI_Request req = MPI_REQUEST_NULL;
+#if MPI_VERSION > 3 || (MPI_VERSION == 3 && MPI_SUBVERSION >= 1)
+    if (MPI_File_iwrite_all(fh, tmp2, count, MPI_DOUBLE, &req))
+        return 1;
+#else
+    if (MPI_File_write_all_begin(fh, tmp2, count, MPI_DOUBLE))
+        return 1;
+#endif
+
+    savefiles  .push_back(fh);
+    savereqs   .push_back(req);
+    savebuffers.push_back(tmp2);
+
+    return 0;
+}
+
+int Grid::save_field3d_end()
+{
+    int nerror = 0;
+
+    for (size_t n=0; n<savefiles.size(); ++n)
+    {
+#if MPI_VERSION > 3 || (MPI_VERSION == 3 && MPI_SUBVERSION >= 1)
+        if (MPI_Wait(&savereqs[n], MPI_STATUS_IGNORE))
+            ++nerror;
+#else
+        if (MPI_File_write_all_end(savefiles[n], savebuffers[n], MPI_STATUS_IGNORE))
+            ++nerror;
+#endif
+
+        if (MPI_File_close(&savefiles[n]))
+            ++nerror;
+    }
+
+    savefiles  .clear();
+    savereqs   .clear();
+    savebuffers.clear();
+
+    return (nerror > 0);
+}
+
+/**
+ * This function saves a 3d field as (data-offset)*scale, in single precision if requested, and compressed
+ * without loss if requested. The file starts with a header that describes the grid and the format, followed by
+ * the offset and scale as doubles. In case of compression, these are followed by the number of blocks and the
+ * size in bytes of each block as 64-bit integers. Each level of the transposed field is split into one block
+ * per process in the y-direction, such that the blocks are in the same order as the uncompressed field.
+ */
+int Grid::save_field3d_packed(double* restrict data, double* restrict tmp1, double* restrict tmp2, char* filename,
+                              double offset, double scale, bool single, bool compress)
+{
+    // extract the data from the 3d field without the ghost cells
+    const int jj  = icells;
+    const int kk  = icells*jcells;
+    const int jjb = imax;
+    const int kkb = imax*jmax;
+
+    int count = imax*jmax*kmax;
+
+    for (int k=0; k<kmax; k++)
+        for (int j=0; j<jmax; j++)
+#pragma ivdep
+            for (int i=0; i<imax; i++)
+            {
+                const int ijk  = i+igc + (j+jgc)*jj + (k+kgc)*kk;
+                const int ijkb = i + j*jjb + k*kkb;
+                tmp1[ijkb] = (data[ijk] - offset)*scale;
+            }
+
+    transpose_zx(tmp2, tmp1);
+
+    // convert the data to single precision in tmp1, which is free after the transpose
+    const int typesize = single ? sizeof(float) : sizeof(double);
+    unsigned char* buffer = reinterpret_cast<unsigned char*>(tmp2);
+
+    if (single)
+    {
+        float* tmp1f = reinterpret_cast<float*>(tmp1);
+        for (int n=0; n<count; ++n)
+            tmp1f[n] = static_cast<float>(tmp2[n]);
+        buffer = reinterpret_cast<unsigned char*>(tmp1);
+    }
+
+    MPI_File fh;
+    if (MPI_File_open(master->commxy, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY | MPI_MODE_EXCL, MPI_INFO_NULL, &fh))
+        return 1;
+
+    int nerror = 0;
+
+    int header[field3dheaderlength];
+    set_field3d_packed_header(header, single, compress);
+    const double packing[2] = {offset, scale};
+    const MPI_Offset headersize = sizeof(header) + sizeof(packing);
+
+    if (master->mpiid == 0)
+    {
+        if (MPI_File_write_at(fh, 0, header, field3dheaderlength, MPI_INT, MPI_STATUS_IGNORE))
+            ++nerror;
+        if (MPI_File_write_at(fh, sizeof(header), packing, 2, MPI_DOUBLE, MPI_STATUS_IGNORE))
+            ++nerror;
+    }
+
+    if (!compress)
+    {
+        // select the same part of the 3d array as for the double precision fields
+        MPI_Datatype etype = single ? MPI_FLOAT : MPI_DOUBLE;
+        MPI_Datatype subarraypacked;
+
+        int totsize [3] = {kmax  , jtot, itot};
+        int subsize [3] = {kblock, jmax, itot};
+        int substart[3] = {master->mpicoordx*kblock, master->mpicoordy*jmax, 0};
+        MPI_Type_create_subarray(3, totsize, subsize, substart, MPI_ORDER_C, etype, &subarraypacked);
+        MPI_Type_commit(&subarraypacked);
+
+        char name[] = "native";
+        if (MPI_File_set_view(fh, headersize, etype, subarraypacked, name, MPI_INFO_NULL))
+            ++nerror;
+
+        if (MPI_File_write_all(fh, buffer, count, etype, MPI_STATUS_IGNORE))
+            ++nerror;
+
+        MPI_Type_free(&subarraypacked);
+    }
+    else
+    {
+        const int nblocks = kmax*master->npy;
+        const int nvalues = itot*jmax;
+
+        std::vector< std::vector<unsigned char> > blocks(kblock);
+        std::vector<uint64_t> blocksizes(nblocks, 0);
+
+        for (int k=0; k<kblock; ++k)
+        {
+            nerror += compress_block(blocks[k], &buffer[k*nvalues*typesize], nvalues, typesize);
+            const int n = (master->mpicoordx*kblock + k)*master->npy + master->mpicoordy;
+            blocksizes[n] = blocks[k].size();
+        }
+
+        // share the sizes of all blocks to compute their position in the file
+        MPI_Allreduce(MPI_IN_PLACE, &blocksizes[0], nblocks, MPI_UINT64_T, MPI_SUM, master->commxy);
+
+        if (master->mpiid == 0)
+        {
+            const uint64_t nblocks64 = nblocks;
+            if (MPI_File_write_at(fh, headersize, &nblocks64, 1, MPI_UINT64_T, MPI_STATUS_IGNORE))
+                ++nerror;
+            if (MPI_File_write_at(fh, headersize+sizeof(uint64_t), &blocksizes[0], nblocks, MPI_UINT64_T, MPI_STATUS_IGNORE))
+                ++nerror;
+        }
+
+        std::vector<MPI_Offset> blockoffsets(nblocks);
+        MPI_Offset fileoff = headersize + (nblocks+1)*sizeof(uint64_t);
+        for (int n=0; n<nblocks; ++n)
+        {
+            blockoffsets[n] = fileoff;
+            fileoff += blocksizes[n];
+        }
+
+        for (int k=0; k<kblock; ++k)
+        {
+            const int n = (master->mpicoordx*kblock + k)*master->npy + master->mpicoordy;
+            if (MPI_File_write_at_all(fh, blockoffsets[n], &blocks[k][0], blocks[k].size(), MPI_BYTE, MPI_STATUS_IGNORE))
+                ++nerror;
+        }
+    }
+
+    if (MPI_File_close(&fh))
+        ++nerror;
+
+    // Gather errors from other processes
+    master->sum(&nerror, 1);
+
+    return (nerror > 0);
+}
+
+/**
+ * This function saves a region of a 3d field, averaged over blocks of cells. The region is given as global
+ * indices without ghost cells, of which the start and the size are multiples of the block size. The blocks
+ * do not cross the boundaries of the subdomains, thus every process averages its own part of the region.
+ * Only the processes that contain a part of the region write to the file.
+ */
+int Grid::save_field3d_sub(double* restrict data, double* restrict tmp1, char* filename, double offset,
+                           const int region[6], const int coarse[3], const int loc[3])
+{
+    // find the part of the region in this subdomain
+    const int is = std::max(region[0], master->mpicoordx*imax);
+    const int ie = std::min(region[1], master->mpicoordx*imax + imax);
+    const int js = std::max(region[2], master->mpicoordy*jmax);
+    const int je = std::min(region[3], master->mpicoordy*jmax + jmax);
+
+    const bool hasdata = (ie > is && je > js);
+
+    MPI_Comm commsub;
+    MPI_Comm_split(master->commxy, hasdata ? 1 : MPI_UNDEFINED, master->mpiid, &commsub);
+
+    int nerror = 0;
+
+    if (hasdata)
+    {
+        const int range[6] = {is-master->mpicoordx*imax+igc, ie-master->mpicoordx*imax+igc,
+                              js-master->mpicoordy*jmax+jgc, je-master->mpicoordy*jmax+jgc,
+                              region[4]+kgc, region[5]+kgc};
+        calc_coarse_block(tmp1, data, offset, range, coarse, loc);
+
+        int totsize [3] = {(region[5]-region[4])/coarse[2], (region[3]-region[2])/coarse[1], (region[1]-region[0])/coarse[0]};
+        int subsize [3] = {totsize[0], (je-js)/coarse[1], (ie-is)/coarse[0]};
+        int substart[3] = {0, (js-region[2])/coarse[1], (is-region[0])/coarse[0]};
+
+        MPI_Datatype subarraysub;
+        MPI_Type_create_subarray(3, totsize, subsize, substart, MPI_ORDER_C, MPI_DOUBLE, &subarraysub);
+        MPI_Type_commit(&subarraysub);
+
+        MPI_File fh;
+        if (MPI_File_open(commsub, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY | MPI_MODE_EXCL, MPI_INFO_NULL, &fh))
+            ++nerror;
+        else
+        {
+            char name[] = "native";
+            if (MPI_File_set_view(fh, 0, MPI_DOUBLE, subarraysub, name, MPI_INFO_NULL))
+                ++nerror;
+
+            const int count = subsize[0]*subsize[1]*subsize[2];
+            if (MPI_File_write_all(fh, tmp1, count, MPI_DOUBLE, MPI_STATUS_IGNORE))
+                ++nerror;
+
+            if (MPI_File_close(&fh))
+                ++nerror;
+        }
+
+        MPI_Type_free(&subarraysub);
+        MPI_Comm_free(&commsub);
+    }
+
+    // Gather errors from other processes
+    master->sum(&nerror, 1);
+
+    return (nerror > 0);
+}
+
+void Grid::progress_field3d_save()
+{
+    // Testing the requests drives the progress of the writes in most MPI libraries.
+    if (savereqs.empty())
+        return;
+
+    int flag;
+    MPI_Testall(savereqs.size(), &savereqs[0], &flag, MPI_STATUSES_IGNORE);
+}
+
+void Grid::progress_field3d_load()
+{
+    // Testing the requests drives the progress of the reads in most MPI libraries.
+    if (loadreqs.empty())
+        return;
+
+    int flag;
+    MPI_Testall(loadreqs.size(), &loadreqs[0], &flag, MPI_STATUSES_IGNORE);
+}
+
+/**
+ * This function starts reading a 3d field with a nonblocking collective read into a buffer of the grid,
+ * such that the model can continue while the data is read. The field is stored in its final place
+ * by load_field3d_end.
+ */
+int Grid::load_field3d_start(char* filename)
+{
+    MPI_File fh;
+    if (MPI_File_open(master->commxy, filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh))
+        return 1;
+
+    int header[field3dheaderlength] = {0};
+    MPI_Offset filesize;
+    MPI_File_get_size(fh, &filesize);
+    if (filesize >= (MPI_Offset)sizeof(header))
+        MPI_File_read_at_all(fh, 0, header, field3dheaderlength, MPI_INT, MPI_STATUS_IGNORE);
+
+    long long dataoffset;
+    if (check_field3d_header(header, filesize, &dataoffset, filename))
+    {
+        MPI_File_close(&fh);
+        return 1;
+    }
+
+    char name[] = "native";
+    if (MPI_File_set_view(fh, dataoffset, MPI_DOUBLE, subarray, name, MPI_INFO_NULL))
+    {
+        MPI_File_close(&fh);
+        return 1;
+    }
+
+    // reuse the buffer of a completed load if available
+    double* buffer;
+    if (loadpool.empty())
+        buffer = new double[ncells];
+    else
+    {
+        buffer = loadpool.back();
+        loadpool.pop_back();
+    }
+
+    int count = imax*jmax*kmax;
+
+    // Nonblocking collective reads are available from MPI 3.1 on, use a split collective otherwise.
+    MPI_Request req = MPI_REQUEST_NULL;
+#if MPI_VERSION > 3 || (MPI_VERSION == 3 && MPI_SUBVERSION >= 1)
+    if (MPI_File_iread_all(fh, buffer, count, MPI_DOUBLE, &req))
+#else
+    if (MPI_File_read_all_begin(fh, buffer, count, MPI_DOUBLE))
+#endif
+    {
+        loadpool.push_back(buffer);
+        MPI_File_close(&fh);
+        return 1;
+    }
+
+    loadfiles  .push_back(fh);
+    loadreqs   .push_back(req);
+    loadbuffers.push_back(buffer);
+    loadnames  .push_back(filename);
+
+    return 0;
+}
+
+int Grid::load_field3d_end(double* restrict data, double* restrict tmp1, double* restrict tmp2, char* filename, double offset)
+{
+    const int n = std::find(loadnames.begin(), loadnames.end(), filename) - loadnames.begin();
+    if (n == (int)loadnames.size())
+        return load_field3d(data, tmp1, tmp2, filename, offset);
+
+    double* buffer = loadbuffers[n];
+    int nerror = 0;
+
+#if MPI_VERSION > 3 || (MPI_VERSION == 3 && MPI_SUBVERSION >= 1)
+    if (MPI_Wait(&loadreqs[n], MPI_STATUS_IGNORE))
+        ++nerror;
+#else
+    if (MPI_File_read_all_end(loadfiles[n], buffer, MPI_STATUS_IGNORE))
+        ++nerror;
+#endif
+
+    if (MPI_File_close(&loadfiles[n]))
+        ++nerror;
+
+    loadfiles  .erase(loadfiles  .begin() + n);
+    loadreqs   .erase(loadreqs   .begin() + n);
+    loadbuffers.erase(loadbuffers.begin() + n);
+    loadnames  .erase(loadnames  .begin() + n);
+
+    loadpool.push_back(buffer);
+
+    if (nerror)
+        return 1;
+
+    // transpose the data back
+    transpose_xz(tmp1, buffer);
+
+    const int jj  = icells;
+    const int kk  = icells*jcells;
+    const int jjb = imax;
+    const int kkb = imax*jmax;
+
+    for (int k=0; k<kmax; k++)
+        for (int j=0; j<jmax; j++)
+#pragma ivdep
+            for (int i=0; i<imax; i++)
+            {
+                const int ijk  = i+igc + (j+jgc)*jj + (k+kgc)*kk;
+                const int ijkb = i + j*jjb + k*kkb;
+                data[ijk] = tmp1[ijkb] - offset;
+            }
+
+    return 0;
+}
+
+int Grid::load_field3d(double* restrict data, double* restrict tmp1, double* restrict tmp2, char* filename, double offset)
+{
+    // save the data in transposed order to have large chunks of contiguous disk space
+    // MPI-IO is not stable on Juqueen and supermuc otherwise
+
+    // read the file
+    MPI_File fh;
+    if (MPI_File_open(master->commxy, filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh))
+        return 1;
+
+    // read the header, which is ignored for files without header as their size matches the grid
+    int header[field3dheaderlength] = {0};
+    MPI_Offset filesize;
+    MPI_File_get_size(fh, &filesize);
+    if (filesize >= (MPI_Offset)sizeof(header))
+        MPI_File_read_at_all(fh, 0, header, field3dheaderlength, MPI_INT, MPI_STATUS_IGNORE);
+
+    long long dataoffset;
+    if (check_field3d_header(header, filesize, &dataoffset, filename))
+    {
+        MPI_File_close(&fh);
+        return 1;
+    }
+
+    // select noncontiguous part of 3d array to store the selected data, the file view maps
+    // the full domain onto the subdomain of this process, thus the field is redistributed
+    // over any decomposition of the processes
+    MPI_Offset fileoff = dataoffset; // the offset within the file (header size)
+    char name[] = "native";
+    MPI_File_set_view(fh, fileoff, MPI_DOUBLE, subarray, name, MPI_INFO_NULL);
+
+    // extract the data from the 3d field without the ghost cells
+    int count = imax*jmax*kmax;
+
+    if (MPI_File_read_all(fh, tmp1, count, MPI_DOUBLE, MPI_STATUS_IGNORE))
+        return 1;
+
+    if (MPI_File_close(&fh))
+        return 1;
+
+    // transpose the data back
+    transpose_xz(tmp2, tmp1);
+
+    const int jj  = icells;
+    const int kk  = icells*jcells;
+    const int jjb = imax;
+    const int kkb = imax*jmax;
+
+    for (int k=0; k<kmax; k++)
+        for (int j=0; j<jmax; j++)
+#pragma ivdep
+            for (int i=0; i<imax; i++)
+            {
+                const int ijk  = i+igc + (j+jgc)*jj + (k+kgc)*kk;
+                const int ijkb = i + j*jjb + k*kkb;
+                data[ijk] = tmp2[ijkb] - offset;
+            }
+
+    return 0;
+}
+
+void Grid::fft_forward(double* restrict data,   double* restrict tmp1,   double* restrict tmp2,
+                       double* restrict fftini, double* restrict fftouti,
+                       double* restrict fftinj, double* restrict fftoutj)
+{
+    if (fftchunk > 0)
+    {
+        fft_forward_pipelined(data, tmp1, tmp2, fftini, fftouti, fftinj, fftoutj);
+        return;
+    }
+
+    // transpose the pressure field
+    transpose_zx(tmp1,data);
+
+    int kk = itot*jmax;
+
+    // process the fourier transforms slice by slice
+    for (int k=0; k<kblock; k++)
+    {
+#pragma ivdep
+        for (int n=0; n<itot*jmax; n++)
+        {
+            const int ij  = n;
+            const int ijk = n + k*kk;
+            fftini[ij] = tmp1[ijk];
+        }
+
+        fftw_execute(iplanf);
+
+#pragma ivdep
+        for (int n=0; n<itot*jmax; n++)
+        {
+            const int ij  = n;
+            const int ijk = n + k*kk;
+            tmp1[ijk] = fftouti[ij];
+        }
+    }
+
+    // transpose again
+    transpose_xy(data,tmp1);
+
+    kk = iblock*jtot;
 
     // do the second fourier transform
     for (int k=0; k<kblock; k++)
@@ -794,10 +1711,16 @@ void Grid::fft_forward(double* restrict data,   double* restrict tmp1,
     transpose_yz(data,tmp1);
 }
 
-void Grid::fft_backward(double* restrict data,   double* restrict tmp1,
+void Grid::fft_backward(double* restrict data,   double* restrict tmp1,   double* restrict tmp2,
                         double* restrict fftini, double* restrict fftouti,
                         double* restrict fftinj, double* restrict fftoutj)
 {
+    if (fftchunk > 0)
+    {
+        fft_backward_pipelined(data, tmp1, tmp2, fftini, fftouti, fftinj, fftoutj);
+        return;
+    }
+
     // transpose back to y
     transpose_zy(tmp1, data);
 
@@ -857,6 +1780,235 @@ void Grid::fft_backward(double* restrict data,   double* restrict tmp1,
     transpose_xz(tmp1, data);
 }
 
+/**
+ * Forward fast-fourier transform with the transposes split into chunks of fftchunk levels.
+ * The transform of a chunk starts as soon as its data has arrived and its result is sent
+ * on directly, such that the communication of the other chunks overlaps with the FFTs.
+ * The x-transforms are done in tmp1, the y-transforms in tmp2 and the result ends in data.
+ */
+void Grid::fft_forward_pipelined(double* restrict data,   double* restrict tmp1,   double* restrict tmp2,
+                                 double* restrict fftini, double* restrict fftouti,
+                                 double* restrict fftinj, double* restrict fftoutj)
+{
+    const int npx = master->npx;
+    const int npy = master->npy;
+    const int nchunk = kblock / fftchunk;
+
+    std::vector<MPI_Request> zxsend(nchunk*npx), zxrecv(nchunk*npx);
+    std::vector<MPI_Request> xysend(nchunk*npy), xyrecv(nchunk*npy);
+    std::vector<MPI_Request> yzsend(nchunk*npx), yzrecv(nchunk*npx);
+
+    // post the zx-transposes of all chunks
+    for (int c=0; c<nchunk; c++)
+    {
+        const int k0 = c*fftchunk;
+        for (int n=0; n<npx; n++)
+        {
+            const int ijks = n*kblock*imax*jmax + k0*imax*jmax;
+            const int ijkr = n*imax + k0*itot*jmax;
+            MPI_Isend(&data[ijks], 1, transposezchunk, n, c, master->commx, &zxsend[c*npx+n]);
+            MPI_Irecv(&tmp1[ijkr], 1, transposexchunk, n, c, master->commx, &zxrecv[c*npx+n]);
+        }
+    }
+
+    int kk = itot*jmax;
+
+    // do the first fourier transform per chunk and pass the chunk on to the xy-transpose
+    for (int c=0; c<nchunk; c++)
+    {
+        const int k0 = c*fftchunk;
+        MPI_Waitall(npx, &zxrecv[c*npx], MPI_STATUSES_IGNORE);
+
+        for (int k=k0; k<k0+fftchunk; k++)
+        {
+#pragma ivdep
+            for (int n=0; n<itot*jmax; n++)
+            {
+                const int ij  = n;
+                const int ijk = n + k*kk;
+                fftini[ij] = tmp1[ijk];
+            }
+
+            fftw_execute(iplanf);
+
+#pragma ivdep
+            for (int n=0; n<itot*jmax; n++)
+            {
+                const int ij  = n;
+                const int ijk = n + k*kk;
+                tmp1[ijk] = fftouti[ij];
+            }
+        }
+
+        for (int n=0; n<npy; n++)
+        {
+            const int ijks = n*iblock + k0*itot*jmax;
+            const int ijkr = n*iblock*jmax + k0*iblock*jtot;
+            MPI_Isend(&tmp1[ijks], 1, transposex2chunk, n, c, master->commy, &xysend[c*npy+n]);
+            MPI_Irecv(&tmp2[ijkr], 1, transposeychunk , n, c, master->commy, &xyrecv[c*npy+n]);
+        }
+    }
+
+    // data is overwritten by the yz-transpose, so the zx-sends have to be completed
+    MPI_Waitall(nchunk*npx, &zxsend[0], MPI_STATUSES_IGNORE);
+
+    kk = iblock*jtot;
+
+    // do the second fourier transform per chunk and transpose the chunk back to z
+    for (int c=0; c<nchunk; c++)
+    {
+        const int k0 = c*fftchunk;
+        MPI_Waitall(npy, &xyrecv[c*npy], MPI_STATUSES_IGNORE);
+
+        for (int k=k0; k<k0+fftchunk; k++)
+        {
+#pragma ivdep
+            for (int n=0; n<iblock*jtot; n++)
+            {
+                const int ij  = n;
+                const int ijk = n + k*kk;
+                fftinj[ij] = tmp2[ijk];
+            }
+
+            fftw_execute(jplanf);
+
+#pragma ivdep
+            for (int n=0; n<iblock*jtot; n++)
+            {
+                const int ij  = n;
+                const int ijk = n + k*kk;
+                tmp2[ijk] = fftoutj[ij];
+            }
+        }
+
+        for (int n=0; n<npx; n++)
+        {
+            const int ijks = n*jblock*iblock + k0*iblock*jtot;
+            const int ijkr = n*kblock*iblock*jblock + k0*iblock*jblock;
+            MPI_Isend(&tmp2[ijks], 1, transposey2chunk, n, nchunk+c, master->commx, &yzsend[c*npx+n]);
+            MPI_Irecv(&data[ijkr], 1, transposez2chunk, n, nchunk+c, master->commx, &yzrecv[c*npx+n]);
+        }
+    }
+
+    MPI_Waitall(nchunk*npy, &xysend[0], MPI_STATUSES_IGNORE);
+    MPI_Waitall(nchunk*npx, &yzsend[0], MPI_STATUSES_IGNORE);
+    MPI_Waitall(nchunk*npx, &yzrecv[0], MPI_STATUSES_IGNORE);
+}
+
+/**
+ * Backward fast-fourier transform with the transposes split into chunks of fftchunk levels.
+ * The y-transforms are done in tmp2, the x-transforms in data and the result ends in tmp1.
+ */
+void Grid::fft_backward_pipelined(double* restrict data,   double* restrict tmp1,   double* restrict tmp2,
+                                  double* restrict fftini, double* restrict fftouti,
+                                  double* restrict fftinj, double* restrict fftoutj)
+{
+    const int npx = master->npx;
+    const int npy = master->npy;
+    const int nchunk = kblock / fftchunk;
+
+    std::vector<MPI_Request> zysend(nchunk*npx), zyrecv(nchunk*npx);
+    std::vector<MPI_Request> yxsend(nchunk*npy), yxrecv(nchunk*npy);
+    std::vector<MPI_Request> xzsend(nchunk*npx), xzrecv(nchunk*npx);
+
+    // post the zy-transposes of all chunks
+    for (int c=0; c<nchunk; c++)
+    {
+        const int k0 = c*fftchunk;
+        for (int n=0; n<npx; n++)
+        {
+            const int ijks = n*kblock*iblock*jblock + k0*iblock*jblock;
+            const int ijkr = n*jblock*iblock + k0*iblock*jtot;
+            MPI_Isend(&data[ijks], 1, transposez2chunk, n, c, master->commx, &zysend[c*npx+n]);
+            MPI_Irecv(&tmp2[ijkr], 1, transposey2chunk, n, c, master->commx, &zyrecv[c*npx+n]);
+        }
+    }
+
+    int kk = iblock*jtot;
+
+    // transform the second transform back per chunk and pass the chunk on to the yx-transpose
+    for (int c=0; c<nchunk; c++)
+    {
+        const int k0 = c*fftchunk;
+        MPI_Waitall(npx, &zyrecv[c*npx], MPI_STATUSES_IGNORE);
+
+        for (int k=k0; k<k0+fftchunk; k++)
+        {
+#pragma ivdep
+            for (int n=0; n<iblock*jtot; n++)
+            {
+                const int ij  = n;
+                const int ijk = n + k*kk;
+                fftinj[ij] = tmp2[ijk];
+            }
+
+            fftw_execute(jplanb);
+
+#pragma ivdep
+            for (int n=0; n<iblock*jtot; n++)
+            {
+                const int ij  = n;
+                const int ijk = n + k*kk;
+                tmp2[ijk] = fftoutj[ij] / jtot;
+            }
+        }
+
+        // data is overwritten by the yx-transpose, so the zy-sends have to be completed
+        if (c == 0)
+            MPI_Waitall(nchunk*npx, &zysend[0], MPI_STATUSES_IGNORE);
+
+        for (int n=0; n<npy; n++)
+        {
+            const int ijks = n*iblock*jmax + k0*iblock*jtot;
+            const int ijkr = n*iblock + k0*itot*jmax;
+            MPI_Isend(&tmp2[ijks], 1, transposeychunk , n, nchunk+c, master->commy, &yxsend[c*npy+n]);
+            MPI_Irecv(&data[ijkr], 1, transposex2chunk, n, nchunk+c, master->commy, &yxrecv[c*npy+n]);
+        }
+    }
+
+    kk = itot*jmax;
+
+    // transform the first transform back per chunk and transpose the chunk back to z
+    for (int c=0; c<nchunk; c++)
+    {
+        const int k0 = c*fftchunk;
+        MPI_Waitall(npy, &yxrecv[c*npy], MPI_STATUSES_IGNORE);
+
+        for (int k=k0; k<k0+fftchunk; k++)
+        {
+#pragma ivdep
+            for (int n=0; n<itot*jmax; n++)
+            {
+                const int ij  = n;
+                const int ijk = n + k*kk;
+                fftini[ij] = data[ijk];
+            }
+
+            fftw_execute(iplanb);
+
+#pragma ivdep
+            for (int n=0; n<itot*jmax; n++)
+            {
+                const int ij  = n;
+                const int ijk = n + k*kk;
+                data[ijk] = fftouti[ij] / itot;
+            }
+        }
+
+        for (int n=0; n<npx; n++)
+        {
+            const int ijks = n*imax + k0*itot*jmax;
+            const int ijkr = n*kblock*imax*jmax + k0*imax*jmax;
+            MPI_Isend(&data[ijks], 1, transposexchunk, n, 2*nchunk+c, master->commx, &xzsend[c*npx+n]);
+            MPI_Irecv(&tmp1[ijkr], 1, transposezchunk, n, 2*nchunk+c, master->commx, &xzrecv[c*npx+n]);
+        }
+    }
+
+    MPI_Waitall(nchunk*npy, &yxsend[0], MPI_STATUSES_IGNORE);
+    MPI_Waitall(nchunk*npx, &xzsend[0], MPI_STATUSES_IGNORE);
+    MPI_Waitall(nchunk*npx, &xzrecv[0], MPI_STATUSES_IGNORE);
+}
+
 int Grid::save_xz_slice(double* restrict data, double* restrict tmp, char* filename, int jslice)
 {
     // extract the data from the 3d field without the ghost cells
@@ -1064,4 +2216,104 @@ int Grid::load_xy_slice(double* restrict data, double* restrict tmp, char* filen
 
     return 0;
 }
+
+int Grid::open_slice_file(char* filename)
+{
+    if (MPI_File_open(master->commxy, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY | MPI_MODE_EXCL, MPI_INFO_NULL, &slicefile))
+        return 1;
+
+    return 0;
+}
+
+int Grid::close_slice_file()
+{
+    if (MPI_File_close(&slicefile))
+        return 1;
+
+    return 0;
+}
+
+/**
+ * This function writes a slice into the open slice file, starting at the given offset in bytes.
+ * All processes take part in the collective write, the processes that do not contain the slice
+ * write zero elements.
+ */
+int Grid::write_slice(double* restrict tmp, int count, MPI_Datatype subslice, bool inslice, unsigned long offset)
+{
+    int nerror = 0;
+
+    MPI_Offset fileoff = offset;
+    char name[] = "native";
+
+    if (MPI_File_set_view(slicefile, fileoff, MPI_DOUBLE, subslice, name, MPI_INFO_NULL))
+        ++nerror;
+
+    if (MPI_File_write_all(slicefile, tmp, inslice ? count : 0, MPI_DOUBLE, MPI_STATUS_IGNORE))
+        ++nerror;
+
+    // Gather errors from other processes
+    master->sum(&nerror, 1);
+
+    return nerror;
+}
+
+int Grid::write_xz_slice(double* restrict data, double* restrict tmp, int jslice, unsigned long offset)
+{
+    const int jj  = icells;
+    const int kk  = icells*jcells;
+    const int kkb = imax;
+
+    for (int k=0; k<kmax; k++)
+#pragma ivdep
+        for (int i=0; i<imax; i++)
+        {
+            // take the modulus of jslice and jmax to have the right offset within proc
+            const int ijk  = i+igc + ((jslice%jmax)+jgc)*jj + (k+kgc)*kk;
+            const int ijkb = i + k*kkb;
+            tmp[ijkb] = data[ijk];
+        }
+
+    return write_slice(tmp, imax*kmax, subxzslice, master->mpicoordy == jslice/jmax, offset);
+}
+
+int Grid::write_yz_slice(double* restrict data, double* restrict tmp, int islice, unsigned long offset)
+{
+    const int jj  = icells;
+    const int kk  = ijcells;
+    const int kkb = jmax;
+
+    for (int k=0; k<kmax; k++)
+#pragma ivdep
+        for (int j=0; j<jmax; j++)
+        {
+            // take the modulus of islice and imax to have the right offset within proc
+            const int ijk  = (islice%imax)+igc + (j+jgc)*jj + (k+kgc)*kk;
+            const int ijkb = j + k*kkb;
+            tmp[ijkb] = data[ijk];
+        }
+
+    return write_slice(tmp, jmax*kmax, subyzslice, master->mpicoordx == islice/imax, offset);
+}
+
+int Grid::write_xy_slice(double* restrict data, double* restrict tmp, int kslice, unsigned long offset)
+{
+    const int jj  = icells;
+    const int kk  = icells*jcells;
+    const int jjb = imax;
+
+    // Subtract the ghost cells in case of a pure 2d plane that does not have ghost cells.
+    if (kslice == -1)
+        kslice = -kgc;
+
+    for (int j=0; j<jmax; j++)
+#pragma ivdep
+        for (int i=0; i<imax; i++)
+        {
+            const int ijk  = i+igc + (j+jgc)*jj + (kslice+kgc)*kk;
+            const int ijkb = i + j*jjb;
+            tmp[ijkb] = data[ijk];
+        }
+
+    return write_slice(tmp, imax*jmax, subxyslice, true, offset);
+}
 #endif
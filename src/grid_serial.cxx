@@ -23,6 +23,13 @@
 #ifndef USEMPI
 #include <fftw3.h>
 #include <cstdio>
+#include <cstring>
+#include <stdint.h>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "master.h"
 #include "grid.h"
 #include "defines.h"
@@ -110,6 +117,26 @@ void Grid::boundary_cyclic(double* restrict data, Edge edge)
     }
 }
 
+void Grid::boundary_cyclic_start(double* restrict data)
+{
+    // Without communication, the ghost cells can be filled directly.
+    boundary_cyclic(data);
+}
+
+void Grid::boundary_cyclic_end(double* restrict data)
+{
+}
+
+void Grid::boundary_cyclic_start(const std::vector<double*>& fields)
+{
+    for (std::vector<double*>::const_iterator it=fields.begin(); it!=fields.end(); ++it)
+        boundary_cyclic(*it);
+}
+
+void Grid::boundary_cyclic_end(const std::vector<double*>& fields)
+{
+}
+
 void Grid::boundary_cyclic_2d(double* restrict data)
 {
     const int jj = icells;
@@ -273,6 +300,16 @@ void Grid::get_prof(double *prof, int kcellsin)
 {
 }
 
+void Grid::get_min(unsigned long *var, int nvar)
+{
+}
+
+void Grid::exec_reductions()
+{
+    reducevars.clear();
+    reduceops.clear();
+}
+
 // IO functions
 void Grid::save()
 {
@@ -300,26 +337,9 @@ void Grid::save()
     fclose(pFile);
 
     // SAVE THE FFTW PLAN IN ORDER TO ENSURE BITWISE IDENTICAL RESTARTS
-    // use the FFTW3 many interface in order to reduce function call overhead
-    int rank = 1;
-    int ni[] = {itot};
-    int nj[] = {jtot};
-    int istride = 1;
-    int jstride = iblock;
-    int idist = itot;
-    int jdist = 1;
-    fftw_r2r_kind kindf[] = {FFTW_R2HC};
-    fftw_r2r_kind kindb[] = {FFTW_HC2R};
-    iplanf = fftw_plan_many_r2r(rank, ni, jmax, fftini, ni, istride, idist,
-                                fftouti, ni, istride, idist, kindf, FFTW_EXHAUSTIVE);
-    iplanb = fftw_plan_many_r2r(rank, ni, jmax, fftini, ni, istride, idist,
-                                fftouti, ni, istride, idist, kindb, FFTW_EXHAUSTIVE);
-    jplanf = fftw_plan_many_r2r(rank, nj, iblock, fftinj, nj, jstride, jdist,
-                                fftoutj, nj, jstride, jdist, kindf, FFTW_EXHAUSTIVE);
-    jplanb = fftw_plan_many_r2r(rank, nj, iblock, fftinj, nj, jstride, jdist,
-                                fftoutj, nj, jstride, jdist, kindb, FFTW_EXHAUSTIVE);
-
-    fftwplan = true;
+    // start from the wisdom cache if available, to avoid planning a known grid again
+    import_wisdom_cache();
+    create_fftw_plans();
 
     if (master->mpiid == 0)
     {
@@ -336,6 +356,8 @@ void Grid::save()
         }
         else
             master->print_message("OK\n");
+
+        export_wisdom_cache();
     }
 }
 
@@ -381,31 +403,13 @@ void Grid::load()
     else
         master->print_message("OK\n");
 
-    // use the FFTW3 many interface in order to reduce function call overhead
-    int rank = 1;
-    int ni[] = {itot};
-    int nj[] = {jtot};
-    int istride = 1;
-    int jstride = iblock;
-    int idist = itot;
-    int jdist = 1;
-    fftw_r2r_kind kindf[] = {FFTW_R2HC};
-    fftw_r2r_kind kindb[] = {FFTW_HC2R};
-    iplanf = fftw_plan_many_r2r(rank, ni, jmax, fftini, ni, istride, idist,
-            fftouti, ni, istride, idist, kindf, FFTW_EXHAUSTIVE);
-    iplanb = fftw_plan_many_r2r(rank, ni, jmax, fftini, ni, istride, idist,
-            fftouti, ni, istride, idist, kindb, FFTW_EXHAUSTIVE);
-    jplanf = fftw_plan_many_r2r(rank, nj, iblock, fftinj, nj, jstride, jdist,
-            fftoutj, nj, jstride, jdist, kindf, FFTW_EXHAUSTIVE);
-    jplanb = fftw_plan_many_r2r(rank, nj, iblock, fftinj, nj, jstride, jdist,
-            fftoutj, nj, jstride, jdist, kindb, FFTW_EXHAUSTIVE);
-
-    fftwplan = true;
+    create_fftw_plans();
 
     fftw_forget_wisdom();
 }
 
-int Grid::save_field3d(double* restrict data, double* restrict tmp1, double* restrict tmp2, char* filename, double offset)
+int Grid::save_field3d(double* restrict data, double* restrict tmp1, double* restrict tmp2, char* filename, double offset,
+                       bool header)
 {
     FILE *pFile;
     pFile = fopen(filename, "wbx");
@@ -413,65 +417,292 @@ int Grid::save_field3d(double* restrict data, double* restrict tmp1, double* res
     if (pFile == NULL)
         return 1;
 
-    const int jj = icells;
-    const int kk = icells*jcells;
+    if (header)
+    {
+        int headerdata[field3dheaderlength];
+        set_field3d_header(headerdata);
+        fwrite(headerdata, sizeof(int), field3dheaderlength, pFile);
+    }
+
+    const int jj  = icells;
+    const int kk  = icells*jcells;
+    const int jjb = imax;
+    const int kkb = imax*jmax;
+
+    // first, add the offset to the data and remove the ghost cells
+    for (int k=0; k<kmax; k++)
+        for (int j=0; j<jmax; j++)
+#pragma ivdep
+            for (int i=0; i<imax; i++)
+            {
+                const int ijk  = i+igc + (j+jgc)*jj + (k+kgc)*kk;
+                const int ijkb = i + j*jjb + k*kkb;
+                tmp1[ijkb] = data[ijk] + offset;
+            }
+
+    // second, save the data to disk in a single write
+    const size_t count = (size_t)imax*jmax*kmax;
+    int nerror = (fwrite(tmp1, sizeof(double), count, pFile) != count);
 
-    // first, add the offset to the data
-    for (int k=kstart; k<kend; k++)
-        for (int j=jstart; j<jend; j++)
-            for (int i=istart; i<iend; i++)
+    if (fclose(pFile))
+        ++nerror;
+
+    return (nerror > 0);
+}
+
+int Grid::save_field3d_start(double* restrict data, double* restrict tmp1, double* tmp2, char* filename, double offset,
+                             bool header)
+{
+    // Without MPI-IO the field is saved directly.
+    return save_field3d(data, tmp1, tmp2, filename, offset, header);
+}
+
+int Grid::save_field3d_end()
+{
+    return 0;
+}
+
+int Grid::save_field3d_packed(double* restrict data, double* restrict tmp1, double* restrict tmp2, char* filename,
+                              double offset, double scale, bool single, bool compress)
+{
+    // extract the data from the 3d field without the ghost cells
+    const int jj  = icells;
+    const int kk  = icells*jcells;
+    const int jjb = imax;
+    const int kkb = imax*jmax;
+
+    const int count = imax*jmax*kmax;
+
+    for (int k=0; k<kmax; k++)
+        for (int j=0; j<jmax; j++)
+#pragma ivdep
+            for (int i=0; i<imax; i++)
             {
-                const int ijk = i + j*jj + k*kk;
-                tmp1[ijk] = data[ijk] + offset;
+                const int ijk  = i+igc + (j+jgc)*jj + (k+kgc)*kk;
+                const int ijkb = i + j*jjb + k*kkb;
+                tmp1[ijkb] = (data[ijk] - offset)*scale;
             }
 
-    // second, save the data to disk
-    for (int k=kstart; k<kend; k++)
-        for (int j=jstart; j<jend; j++)
+    // convert the data to single precision in tmp2
+    const int typesize = single ? sizeof(float) : sizeof(double);
+    unsigned char* buffer = reinterpret_cast<unsigned char*>(tmp1);
+
+    if (single)
+    {
+        float* tmp2f = reinterpret_cast<float*>(tmp2);
+        for (int n=0; n<count; ++n)
+            tmp2f[n] = static_cast<float>(tmp1[n]);
+        buffer = reinterpret_cast<unsigned char*>(tmp2);
+    }
+
+    FILE *pFile;
+    pFile = fopen(filename, "wbx");
+
+    if (pFile == NULL)
+        return 1;
+
+    int nerror = 0;
+
+    int header[field3dheaderlength];
+    set_field3d_packed_header(header, single, compress);
+    const double packing[2] = {offset, scale};
+
+    if (fwrite(header, sizeof(int), field3dheaderlength, pFile) != (size_t)field3dheaderlength)
+        ++nerror;
+    if (fwrite(packing, sizeof(double), 2, pFile) != 2)
+        ++nerror;
+
+    if (!compress)
+    {
+        if (fwrite(buffer, typesize, count, pFile) != (size_t)count)
+            ++nerror;
+    }
+    else
+    {
+        // every level is compressed as a separate block
+        const uint64_t nblocks = kmax;
+        const int nvalues = imax*jmax;
+
+        std::vector< std::vector<unsigned char> > blocks(nblocks);
+        std::vector<uint64_t> blocksizes(nblocks);
+
+        for (int k=0; k<kmax; ++k)
         {
-            const int ijk = istart + j*jj + k*kk;
-            fwrite(&tmp1[ijk], sizeof(double), imax, pFile);
+            nerror += compress_block(blocks[k], &buffer[k*nvalues*typesize], nvalues, typesize);
+            blocksizes[k] = blocks[k].size();
         }
 
-    fclose(pFile);
+        if (nerror)
+        {
+            fclose(pFile);
+            return 1;
+        }
 
-    return 0;
+        if (fwrite(&nblocks, sizeof(uint64_t), 1, pFile) != 1)
+            ++nerror;
+        if (fwrite(&blocksizes[0], sizeof(uint64_t), nblocks, pFile) != nblocks)
+            ++nerror;
+
+        for (int k=0; k<kmax; ++k)
+            if (fwrite(&blocks[k][0], 1, blocksizes[k], pFile) != blocksizes[k])
+                ++nerror;
+    }
+
+    if (fclose(pFile))
+        ++nerror;
+
+    return (nerror > 0);
 }
 
-int Grid::load_field3d(double* restrict data, double* restrict tmp1, double* restrict tmp2, char* filename, double offset)
+int Grid::save_field3d_sub(double* restrict data, double* restrict tmp1, char* filename, double offset,
+                           const int region[6], const int coarse[3], const int loc[3])
 {
     FILE *pFile;
-    pFile = fopen(filename, "rb");
+    pFile = fopen(filename, "wbx");
 
     if (pFile == NULL)
         return 1;
 
-    const int jj = icells;
-    const int kk = icells*jcells;
+    const int range[6] = {region[0]+igc, region[1]+igc, region[2]+jgc, region[3]+jgc, region[4]+kgc, region[5]+kgc};
+    calc_coarse_block(tmp1, data, offset, range, coarse, loc);
+
+    const size_t count = (size_t)((region[1]-region[0])/coarse[0]) * ((region[3]-region[2])/coarse[1]) * ((region[5]-region[4])/coarse[2]);
+    int nerror = (fwrite(tmp1, sizeof(double), count, pFile) != count);
+
+    if (fclose(pFile))
+        ++nerror;
+
+    return (nerror > 0);
+}
+
+void Grid::progress_field3d_save()
+{
+}
+
+/**
+ * This function starts loading a 3d field by letting the operating system read the file into
+ * the page cache in the background, which does not need a buffer. The field is copied from there
+ * by load_field3d_end.
+ */
+int Grid::load_field3d_start(char* filename)
+{
+    const int fd = open(filename, O_RDONLY);
+
+    if (fd == -1)
+        return 1;
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    close(fd);
+
+    return 0;
+}
+
+int Grid::load_field3d_end(double* restrict data, double* restrict tmp1, double* restrict tmp2, char* filename, double offset)
+{
+    return load_field3d(data, tmp1, tmp2, filename, offset);
+}
+
+void Grid::progress_field3d_load()
+{
+}
+
+/**
+ * This function loads a 3d field by mapping the file into memory, such that the values are copied
+ * directly from the page cache into the field with ghost cells. In case the file cannot be mapped,
+ * the field is read with a single read into tmp1 instead.
+ */
+int Grid::load_field3d(double* restrict data, double* restrict tmp1, double* restrict tmp2, char* filename, double offset)
+{
+    const int fd = open(filename, O_RDONLY);
 
-    // first, load the data from disk
-    for (int k=kstart; k<kend; k++)
-        for (int j=jstart; j<jend; j++)
+    if (fd == -1)
+        return 1;
+
+    struct stat filestat;
+    if (fstat(fd, &filestat))
+    {
+        close(fd);
+        return 1;
+    }
+
+    const long long filesize = filestat.st_size;
+
+    void* map = MAP_FAILED;
+    if (filesize > 0)
+        map = mmap(NULL, filesize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // read the header, which is ignored for files without header as their size matches the grid
+    int header[field3dheaderlength] = {0};
+    if (filesize >= (long long)sizeof(header))
+    {
+        if (map != MAP_FAILED)
+            std::memcpy(header, map, sizeof(header));
+        else if (pread(fd, header, sizeof(header), 0) != (ssize_t)sizeof(header))
+            header[0] = 0;
+    }
+
+    long long dataoffset;
+    if (check_field3d_header(header, filesize, &dataoffset, filename))
+    {
+        if (map != MAP_FAILED)
+            munmap(map, filesize);
+        close(fd);
+        return 1;
+    }
+
+    const size_t count = (size_t)imax*jmax*kmax;
+    const double* restrict buf;
+
+    if (map != MAP_FAILED)
+    {
+        madvise(map, filesize, MADV_SEQUENTIAL);
+        buf = reinterpret_cast<const double*>(static_cast<const char*>(map) + dataoffset);
+    }
+    else
+    {
+        // read the whole field at once, pread can return less than requested for large files
+        char* dest = reinterpret_cast<char*>(tmp1);
+        size_t nbytes = count*sizeof(double);
+        off_t pos = dataoffset;
+        while (nbytes > 0)
         {
-            const int ijk = istart + j*jj + k*kk;
-            fread(&tmp1[ijk], sizeof(double), imax, pFile);
+            const ssize_t n = pread(fd, dest, nbytes, pos);
+            if (n <= 0)
+            {
+                close(fd);
+                return 1;
+            }
+            dest   += n;
+            pos    += n;
+            nbytes -= n;
         }
+        buf = tmp1;
+    }
 
-    fclose(pFile);
+    const int jj  = icells;
+    const int kk  = icells*jcells;
+    const int jjb = imax;
+    const int kkb = imax*jmax;
 
-    // second, remove the offset
-    for (int k=kstart; k<kend; k++)
-        for (int j=jstart; j<jend; j++)
-            for (int i=istart; i<iend; i++)
+    // copy the data into the field and remove the offset
+    for (int k=0; k<kmax; k++)
+        for (int j=0; j<jmax; j++)
+#pragma ivdep
+            for (int i=0; i<imax; i++)
             {
-                const int ijk = i + j*jj + k*kk;
-                data[ijk] = tmp1[ijk] - offset;
+                const int ijk  = i+igc + (j+jgc)*jj + (k+kgc)*kk;
+                const int ijkb = i + j*jjb + k*kkb;
+                data[ijk] = buf[ijkb] - offset;
             }
 
+    if (map != MAP_FAILED)
+        munmap(map, filesize);
+    close(fd);
+
     return 0;
 }
 
-void Grid::fft_forward(double* restrict data,   double* restrict tmp1,
+void Grid::fft_forward(double* restrict data,   double* restrict tmp1,   double* restrict tmp2,
                        double* restrict fftini, double* restrict fftouti,
                        double* restrict fftinj, double* restrict fftoutj)
 {
@@ -525,7 +756,7 @@ void Grid::fft_forward(double* restrict data,   double* restrict tmp1,
     }
 }
 
-void Grid::fft_backward(double* restrict data,   double* restrict tmp1,
+void Grid::fft_backward(double* restrict data,   double* restrict tmp1,   double* restrict tmp2,
                         double* restrict fftini, double* restrict fftouti,
                         double* restrict fftinj, double* restrict fftoutj)
 {
@@ -707,4 +938,102 @@ int Grid::load_xy_slice(double* restrict data, double* restrict tmp, char* filen
 
     return 0;
 }
+
+int Grid::open_slice_file(char* filename)
+{
+    slicefile = fopen(filename, "wbx");
+    if (slicefile == NULL)
+        return 1;
+
+    return 0;
+}
+
+int Grid::close_slice_file()
+{
+    fclose(slicefile);
+
+    return 0;
+}
+
+int Grid::write_xz_slice(double* restrict data, double* restrict tmp, int jslice, unsigned long offset)
+{
+    const int jj  = icells;
+    const int kk  = icells*jcells;
+    const int kkb = imax;
+
+    const int count = imax*kmax;
+
+    for (int k=0; k<kmax; k++)
+#pragma ivdep
+        for (int i=0; i<imax; i++)
+        {
+            const int ijk  = i+igc + (jslice+jgc)*jj + (k+kgc)*kk;
+            const int ijkb = i + k*kkb;
+            tmp[ijkb] = data[ijk];
+        }
+
+    if (fseek(slicefile, offset, SEEK_SET))
+        return 1;
+
+    if (fwrite(tmp, sizeof(double), count, slicefile) != (size_t)count)
+        return 1;
+
+    return 0;
+}
+
+int Grid::write_yz_slice(double* restrict data, double* restrict tmp, int islice, unsigned long offset)
+{
+    const int jj  = icells;
+    const int kk  = ijcells;
+    const int kkb = jmax;
+
+    const int count = jmax*kmax;
+
+    for (int k=0; k<kmax; k++)
+#pragma ivdep
+        for (int j=0; j<jmax; j++)
+        {
+            const int ijk  = islice+igc + (j+jgc)*jj + (k+kgc)*kk;
+            const int ijkb = j + k*kkb;
+            tmp[ijkb] = data[ijk];
+        }
+
+    if (fseek(slicefile, offset, SEEK_SET))
+        return 1;
+
+    if (fwrite(tmp, sizeof(double), count, slicefile) != (size_t)count)
+        return 1;
+
+    return 0;
+}
+
+int Grid::write_xy_slice(double* restrict data, double* restrict tmp, int kslice, unsigned long offset)
+{
+    const int jj  = icells;
+    const int kk  = icells*jcells;
+    const int jjb = imax;
+
+    const int count = imax*jmax;
+
+    // Subtract the ghost cells in case of a pure 2d plane that does not have ghost cells.
+    if (kslice == -1)
+        kslice = -kgc;
+
+    for (int j=0; j<jmax; j++)
+#pragma ivdep
+        for (int i=0; i<imax; i++)
+        {
+            const int ijk  = i+igc + (j+jgc)*jj + (kslice+kgc)*kk;
+            const int ijkb = i + j*jjb;
+            tmp[ijkb] = data[ijk];
+        }
+
+    if (fseek(slicefile, offset, SEEK_SET))
+        return 1;
+
+    if (fwrite(tmp, sizeof(double), count, slicefile) != (size_t)count)
+        return 1;
+
+    return 0;
+}
 #endif
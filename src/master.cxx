@@ -22,6 +22,10 @@
 
 #include <cstdarg>
 #include <cstdio>
+#include <vector>
+#ifdef USEOPENMP
+#include <omp.h>
+#endif
 #include "master.h"
 
 void Master::print_message(const char *format, ...)
@@ -77,3 +81,182 @@ bool Master::at_wall_clock_limit()
     else
         return false;
 }
+
+void Master::init_threads()
+{
+    if (nthreads < 1)
+    {
+        print_error("nthreads = %d has to be at least 1\n", nthreads);
+        throw 1;
+    }
+
+#ifdef USEOPENMP
+    omp_set_num_threads(nthreads);
+    print_message("Running with %d threads per process\n", nthreads);
+#else
+    if (nthreads > 1)
+    {
+        print_error("nthreads = %d requires a build with USEOPENMP enabled\n", nthreads);
+        throw 1;
+    }
+#endif
+}
+
+void Master::start_timer(const std::string& name)
+{
+    timers[name].start = get_wall_clock_time();
+}
+
+void Master::stop_timer(const std::string& name)
+{
+    Timer& timer = timers[name];
+    const double elapsed = get_wall_clock_time() - timer.start;
+
+    timer.total    += elapsed;
+    timer.interval += elapsed;
+    ++timer.ncalls;
+}
+
+bool Master::check_timers()
+{
+    // The timers are stored sorted by name, thus a hash (32-bit FNV-1a) over the names in
+    // that order identifies the set. The number of timers is compared as well.
+    unsigned int hash = 2166136261u;
+    for (std::map<std::string, Timer>::const_iterator it=timers.begin(); it!=timers.end(); ++it)
+    {
+        // include the terminating null character to separate the names
+        const char* name = it->first.c_str();
+        for (size_t n=0; n<it->first.size()+1; ++n)
+        {
+            hash ^= (unsigned char)name[n];
+            hash *= 16777619u;
+        }
+    }
+
+    double checkmin[2] = {(double)timers.size(), (double)hash};
+    double checkmax[2] = {(double)timers.size(), (double)hash};
+    min(checkmin, 2);
+    max(checkmax, 2);
+
+    return (checkmin[0] == checkmax[0] && checkmin[1] == checkmax[1]);
+}
+
+void Master::write_timers(const int iter, const double time)
+{
+    if (swtiming == "0")
+        return;
+
+    if (!check_timers())
+    {
+        print_warning("timers differ between processes, timing file is not written\n");
+        return;
+    }
+
+    if (timers.empty())
+        return;
+
+    // open the timing file on the main process, all processes stop in case of failure
+    if (!timingopened)
+    {
+        timingopened = true;
+
+        int nerror = 0;
+        if (mpiid == 0)
+        {
+            std::string timingname = simname + ".timing";
+            timingfile = std::fopen(timingname.c_str(), "a");
+            if (timingfile == NULL)
+                nerror = 1;
+            else
+                std::fprintf(timingfile, "%8s %11s %-12s %11s %11s %11s\n",
+                        "ITER", "TIME", "TIMER", "MIN", "MEAN", "MAX");
+        }
+
+        broadcast(&nerror, 1);
+        if (nerror)
+        {
+            print_error("cannot open timing file %s.timing\n", simname.c_str());
+            throw 1;
+        }
+    }
+
+    const int ntimers = timers.size();
+    std::vector<double> tmin (ntimers);
+    std::vector<double> tmean(ntimers);
+    std::vector<double> tmax (ntimers);
+
+    int n = 0;
+    for (std::map<std::string, Timer>::iterator it=timers.begin(); it!=timers.end(); ++it)
+    {
+        tmin [n] = it->second.interval;
+        tmean[n] = it->second.interval;
+        tmax [n] = it->second.interval;
+        it->second.interval = 0.;
+        ++n;
+    }
+
+    min(&tmin [0], ntimers);
+    sum(&tmean[0], ntimers);
+    max(&tmax [0], ntimers);
+
+    if (mpiid == 0)
+    {
+        n = 0;
+        for (std::map<std::string, Timer>::const_iterator it=timers.begin(); it!=timers.end(); ++it)
+        {
+            std::fprintf(timingfile, "%8d %11.3E %-12s %11.4E %11.4E %11.4E\n",
+                    iter, time, it->first.c_str(), tmin[n], tmean[n]/nprocs, tmax[n]);
+            ++n;
+        }
+        std::fflush(timingfile);
+    }
+}
+
+void Master::print_timers()
+{
+    if (!check_timers())
+    {
+        print_warning("timers differ between processes, timings are not printed\n");
+        return;
+    }
+
+    if (timers.empty())
+        return;
+
+    const int ntimers = timers.size();
+    std::vector<double> tmin (ntimers);
+    std::vector<double> tmean(ntimers);
+    std::vector<double> tmax (ntimers);
+
+    int n = 0;
+    for (std::map<std::string, Timer>::const_iterator it=timers.begin(); it!=timers.end(); ++it)
+    {
+        tmin [n] = it->second.total;
+        tmean[n] = it->second.total;
+        tmax [n] = it->second.total;
+        ++n;
+    }
+
+    min(&tmin [0], ntimers);
+    sum(&tmean[0], ntimers);
+    max(&tmax [0], ntimers);
+
+    print_message("Wall clock time per stage over all processes [s]:\n");
+    print_message("%-12s %10s %11s %11s %11s\n", "TIMER", "NCALLS", "MIN", "MEAN", "MAX");
+
+    n = 0;
+    for (std::map<std::string, Timer>::const_iterator it=timers.begin(); it!=timers.end(); ++it)
+    {
+        print_message("%-12s %10lu %11.4E %11.4E %11.4E\n",
+                it->first.c_str(), it->second.ncalls, tmin[n], tmean[n]/nprocs, tmax[n]);
+        ++n;
+    }
+
+    // Close the timing file at the end of the run.
+    if (timingfile != NULL)
+    {
+        std::fclose(timingfile);
+        timingfile = NULL;
+    }
+    timingopened = false;
+}
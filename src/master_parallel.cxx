@@ -23,6 +23,7 @@
 #ifdef USEMPI
 #include <mpi.h>
 #include <stdexcept>
+#include <vector>
 #include "grid.h"
 #include "defines.h"
 #include "master.h"
@@ -32,6 +33,9 @@ Master::Master()
     initialized = false;
     allocated   = false;
 
+    timingfile   = NULL;
+    timingopened = false;
+
     // set the mpiid, to ensure that errors can be written if MPI init fails
     mpiid = 0;
 }
@@ -54,8 +58,13 @@ Master::~Master()
 
 void Master::start(int argc, char *argv[])
 {
-    // initialize the MPI
+    // initialize the MPI, only the master thread communicates in case of threading
+#ifdef USEOPENMP
+    int provided;
+    int n = MPI_Init_thread(NULL, NULL, MPI_THREAD_FUNNELED, &provided);
+#else
     int n = MPI_Init(NULL, NULL);
+#endif
     if (check_error(n))
         throw 1;
 
@@ -80,6 +89,15 @@ void Master::start(int argc, char *argv[])
 
     print_message("Starting run on %d processes\n", nprocs);
 
+#ifdef USEOPENMP
+    // the threaded kernels are only safe if the MPI library supports calls from the master thread
+    if (provided < MPI_THREAD_FUNNELED)
+    {
+        print_error("MPI library does not support MPI_THREAD_FUNNELED, which is required with threading\n");
+        throw 1;
+    }
+#endif
+
     // process the command line options
     if (argc <= 1)
     {
@@ -108,16 +126,26 @@ void Master::init(Input *inputin)
     int nerror = 0;
     nerror += inputin->get_item(&npx, "master", "npx", "", 1);
     nerror += inputin->get_item(&npy, "master", "npy", "", 1);
+    nerror += inputin->get_item(&nthreads, "master", "nthreads", "", 1);
 
     // Get the wall clock limit with a default value of 1E8 hours, which will be never hit
     double wall_clock_limit;
     nerror += inputin->get_item(&wall_clock_limit, "master", "wallclocklimit", "", 1E8);
 
+    // Write the timers of the model stages per check interval to the .timing file.
+    nerror += inputin->get_item(&swtiming, "master", "swtiming", "", "0");
+
     if (nerror)
         throw 1;
 
     wall_clock_end = wall_clock_start + 3600.*wall_clock_limit;
 
+    if (!(swtiming == "0" || swtiming == "1"))
+    {
+        print_error("\"%s\" is an illegal value for swtiming\n", swtiming.c_str());
+        throw 1;
+    }
+
     if (nprocs != npx*npy)
     {
         print_error("nprocs = %d does not equal npx*npy = %d*%d\n", nprocs, npx, npy);
@@ -177,6 +205,28 @@ void Master::init(Input *inputin)
     if (check_error(n))
         throw 1;
 
+    // the diagonal neighbors are needed to exchange the corners of the ghost cells in one step
+    int ncoords[2];
+    ncoords[0] = mpicoordy+1; ncoords[1] = mpicoordx+1;
+    n = MPI_Cart_rank(commxy, ncoords, &nnortheast);
+    if (check_error(n))
+        throw 1;
+
+    ncoords[0] = mpicoordy+1; ncoords[1] = mpicoordx-1;
+    n = MPI_Cart_rank(commxy, ncoords, &nnorthwest);
+    if (check_error(n))
+        throw 1;
+
+    ncoords[0] = mpicoordy-1; ncoords[1] = mpicoordx+1;
+    n = MPI_Cart_rank(commxy, ncoords, &nsoutheast);
+    if (check_error(n))
+        throw 1;
+
+    ncoords[0] = mpicoordy-1; ncoords[1] = mpicoordx-1;
+    n = MPI_Cart_rank(commxy, ncoords, &nsouthwest);
+    if (check_error(n))
+        throw 1;
+
     // create the requests arrays for the nonblocking sends
     int npmax;
     npmax = std::max(npx, npy);
@@ -187,6 +237,8 @@ void Master::init(Input *inputin)
     reqsn = 0;
 
     allocated = true;
+
+    init_threads();
 }
 
 double Master::get_wall_clock_time()
@@ -257,4 +309,25 @@ void Master::min(double *var, int datasize)
 {
     MPI_Allreduce(MPI_IN_PLACE, var, datasize, MPI_DOUBLE, MPI_MIN, commxy);
 }
+
+// the data of the processes is stored consecutively in order of rank, the counts are only used at the main process
+void Master::gather(int *sendbuf, int sendsize, int *recvbuf, const int *recvsizes)
+{
+    std::vector<int> displs(nprocs, 0);
+    if (mpiid == 0)
+        for (int n=1; n<nprocs; ++n)
+            displs[n] = displs[n-1] + recvsizes[n-1];
+
+    MPI_Gatherv(sendbuf, sendsize, MPI_INT, recvbuf, const_cast<int*>(recvsizes), &displs[0], MPI_INT, 0, commxy);
+}
+
+void Master::gather(double *sendbuf, int sendsize, double *recvbuf, const int *recvsizes)
+{
+    std::vector<int> displs(nprocs, 0);
+    if (mpiid == 0)
+        for (int n=1; n<nprocs; ++n)
+            displs[n] = displs[n-1] + recvsizes[n-1];
+
+    MPI_Gatherv(sendbuf, sendsize, MPI_DOUBLE, recvbuf, const_cast<int*>(recvsizes), &displs[0], MPI_DOUBLE, 0, commxy);
+}
 #endif
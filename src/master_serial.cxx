@@ -30,6 +30,9 @@ Master::Master()
 {
     initialized = false;
     allocated   = false;
+
+    timingfile   = NULL;
+    timingopened = false;
 }
 
 Master::~Master()
@@ -79,16 +82,26 @@ void Master::init(Input *inputin)
     int nerror = 0;
     nerror += inputin->get_item(&npx, "master", "npx", "", 1);
     nerror += inputin->get_item(&npy, "master", "npy", "", 1);
+    nerror += inputin->get_item(&nthreads, "master", "nthreads", "", 1);
 
     // Get the wall clock limit with a default value of 1E8 hours, which will be never hit
     double wall_clock_limit;
     nerror += inputin->get_item(&wall_clock_limit, "master", "wallclocklimit", "", 1E8);
 
+    // Write the timers of the model stages per check interval to the .timing file.
+    nerror += inputin->get_item(&swtiming, "master", "swtiming", "", "0");
+
     if (nerror)
         throw 1;
 
     wall_clock_end = wall_clock_start + 3600.*wall_clock_limit;
 
+    if (!(swtiming == "0" || swtiming == "1"))
+    {
+        print_error("\"%s\" is an illegal value for swtiming\n", swtiming.c_str());
+        throw 1;
+    }
+
     if (nprocs != npx*npy)
     {
         print_error("npx*npy = %d*%d has to be equal to 1*1 in serial mode\n", npx, npy);
@@ -100,6 +113,8 @@ void Master::init(Input *inputin)
     mpicoordy = 0;
 
     allocated = true;
+
+    init_threads();
 }
 
 double Master::get_wall_clock_time()
@@ -146,4 +161,17 @@ void Master::max(double *var, int datasize)
 void Master::min(double *var, int datasize)
 {
 }
+
+// the only process holds all data, which is copied to the receive buffer
+void Master::gather(int *sendbuf, int sendsize, int *recvbuf, const int *recvsizes)
+{
+    for (int n=0; n<sendsize; ++n)
+        recvbuf[n] = sendbuf[n];
+}
+
+void Master::gather(double *sendbuf, int sendsize, double *recvbuf, const int *recvsizes)
+{
+    for (int n=0; n<sendsize; ++n)
+        recvbuf[n] = sendbuf[n];
+}
 #endif
@@ -39,6 +39,8 @@
 #include "stats.h"
 #include "cross.h"
 #include "dump.h"
+#include "average.h"
+#include "column.h"
 #include "budget.h"
 
 #ifdef USECUDA
@@ -64,6 +66,8 @@ Model::Model(Master *masterin, Input *inputin)
     stats  = 0;
     cross  = 0;
     dump   = 0;
+    average = 0;
+    column  = 0;
     budget = 0;
 
     try
@@ -81,6 +85,13 @@ Model::Model(Master *masterin, Input *inputin)
         pres     = Pres    ::factory(master, input, this, grid->swspatialorder);
         thermo   = Thermo  ::factory(master, input, this);
 
+        // The fused advection kernels only contain the 2nd order diffusion scheme.
+        if (advec->includes_diff() && diff->get_switch() != "2")
+        {
+            master->print_error("swfusediff = 1 requires swdiff = 2\n");
+            throw 1;
+        }
+
         timeloop = new Timeloop(this, input);
         force    = new Force   (this, input);
         buffer   = new Buffer  (this, input);
@@ -89,6 +100,8 @@ Model::Model(Master *masterin, Input *inputin)
         stats  = new Stats (this, input);
         cross  = new Cross (this, input);
         dump   = new Dump  (this, input);
+        average = new Average(this, input);
+        column  = new Column (this, input);
 
         budget = Budget::factory(input, master, grid, fields, thermo, diff, advec, force, stats);
 
@@ -130,6 +143,8 @@ void Model::delete_objects()
 {
     // Delete the components in reversed order.
     delete budget;
+    delete column;
+    delete average;
     delete dump;
     delete cross;
     delete stats;
@@ -170,6 +185,8 @@ void Model::init()
     stats ->init(timeloop->get_ifactor());
     cross ->init(timeloop->get_ifactor());
     dump  ->init(timeloop->get_ifactor());
+    average->init(timeloop->get_ifactor());
+    column ->init(timeloop->get_ifactor());
     budget->init();
 }
 
@@ -184,7 +201,12 @@ void Model::load()
     stats->create(timeloop->get_iotime());
     cross->create();
     dump ->create();
+    average->create(timeloop->get_itime());
+    average->load(timeloop->get_iotime());
+    column ->create(timeloop->get_iotime());
 
+    // Select the fields that are needed, which are all fields except in post-processing mode.
+    fields->create_loadlist();
     fields->load(timeloop->get_iotime());
     fields->create_stats();
 
@@ -213,6 +235,7 @@ void Model::save()
     // Save the initialized data to disk for the run mode.
     grid    ->save();
     fields  ->save(timeloop->get_iotime());
+    fields  ->finish_save();
     timeloop->save(timeloop->get_iotime());
 }
 
@@ -234,18 +257,38 @@ void Model::exec()
 
     master->print_message("Starting time integration\n");
 
+    // Start reading the fields of the next time while the current one is processed.
+    if (master->mode == "post")
+        fields->prefetch(timeloop->get_next_post_proc_iotime());
+
     // Update the time dependent parameters.
     boundary->update_time_dependent();
     force   ->update_time_dependent();
 
-    // Set the boundary conditions.
-    boundary->exec();
+    // Set the boundary conditions, and compute the interior advection and diffusion
+    // tendencies while the ghost cells are being exchanged.
+    master->start_timer("boundary");
+    boundary->exec_start();
+    master->stop_timer("boundary");
+    master->start_timer("advec");
+    advec->exec_interior();
+    master->stop_timer("advec");
+    master->start_timer("diff");
+    diff ->exec_interior();
+    master->stop_timer("diff");
+    master->start_timer("boundary");
+    boundary->exec_end();
+    master->stop_timer("boundary");
 
     // Calculate the field means, in case needed.
+    master->start_timer("fields");
     fields->exec();
+    master->stop_timer("fields");
 
     // Get the viscosity to be used in diffusion.
+    master->start_timer("diff");
     diff->exec_viscosity();
+    master->stop_timer("diff");
 
     // Set the time step.
     set_time_step();
@@ -259,33 +302,46 @@ void Model::exec()
         // Determine the time step.
         set_time_step();
 
-        // Calculate the advection tendency.
+        // Calculate the advection tendency, the interior has been done while setting the boundary conditions.
+        master->start_timer("advec");
         boundary->set_ghost_cells_w(Boundary::Conservation_type);
-        advec->exec();
+        advec->exec_boundary();
         boundary->set_ghost_cells_w(Boundary::Normal_type);
+        master->stop_timer("advec");
 
-        // Calculate the diffusion tendency.
-        diff->exec();
+        // Calculate the diffusion tendency, the interior has been done while setting the boundary conditions.
+        master->start_timer("diff");
+        diff->exec_boundary();
+        master->stop_timer("diff");
 
         // Calculate the thermodynamics and the buoyancy tendency.
+        master->start_timer("thermo");
         thermo->exec();
+        master->stop_timer("thermo");
+
         // Calculate the tendency due to damping in the buffer layer.
+        master->start_timer("buffer");
         buffer->exec();
+        master->stop_timer("buffer");
 
         // Apply the large scale forcings. Keep this one always right before the pressure.
+        master->start_timer("force");
         force->exec(timeloop->get_sub_time_step());
+        master->stop_timer("force");
 
         // Solve the poisson equation for pressure.
+        master->start_timer("pres");
         boundary->set_ghost_cells_w(Boundary::Conservation_type);
         pres->exec(timeloop->get_sub_time_step());
         boundary->set_ghost_cells_w(Boundary::Normal_type);
+        master->stop_timer("pres");
 
         // Allow only for statistics when not in substep and not directly after restart.
         if (timeloop->is_stats_step())
         {
             #ifdef USECUDA
             // Copy fields from device to host
-            if (stats->doStats() || cross->do_cross() || dump->do_dump())
+            if (stats->doStats() || cross->do_cross() || dump->do_dump() || average->do_average() || column->do_column())
             {
                 fields  ->backward_device();
                 boundary->backward_device();
@@ -295,6 +351,11 @@ void Model::exec()
             // Do the statistics.
             if (stats->doStats())
             {
+                master->start_timer("stats");
+
+                // Compute the spectra first, as they need the temporary fields that hold the masks.
+                fields->exec_spectra();
+
                 // Always process the default mask (the full field)
                 stats->get_mask(fields->atmp["tmp3"], fields->atmp["tmp4"], &stats->masks["default"]);
                 calc_stats("default");
@@ -321,21 +382,48 @@ void Model::exec()
 
                 // Store the stats data.
                 stats->exec(timeloop->get_iteration(), timeloop->get_time(), timeloop->get_itime());
+
+                master->stop_timer("stats");
             }
 
             // Save the selected cross sections to disk, cross sections are handled on CPU.
             if (cross->do_cross())
             {
+                master->start_timer("cross");
+                cross   ->start_output();
                 fields  ->exec_cross();
                 thermo  ->exec_cross();
                 boundary->exec_cross();
+                cross   ->finish_output();
+                master->stop_timer("cross");
             }
 
             // Save the 3d dumps to disk
             if (dump->do_dump())
             {
+                master->start_timer("dump");
                 fields->exec_dump();
                 thermo->exec_dump();
+                master->stop_timer("dump");
+            }
+
+            // Accumulate the time averaged 3d fields and save them at the end of the window.
+            if (average->do_average())
+            {
+                master->start_timer("average");
+                average->exec();
+                average->exec_save();
+                master->stop_timer("average");
+            }
+
+            // Sample the columns, which are written to disk at the sync time.
+            if (column->do_column())
+            {
+                master->start_timer("column");
+                fields  ->exec_column();
+                boundary->exec_column();
+                column  ->exec(timeloop->get_iteration(), timeloop->get_time(), timeloop->get_itime());
+                master->stop_timer("column");
             }
         }
 
@@ -347,7 +435,9 @@ void Model::exec()
         if (master->mode == "run")
         {
             // Integrate in time.
+            master->start_timer("timeloop");
             timeloop->exec();
+            master->stop_timer("timeloop");
 
             // Increase the time with the time step.
             timeloop->step_time();
@@ -361,9 +451,15 @@ void Model::exec()
                 #endif
 
                 // Save data to disk.
+                master->start_timer("save");
                 timeloop->save(timeloop->get_iotime());
                 fields  ->save(timeloop->get_iotime());
+                average ->save(timeloop->get_iotime());
+                master->stop_timer("save");
             }
+
+            // Let a pending asynchronous save of the restart files continue in the background.
+            fields->progress_save();
         }
 
         // POST PROCESS MODE: In case of post-process mode, load a new set of files.
@@ -376,29 +472,59 @@ void Model::exec()
             if (timeloop->is_finished())
                 break;
 
-            // Load the data from disk.
+            // Load the data from disk, and start reading the data of the next time.
+            master->start_timer("load");
             timeloop->load(timeloop->get_iotime());
             fields  ->load(timeloop->get_iotime());
+            fields  ->prefetch(timeloop->get_next_post_proc_iotime());
+            master->stop_timer("load");
         }
 
         // Update the time dependent parameters.
         boundary->update_time_dependent();
         force   ->update_time_dependent();
 
-        // Set the boundary conditions.
-        boundary->exec();
+        // Set the boundary conditions, and compute the interior advection and diffusion
+        // tendencies while the ghost cells are being exchanged.
+        master->start_timer("boundary");
+        boundary->exec_start();
+        master->stop_timer("boundary");
+        master->start_timer("advec");
+        advec->exec_interior();
+        master->stop_timer("advec");
+        master->start_timer("diff");
+        diff ->exec_interior();
+        master->stop_timer("diff");
+        master->start_timer("boundary");
+        boundary->exec_end();
+        master->stop_timer("boundary");
 
         // Calculate the field means, in case needed.
+        master->start_timer("fields");
         fields->exec();
+        master->stop_timer("fields");
 
         // Get the viscosity to be used in diffusion.
+        master->start_timer("diff");
         diff->exec_viscosity();
+        master->stop_timer("diff");
 
         // Write status information to disk.
         print_status();
 
     } // End time loop.
 
+    // Complete the asynchronous save of the restart files, in case still pending.
+    master->start_timer("save");
+    fields->finish_save();
+    master->stop_timer("save");
+
+    // Write the samples of the columns since the last sync time.
+    column->write_buffer();
+
+    // Print the time spent per stage of the model.
+    master->print_timers();
+
     #ifdef USECUDA
     // At the end of the run, copy the data back from the GPU.
     fields  ->backward_device();
@@ -412,24 +538,43 @@ void Model::set_time_step()
     if (timeloop->in_substep())
         return;
 
-    // Retrieve the maximum allowed time step per class.
+    master->start_timer("status");
+
+    // Retrieve the maximum allowed time step per class. The limits of advection and diffusion
+    // are computed from the local CFL and diffusion numbers and reduced together, which gives
+    // the same result as the time step limit decreases monotonically with both numbers.
+    unsigned long idtlim[2];
+    grid->begin_deferred_reductions();
+    idtlim[0] = advec->get_time_limit(timeloop->get_idt(), timeloop->get_dt());
+    idtlim[1] = diff ->get_time_limit(timeloop->get_idt(), timeloop->get_dt());
+    grid->end_deferred_reductions();
+    grid->get_min(idtlim, 2);
+
     timeloop->set_time_step_limit();
-    timeloop->set_time_step_limit(advec->get_time_limit(timeloop->get_idt(), timeloop->get_dt()));
-    timeloop->set_time_step_limit(diff ->get_time_limit(timeloop->get_idt(), timeloop->get_dt()));
+    timeloop->set_time_step_limit(idtlim[0]);
+    timeloop->set_time_step_limit(idtlim[1]);
     timeloop->set_time_step_limit(stats->get_time_limit(timeloop->get_itime()));
     timeloop->set_time_step_limit(cross->get_time_limit(timeloop->get_itime()));
     timeloop->set_time_step_limit(dump ->get_time_limit(timeloop->get_itime()));
+    timeloop->set_time_step_limit(average->get_time_limit(timeloop->get_itime()));
+    timeloop->set_time_step_limit(column ->get_time_limit(timeloop->get_itime()));
 
     // Set the time step.
     timeloop->set_time_step();
+
+    master->stop_timer("status");
 }
 
 // Calculate the statistics for all classes that have a statistics function.
 void Model::calc_stats(std::string maskname)
 {
+    // Let the reading of the fields of the next time progress in between the statistics.
     fields  ->exec_stats(&stats->masks[maskname]);
+    fields  ->progress_prefetch();
     thermo  ->exec_stats(&stats->masks[maskname]);
+    fields  ->progress_prefetch();
     budget  ->exec_stats(&stats->masks[maskname]);
+    fields  ->progress_prefetch();
     boundary->exec_stats(&stats->masks[maskname]);
 }
 
@@ -460,11 +605,17 @@ void Model::print_status()
     // Retrieve all the status information.
     if (timeloop->do_check())
     {
+        master->start_timer("status");
+
         // Get status variables.
         iter = timeloop->get_iteration();
         time = timeloop->get_time();
         dt   = timeloop->get_dt();
 
+        // The checks return the values of the local process, which are reduced in
+        // a single call. This is exact, as the checks only scale the sums and maxima.
+        grid->begin_deferred_reductions();
+
         boundary->set_ghost_cells_w(Boundary::Conservation_type);
         div  = pres->check_divergence();
         boundary->set_ghost_cells_w(Boundary::Normal_type);
@@ -475,6 +626,18 @@ void Model::print_status()
         cfl  = advec->get_cfl(timeloop->get_dt());
         dn   = diff->get_dn(timeloop->get_dt());
 
+        grid->end_deferred_reductions();
+
+        grid->add_max(&div);
+        grid->add_sum(&mom);
+        grid->add_sum(&tke);
+        grid->add_sum(&mass);
+        grid->add_max(&cfl);
+        grid->add_max(&dn);
+        grid->exec_reductions();
+
+        master->stop_timer("status");
+
         // Store time interval in betwteen two writes.
         end     = master->get_wall_clock_time();
         cputime = end - start;
@@ -484,6 +647,9 @@ void Model::print_status()
         if (master->mpiid == 0)
             std::fprintf(dnsout, "%8d %11.3E %10.4f %11.3E %8.4f %8.4f %11.3E %16.8E %16.8E %16.8E\n",
                     iter, time, cputime, dt, cfl, dn, div, mom, tke, mass);
+
+        // Write the time spent per stage of the model since the previous check.
+        master->write_timers(iter, time);
     }
 
     if (timeloop->is_finished())
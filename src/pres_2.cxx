@@ -38,6 +38,8 @@ Pres_2::Pres_2(Model* modelin, Input* inputin) : Pres(modelin, inputin)
     work2d = 0;
     bmati  = 0;
     bmatj  = 0;
+    gam    = 0;
+    beti   = 0;
 
 #ifdef USECUDA
     a_g = 0;
@@ -53,6 +55,8 @@ Pres_2::~Pres_2()
     delete[] a;
     delete[] c;
     delete[] work2d;
+    delete[] gam;
+    delete[] beti;
 
     delete[] bmati;
     delete[] bmatj;
@@ -73,8 +77,7 @@ void Pres_2::exec(double dt)
           dt);
 
     // solve the system
-    solve(fields->sd["p"]->data, fields->atmp["tmp1"]->data, fields->atmp["tmp2"]->data,
-          grid->dz, fields->rhoref,
+    solve(fields->sd["p"]->data, fields->atmp["tmp1"]->data, fields->atmp["tmp2"]->data, grid->dz,
           grid->fftini, grid->fftouti, grid->fftinj, grid->fftoutj);
 
     // get the pressure tendencies from the pressure field
@@ -106,6 +109,12 @@ void Pres_2::init()
     c = new double[kmax];
 
     work2d = new double[imax*jmax];
+
+#ifndef USECUDA
+    // the factorization of the tridiagonal matrices is stored for all wave numbers
+    gam  = new double[grid->iblock*grid->jblock*kmax];
+    beti = new double[grid->iblock*grid->jblock*kmax];
+#endif
 }
 
 void Pres_2::set_values()
@@ -139,6 +148,13 @@ void Pres_2::set_values()
         a[k] = grid->dz[k+kgc] * fields->rhorefh[k+kgc  ]*grid->dzhi[k+kgc  ];
         c[k] = grid->dz[k+kgc] * fields->rhorefh[k+kgc+1]*grid->dzhi[k+kgc+1];
     }
+
+#ifndef USECUDA
+    // The matrices only depend on the wave numbers, the grid and the reference density,
+    // thus the factorization can be done once here instead of in every pressure solve.
+    // This function has to be called again if any of these change.
+    tdma_factorize(a, c, gam, beti, grid->dz, fields->rhoref);
+#endif
 }
 
 void Pres_2::input(double* restrict p, 
@@ -167,6 +183,7 @@ void Pres_2::input(double* restrict p,
     grid->boundary_cyclic(vt, North_south_edge);
 
     // write pressure as a 3d array without ghost cells
+#pragma omp parallel for
     for (int k=0; k<grid->kmax; k++)
         for (int j=0; j<grid->jmax; j++)
 #pragma ivdep
@@ -181,8 +198,7 @@ void Pres_2::input(double* restrict p,
             }
 }
 
-void Pres_2::solve(double* restrict p, double* restrict work3d, double* restrict b,
-                   double* restrict dz, double* restrict rhoref,
+void Pres_2::solve(double* restrict p, double* restrict work3d, double* restrict work3d2, double* restrict dz,
                    double* restrict fftini, double* restrict fftouti, 
                    double* restrict fftinj, double* restrict fftoutj)
 {
@@ -195,58 +211,28 @@ void Pres_2::solve(double* restrict p, double* restrict work3d, double* restrict
     const int jgc    = grid->jgc;
     const int kgc    = grid->kgc;
 
-    int i,j,k,jj,kk,ijk;
-    int iindex,jindex;
+    int jj,kk,ijk;
 
-    grid->fft_forward(p, work3d, fftini, fftouti, fftinj, fftoutj);
+    grid->fft_forward(p, work3d, work3d2, fftini, fftouti, fftinj, fftoutj);
 
     jj = iblock;
     kk = iblock*jblock;
 
-    //for (int i=0; i<itot*jtot; ++i)
-    //  printf("%i %e\n",i,p[i]);
-    //exit(1);
-
     // solve the tridiagonal system
-    // create vectors that go into the tridiagonal matrix solver
-    for (k=0; k<kmax; k++)
-        for (j=0; j<jblock; j++)
+    // scale the right hand side, the matrix is already factorized in set_values()
+    for (int k=0; k<kmax; k++)
+        for (int j=0; j<jblock; j++)
 #pragma ivdep
-            for (i=0; i<iblock; i++)
+            for (int i=0; i<iblock; i++)
             {
-                // swap the mpicoords, because domain is turned 90 degrees to avoid two mpi transposes
-                iindex = master->mpicoordy * iblock + i;
-                jindex = master->mpicoordx * jblock + j;
-
                 ijk  = i + j*jj + k*kk;
-                b[ijk] = dz[k+kgc]*dz[k+kgc] * rhoref[k+kgc]*(bmati[iindex]+bmatj[jindex]) - (a[k]+c[k]);
                 p[ijk] = dz[k+kgc]*dz[k+kgc] * p[ijk];
             }
 
-    for (j=0; j<jblock; j++)
-#pragma ivdep
-        for (i=0; i<iblock; i++)
-        {
-            iindex = master->mpicoordy * iblock + i;
-            jindex = master->mpicoordx * jblock + j;
-
-            // substitute BC's
-            ijk = i + j*jj;
-            b[ijk] += a[0];
-
-            // for wave number 0, which contains average, set pressure at top to zero
-            ijk  = i + j*jj + (kmax-1)*kk;
-            if (iindex == 0 && jindex == 0)
-                b[ijk] -= c[kmax-1];
-            // set dp/dz at top to zero
-            else
-                b[ijk] += c[kmax-1];
-        }
-
     // call tdma solver
-    tdma(a, b, c, p, work2d, work3d);
+    tdma(a, gam, beti, p);
 
-    grid->fft_backward(p, work3d, fftini, fftouti, fftinj, fftoutj);
+    grid->fft_backward(p, work3d, work3d2, fftini, fftouti, fftinj, fftoutj);
 
     jj = imax;
     kk = imax*jmax;
@@ -290,6 +276,7 @@ void Pres_2::output(double* restrict ut, double* restrict vt, double* restrict w
     const double dxi = 1./grid->dx;
     const double dyi = 1./grid->dy;
 
+#pragma omp parallel for
     for (int k=grid->kstart; k<grid->kend; k++)
         for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
@@ -302,73 +289,105 @@ void Pres_2::output(double* restrict ut, double* restrict vt, double* restrict w
             }
 }
 
-// tridiagonal matrix solver, taken from Numerical Recipes, Press
-void Pres_2::tdma(double* restrict a, double* restrict b, double* restrict c, 
-                  double* restrict p, double* restrict work2d, double* restrict work3d)
-
+// forward elimination of the tridiagonal matrix solver, taken from Numerical Recipes, Press
+// the elimination factors and the reciprocals of the pivots are stored for all wave numbers
+void Pres_2::tdma_factorize(double* restrict a, double* restrict c,
+                            double* restrict gam, double* restrict beti,
+                            double* restrict dz, double* restrict rhoref)
 {
-    int i,j,k,jj,kk,ijk,ij;
-    int iblock,jblock,kmax;
-
-    iblock = grid->iblock;
-    jblock = grid->jblock;
-    kmax = grid->kmax;
+    const int iblock = grid->iblock;
+    const int jblock = grid->jblock;
+    const int kmax   = grid->kmax;
+    const int kgc    = grid->kgc;
 
-    jj = iblock;
-    kk = iblock*jblock;
+    const int jj = iblock;
+    const int kk = iblock*jblock;
 
-    for (j=0;j<jblock;j++)
+    // create the diagonal of the matrix, store it in beti
+    for (int k=0; k<kmax; k++)
+        for (int j=0; j<jblock; j++)
 #pragma ivdep
-        for (i=0;i<iblock;i++)
-        {
-            ij = i + j*jj;
-            work2d[ij] = b[ij];
-        }
+            for (int i=0; i<iblock; i++)
+            {
+                // swap the mpicoords, because domain is turned 90 degrees to avoid two mpi transposes
+                const int iindex = master->mpicoordy * iblock + i;
+                const int jindex = master->mpicoordx * jblock + j;
 
-    for (j=0;j<jblock;j++)
+                const int ijk = i + j*jj + k*kk;
+                beti[ijk] = dz[k+kgc]*dz[k+kgc] * rhoref[k+kgc]*(bmati[iindex]+bmatj[jindex]) - (a[k]+c[k]);
+            }
+
+    for (int j=0; j<jblock; j++)
 #pragma ivdep
-        for (i=0;i<iblock;i++)
+        for (int i=0; i<iblock; i++)
         {
-            ij = i + j*jj;
-            p[ij] /= work2d[ij];
+            const int iindex = master->mpicoordy * iblock + i;
+            const int jindex = master->mpicoordx * jblock + j;
+
+            // substitute BC's
+            int ijk = i + j*jj;
+            beti[ijk] += a[0];
+
+            // for wave number 0, which contains average, set pressure at top to zero
+            ijk  = i + j*jj + (kmax-1)*kk;
+            if (iindex == 0 && jindex == 0)
+                beti[ijk] -= c[kmax-1];
+            // set dp/dz at top to zero
+            else
+                beti[ijk] += c[kmax-1];
         }
 
-    for (k=1; k<kmax; k++)
-    {
-        for (j=0;j<jblock;j++)
+    // eliminate the lower diagonal, the pivot of the bottom level is the diagonal itself
+    for (int k=1; k<kmax; k++)
+        for (int j=0; j<jblock; j++)
 #pragma ivdep
-            for (i=0;i<iblock;i++)
+            for (int i=0; i<iblock; i++)
             {
-                ij  = i + j*jj;
-                ijk = i + j*jj + k*kk;
-                work3d[ijk] = c[k-1] / work2d[ij];
+                const int ijk = i + j*jj + k*kk;
+                gam [ijk]  = c[k-1] / beti[ijk-kk];
+                beti[ijk] -= a[k]*gam[ijk];
             }
-        for (j=0;j<jblock;j++)
+
+    // store the reciprocals, so that the substitution sweeps do not need divisions
+    for (int n=0; n<iblock*jblock*kmax; n++)
+        beti[n] = 1./beti[n];
+}
+
+// substitution sweeps of the tridiagonal matrix solver using the factorization of tdma_factorize
+void Pres_2::tdma(double* restrict a, double* restrict gam, double* restrict beti,
+                  double* restrict p)
+{
+    const int iblock = grid->iblock;
+    const int jblock = grid->jblock;
+    const int kmax   = grid->kmax;
+
+    const int jj = iblock;
+    const int kk = iblock*jblock;
+
+    for (int j=0; j<jblock; j++)
 #pragma ivdep
-            for (i=0;i<iblock;i++)
-            {
-                ij  = i + j*jj;
-                ijk = i + j*jj + k*kk;
-                work2d[ij] = b[ijk] - a[k]*work3d[ijk];
-            }
-        for (j=0;j<jblock;j++)
+        for (int i=0; i<iblock; i++)
+        {
+            const int ij = i + j*jj;
+            p[ij] *= beti[ij];
+        }
+
+    for (int k=1; k<kmax; k++)
+        for (int j=0; j<jblock; j++)
 #pragma ivdep
-            for (i=0;i<iblock;i++)
+            for (int i=0; i<iblock; i++)
             {
-                ij  = i + j*jj;
-                ijk = i + j*jj + k*kk;
-                p[ijk] -= a[k]*p[ijk-kk];
-                p[ijk] /= work2d[ij];
+                const int ijk = i + j*jj + k*kk;
+                p[ijk] = (p[ijk] - a[k]*p[ijk-kk]) * beti[ijk];
             }
-    }
 
-    for (k=kmax-2; k>=0; k--)
-        for (j=0;j<jblock;j++)
+    for (int k=kmax-2; k>=0; k--)
+        for (int j=0; j<jblock; j++)
 #pragma ivdep
-            for (i=0;i<iblock;i++)
+            for (int i=0; i<iblock; i++)
             {
-                ijk = i + j*jj + k*kk;
-                p[ijk] -= work3d[ijk+kk]*p[ijk+kk];
+                const int ijk = i + j*jj + k*kk;
+                p[ijk] -= gam[ijk+kk]*p[ijk+kk];
             }
 }
 
@@ -49,6 +49,19 @@ Pres_4::Pres_4(Model* modelin, Input* inputin) : Pres(modelin, inputin)
     bmati = 0;
     bmatj = 0;
 
+    m1fac = 0;
+    m2fac = 0;
+    m3fac = 0;
+    m4fac = 0;
+    m5fac = 0;
+    m6fac = 0;
+    m7fac = 0;
+
+    /* The CPU version gives the best performance in case jslice = 1, due to cache misses.
+       In case this value will be set to larger than 1, checks need to be build in for out of bounds
+       reads in case jblock does not divide by 4. */
+    jslice = 1;
+
 #ifdef USECUDA
     bmati_g = 0;
     bmatj_g = 0;
@@ -76,6 +89,14 @@ Pres_4::~Pres_4()
     delete[] m6;
     delete[] m7;
 
+    delete[] m1fac;
+    delete[] m2fac;
+    delete[] m3fac;
+    delete[] m4fac;
+    delete[] m5fac;
+    delete[] m6fac;
+    delete[] m7fac;
+
     delete[] bmati;
     delete[] bmatj;
 
@@ -101,29 +122,12 @@ void Pres_4::exec(double dt)
                     grid->dzi4, dt);
 
     // 2. Solve the Poisson equation using FFTs and a heptadiagonal solver
-
-    /* Find the thickness of a vectorizable slice. There is a need for 8 slices for the pressure
-       solver and we use two three dimensional temp fields, so there are 4 slices per field.
-       The thickness is therefore jblock/4. Since there are always three ghost cells, even in a 2D
-       run the fields are large enough. */
-    // const int jslice = std::max(grid->jblock/4, 1);
-
-    /* The CPU version gives the best performance in case jslice = 1, due to cache misses.
-       In case this value will be set to larger than 1, checks need to be build in for out of bounds
-       reads in case jblock does not divide by 4. */
-    const int jslice = 1;
-
-    double *tmp2 = fields->atmp["tmp2"]->data;
-    double *tmp3 = fields->atmp["tmp3"]->data;
-
-    const int ns = grid->iblock*jslice*(grid->kmax+4);
-
-    solve(fields->sd["p"]->data, fields->atmp["tmp1"]->data, grid->dz,
-          m1, m2, m3, m4,
-          m5, m6, m7,
-          &tmp2[0*ns], &tmp2[1*ns], &tmp2[2*ns], &tmp2[3*ns], 
-          &tmp3[0*ns], &tmp3[1*ns], &tmp3[2*ns], &tmp3[3*ns], 
-          bmati, bmatj,
+    // The matrices have been factorized in set_values(), only the right hand sides of the slices
+    // need temporary space here.
+    solve(fields->sd["p"]->data, fields->atmp["tmp1"]->data, fields->atmp["tmp3"]->data, grid->dz,
+          m1fac, m2fac, m3fac, m4fac,
+          m5fac, m6fac, m7fac,
+          fields->atmp["tmp2"]->data,
           jslice);
 
     // 3. Get the pressure tendencies from the pressure field.
@@ -153,6 +157,18 @@ void Pres_4::init()
     m5 = new double[grid->kmax];
     m6 = new double[grid->kmax];
     m7 = new double[grid->kmax];
+
+#ifndef USECUDA
+    // The LU factorization of the heptadiagonal matrices is stored for all wave numbers.
+    const int nfac = grid->iblock*grid->jblock*(grid->kmax+4);
+    m1fac = new double[nfac];
+    m2fac = new double[nfac];
+    m3fac = new double[nfac];
+    m4fac = new double[nfac];
+    m5fac = new double[nfac];
+    m6fac = new double[nfac];
+    m7fac = new double[nfac];
+#endif
 }
 
 void Pres_4::set_values()
@@ -225,6 +241,14 @@ void Pres_4::set_values()
     m5[k] = (                  +  27.*dzhi4[kc] + 729.*dzhi4[kc+1] -  1.*dzhi4[kc] ) * dzi4[kc];
     m6[k] = (                                   -  27.*dzhi4[kc+1]                 ) * dzi4[kc];
     m7[k] = 0.;
+
+#ifndef USECUDA
+    // The matrices only depend on the wave numbers and the grid, thus the factorization
+    // can be done once here instead of in every pressure solve.
+    factorize(m1, m2, m3, m4, m5, m6, m7,
+              m1fac, m2fac, m3fac, m4fac, m5fac, m6fac, m7fac,
+              bmati, bmatj, jslice);
+#endif
 }
 
 template<bool dim3>
@@ -259,6 +283,7 @@ void Pres_4::input(double* restrict p,
         grid->boundary_cyclic(vt, North_south_edge);
 
     // Set the bc. 
+#pragma omp parallel for
     for (int j=0; j<grid->jmax; j++)
 #pragma ivdep
         for (int i=0; i<grid->imax; i++)
@@ -266,6 +291,7 @@ void Pres_4::input(double* restrict p,
             const int ijk  = i+igc + (j+jgc)*jj1 + kgc*kk1;
             wt[ijk-kk1] = -wt[ijk+kk1];
         }
+#pragma omp parallel for
     for (int j=0; j<grid->jmax; j++)
 #pragma ivdep
         for (int i=0; i<grid->imax; i++)
@@ -274,6 +300,7 @@ void Pres_4::input(double* restrict p,
             wt[ijk+kk1] = -wt[ijk-kk1];
         }
 
+#pragma omp parallel for
     for (int k=0; k<grid->kmax; k++)
         for (int j=0; j<grid->jmax; j++)
 #pragma ivdep
@@ -288,36 +315,28 @@ void Pres_4::input(double* restrict p,
             }
 }
 
-void Pres_4::solve(double* restrict p, double* restrict work3d, double* restrict dz,
-                   double* restrict m1, double* restrict m2, double* restrict m3, double* restrict m4,
-                   double* restrict m5, double* restrict m6, double* restrict m7,
-                   double* restrict m1temp, double* restrict m2temp, double* restrict m3temp, double* restrict m4temp,
-                   double* restrict m5temp, double* restrict m6temp, double* restrict m7temp, double* restrict ptemp,
-                   double* restrict bmati, double* restrict bmatj,
-                   const int jslice)
+void Pres_4::factorize(double* restrict m1, double* restrict m2, double* restrict m3, double* restrict m4,
+                       double* restrict m5, double* restrict m6, double* restrict m7,
+                       double* restrict m1fac, double* restrict m2fac, double* restrict m3fac, double* restrict m4fac,
+                       double* restrict m5fac, double* restrict m6fac, double* restrict m7fac,
+                       double* restrict bmati, double* restrict bmatj,
+                       const int jslice)
 {
-    const int imax   = grid->imax;
-    const int jmax   = grid->jmax;
     const int kmax   = grid->kmax;
     const int iblock = grid->iblock;
     const int jblock = grid->jblock;
-    const int igc    = grid->igc;
-    const int jgc    = grid->jgc;
-    const int kgc    = grid->kgc;
-
-    grid->fft_forward(p, work3d, grid->fftini, grid->fftouti, grid->fftinj, grid->fftoutj);
 
-    int jj,kk,ik,ijk;
+    int jj,ik;
     int iindex,jindex;
 
     jj = iblock;
-    kk = iblock*jblock;
 
     const int mpicoordx = master->mpicoordx;
     const int mpicoordy = master->mpicoordy;
 
     // Calculate the step size.
     const int nj = jblock/jslice;
+    const int ns = iblock*jslice*(kmax+4);
 
     const int kki1 = 1*iblock*jslice;
     const int kki2 = 2*iblock*jslice;
@@ -325,6 +344,15 @@ void Pres_4::solve(double* restrict p, double* restrict work3d, double* restrict
 
     for (int n=0; n<nj; ++n)
     {
+        // Each slice is stored contiguously, in the layout that hdma expects.
+        double* restrict m1temp = &m1fac[n*ns];
+        double* restrict m2temp = &m2fac[n*ns];
+        double* restrict m3temp = &m3fac[n*ns];
+        double* restrict m4temp = &m4fac[n*ns];
+        double* restrict m5temp = &m5fac[n*ns];
+        double* restrict m6temp = &m6fac[n*ns];
+        double* restrict m7temp = &m7fac[n*ns];
+
         for (int j=0; j<jslice; ++j)
 #pragma ivdep
             for (int i=0; i<iblock; ++i)
@@ -338,7 +366,6 @@ void Pres_4::solve(double* restrict p, double* restrict work3d, double* restrict
                 m5temp[ik] =  0.;
                 m6temp[ik] =  0.;
                 m7temp[ik] = -1.;
-                ptemp [ik] =  0.;
             }
 
         for (int j=0; j<jslice; ++j)
@@ -353,7 +380,6 @@ void Pres_4::solve(double* restrict p, double* restrict work3d, double* restrict
                 m5temp[ik+kki1] = -1.;
                 m6temp[ik+kki1] =  0.;
                 m7temp[ik+kki1] =  0.;
-                ptemp [ik+kki1] =  0.;
             }
 
         for (int k=0; k<kmax; ++k)
@@ -366,7 +392,6 @@ void Pres_4::solve(double* restrict p, double* restrict work3d, double* restrict
                     // Swap the mpicoords, because domain is turned 90 degrees to avoid two mpi transposes.
                     iindex = mpicoordy*iblock + i;
 
-                    ijk = i + (j + n*jslice)*jj + k*kk;
                     ik  = i + j*jj + k*kki1;
                     m1temp[ik+kki2] = m1[k];
                     m2temp[ik+kki2] = m2[k];
@@ -375,7 +400,6 @@ void Pres_4::solve(double* restrict p, double* restrict work3d, double* restrict
                     m5temp[ik+kki2] = m5[k];
                     m6temp[ik+kki2] = m6[k];
                     m7temp[ik+kki2] = m7[k];
-                    ptemp [ik+kki2] = p[ijk];
                 }
             }
 
@@ -427,15 +451,85 @@ void Pres_4::solve(double* restrict p, double* restrict work3d, double* restrict
                 m5temp[ik+kki2] = 0.;
                 m6temp[ik+kki2] = 0.;
                 m7temp[ik+kki2] = 0.;
-                ptemp [ik+kki2] = 0.;
 
                 m5temp[ik+kki3] = 0.;
                 m6temp[ik+kki3] = 0.;
                 m7temp[ik+kki3] = 0.;
-                ptemp [ik+kki3] = 0.;
             }
 
-        hdma(m1temp, m2temp, m3temp, m4temp, m5temp, m6temp, m7temp, ptemp, jslice);
+        hdma_factorize(m1temp, m2temp, m3temp, m4temp, m5temp, m6temp, m7temp, jslice);
+    }
+}
+
+void Pres_4::solve(double* restrict p, double* restrict work3d, double* restrict work3d2, double* restrict dz,
+                   double* restrict m1fac, double* restrict m2fac, double* restrict m3fac, double* restrict m4fac,
+                   double* restrict m5fac, double* restrict m6fac, double* restrict m7fac,
+                   double* restrict ptemp,
+                   const int jslice)
+{
+    const int imax   = grid->imax;
+    const int jmax   = grid->jmax;
+    const int kmax   = grid->kmax;
+    const int iblock = grid->iblock;
+    const int jblock = grid->jblock;
+    const int igc    = grid->igc;
+    const int jgc    = grid->jgc;
+    const int kgc    = grid->kgc;
+
+    grid->fft_forward(p, work3d, work3d2, grid->fftini, grid->fftouti, grid->fftinj, grid->fftoutj);
+
+    int jj,kk,ijk;
+
+    jj = iblock;
+    kk = iblock*jblock;
+
+    // Calculate the step size.
+    const int nj = jblock/jslice;
+    const int ns = iblock*jslice*(kmax+4);
+
+    const int kki1 = 1*iblock*jslice;
+    const int kki2 = 2*iblock*jslice;
+    const int kki3 = 3*iblock*jslice;
+
+    // The factorizations of the slices are independent. Every slice has its own part of ptemp,
+    // which is as large as the factorizations, such that the slices are solved in parallel.
+#pragma omp parallel for
+    for (int n=0; n<nj; ++n)
+    {
+        double* restrict pslice = &ptemp[n*ns];
+
+        for (int j=0; j<jslice; ++j)
+#pragma ivdep
+            for (int i=0; i<iblock; ++i)
+            {
+                // Set a zero gradient bc at the bottom.
+                const int ik = i + j*jj;
+                pslice[ik     ] = 0.;
+                pslice[ik+kki1] = 0.;
+            }
+
+        for (int k=0; k<kmax; ++k)
+            for (int j=0; j<jslice; ++j)
+#pragma ivdep
+                for (int i=0; i<iblock; ++i)
+                {
+                    const int ijk = i + (j + n*jslice)*jj + k*kk;
+                    const int ik  = i + j*jj + k*kki1;
+                    pslice[ik+kki2] = p[ijk];
+                }
+
+        for (int j=0; j<jslice; ++j)
+#pragma ivdep
+            for (int i=0; i<iblock; ++i)
+            {
+                // Set the top boundary.
+                const int ik = i + j*jj + kmax*kki1;
+                pslice[ik+kki2] = 0.;
+                pslice[ik+kki3] = 0.;
+            }
+
+        hdma(&m1fac[n*ns], &m2fac[n*ns], &m3fac[n*ns], &m4fac[n*ns],
+             &m5fac[n*ns], &m6fac[n*ns], &m7fac[n*ns], pslice, jslice);
 
         // Put back the solution.
         for (int k=0; k<kmax; ++k)
@@ -445,11 +539,11 @@ void Pres_4::solve(double* restrict p, double* restrict work3d, double* restrict
                 {
                     const int ik  = i + j*jj + k*kki1;
                     const int ijk = i + (j + n*jslice)*jj + k*kk;
-                    p[ijk] = ptemp[ik+kki2];
+                    p[ijk] = pslice[ik+kki2];
                 }
     }
 
-    grid->fft_backward(p, work3d, grid->fftini, grid->fftouti, grid->fftinj, grid->fftoutj);
+    grid->fft_backward(p, work3d, work3d2, grid->fftini, grid->fftouti, grid->fftinj, grid->fftoutj);
 
     // Put the pressure back onto the original grid including ghost cells.
     jj = imax;
@@ -460,6 +554,7 @@ void Pres_4::solve(double* restrict p, double* restrict work3d, double* restrict
     kkp1 = 1*grid->ijcells;
     kkp2 = 2*grid->ijcells;
 
+#pragma omp parallel for private(ijk, ijkp)
     for (int k=0; k<grid->kmax; k++)
         for (int j=0; j<grid->jmax; j++)
 #pragma ivdep
@@ -471,6 +566,7 @@ void Pres_4::solve(double* restrict p, double* restrict work3d, double* restrict
             }
 
     // Set a zero gradient boundary at the bottom.
+#pragma omp parallel for private(ijk)
     for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; i++)
@@ -481,6 +577,7 @@ void Pres_4::solve(double* restrict p, double* restrict work3d, double* restrict
         }
 
     // Set a zero gradient boundary at the top.
+#pragma omp parallel for private(ijk)
     for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; i++)
@@ -510,6 +607,7 @@ void Pres_4::output(double* restrict ut, double* restrict vt, double* restrict w
     const double dxi = 1./grid->dx;
     const double dyi = 1./grid->dy;
 
+#pragma omp parallel for
     for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; i++)
@@ -520,6 +618,7 @@ void Pres_4::output(double* restrict ut, double* restrict vt, double* restrict w
                 vt[ijk] -= (cg0*p[ijk-jj2] + cg1*p[ijk-jj1] + cg2*p[ijk] + cg3*p[ijk+jj1]) * cgi*dyi;
         }
 
+#pragma omp parallel for
     for (int k=grid->kstart+1; k<grid->kend; k++)
         for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
@@ -533,9 +632,9 @@ void Pres_4::output(double* restrict ut, double* restrict vt, double* restrict w
             }
 }
 
-void Pres_4::hdma(double* restrict m1, double* restrict m2, double* restrict m3, double* restrict m4,
-                  double* restrict m5, double* restrict m6, double* restrict m7, double* restrict p,
-                  const int jslice)
+void Pres_4::hdma_factorize(double* restrict m1, double* restrict m2, double* restrict m3, double* restrict m4,
+                            double* restrict m5, double* restrict m6, double* restrict m7,
+                            const int jslice)
 {
     const int kmax   = grid->kmax;
     const int iblock = grid->iblock;
@@ -644,6 +743,22 @@ void Pres_4::hdma(double* restrict m1, double* restrict m2, double* restrict m3,
             m6[ik] = 1.;
             m7[ik] = 1.;
         }
+}
+
+void Pres_4::hdma(double* restrict m1, double* restrict m2, double* restrict m3, double* restrict m4,
+                  double* restrict m5, double* restrict m6, double* restrict m7, double* restrict p,
+                  const int jslice)
+{
+    const int kmax   = grid->kmax;
+    const int iblock = grid->iblock;
+
+    const int jj = grid->iblock;
+
+    const int kk1 = 1*grid->iblock*jslice;
+    const int kk2 = 2*grid->iblock*jslice;
+    const int kk3 = 3*grid->iblock*jslice;
+
+    int k,ik;
 
     // Do the backward substitution.
     // First, solve Ly = p, forward.
@@ -22,6 +22,7 @@
 
 #include <cstdio>
 #include <cmath>
+#include <algorithm>
 #include "master.h"
 #include "grid.h"
 #include "fields.h"
@@ -44,11 +45,35 @@ Stats::Stats(Model* modelin, Input* inputin)
     nmask  = 0;
     nmaskh = 0;
 
+    nstats    = 0;
+    nbuffered = 0;
+
+    defersums = false;
+
     int nerror = 0;
     nerror += inputin->get_item(&swstats, "stats", "swstats", "", "0");
 
     if (swstats == "1")
+    {
         nerror += inputin->get_item(&sampletime, "stats", "sampletime", "");
+        nerror += inputin->get_item(&synctime  , "stats", "synctime"  , "", sampletime);
+        nerror += inputin->get_item(&swnetcdf4 , "stats", "swnetcdf4" , "", "0");
+
+        if (!(swnetcdf4 == "0" || swnetcdf4 == "1"))
+        {
+            ++nerror;
+            master->print_error("\"%s\" is an illegal value for swnetcdf4\n", swnetcdf4.c_str());
+        }
+
+        nerror += inputin->get_list(&spectralist, "stats", "spectralist", "");
+        nerror += inputin->get_item(&swspectra2d, "stats", "swspectra2d", "", "0");
+
+        if (!(swspectra2d == "0" || swspectra2d == "1"))
+        {
+            ++nerror;
+            master->print_error("\"%s\" is an illegal value for swspectra2d\n", swspectra2d.c_str());
+        }
+    }
 
     if (!(swstats == "0" || swstats == "1"))
     {
@@ -62,6 +87,10 @@ Stats::Stats(Model* modelin, Input* inputin)
 
 Stats::~Stats()
 {
+    // write the samples that are still in memory before the files are closed
+    if (swstats == "1")
+        write_buffer();
+
     delete[] nmask;
     delete[] nmaskh;
 
@@ -71,6 +100,8 @@ Stats::~Stats()
         delete it->second.dataFile;
         for (Prof_map::const_iterator it2=it->second.profs.begin(); it2!=it->second.profs.end(); ++it2)
             delete[] it2->second.data;
+        for (Spec_map::const_iterator it2=it->second.specs.begin(); it2!=it->second.specs.end(); ++it2)
+            delete[] it2->second.data;
     }
 }
 
@@ -89,8 +120,28 @@ void Stats::init(double ifactor)
     nmask  = new int[grid->kcells];
     nmaskh = new int[grid->kcells];
 
-    // set the number of stats to zero
-    nstats = 0;
+    // The wave numbers of the spectra run from zero up to the Nyquist wave number. The bins of the
+    // radially averaged spectra have the width of the coarsest resolved wave number and extend up to
+    // the corners of the spectral plane.
+    nkx = grid->itot/2 + 1;
+    nky = grid->jtot/2 + 1;
+
+    const double pi  = std::acos(-1.);
+    const double dkx = 2.*pi/grid->xsize;
+    const double dky = 2.*pi/grid->ysize;
+    dkr = std::max(dkx, dky);
+    nkr = static_cast<int>(std::sqrt(std::pow((nkx-1)*dkx, 2) + std::pow((nky-1)*dky, 2)) / dkr + 0.5) + 1;
+
+    if (swstats == "1")
+    {
+        isynctime = (unsigned long)(ifactor * synctime);
+
+        if (isynctime < isampletime || isynctime % isampletime != 0)
+        {
+            master->print_error("synctime = %f has to be a multiple of sampletime = %f\n", synctime, sampletime);
+            throw 1;
+        }
+    }
 }
 
 void Stats::create(int n)
@@ -100,31 +151,38 @@ void Stats::create(int n)
         return;
 
     int nerror = 0;
+    int nfile  = 0;
+
+    const NcFile::FileFormat ncformat = (swnetcdf4 == "1") ? NcFile::Netcdf4 : NcFile::Classic;
 
     for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it)
     {
         // shortcut
         Mask* m = &it->second;
 
+        // The files of the masks are spread over the processes, as all processes hold the statistics.
+        m->iorank = nfile % master->nprocs;
+        ++nfile;
+
         // create a NetCDF file for the statistics
-        if (master->mpiid == 0)
+        if (master->mpiid == m->iorank)
         {
             char filename[256];
             std::sprintf(filename, "%s.%s.%07d.nc", master->simname.c_str(), m->name.c_str(), n);
-            m->dataFile = new NcFile(filename, NcFile::New);
+            m->dataFile = new NcFile(filename, NcFile::New, NULL, 0, ncformat);
             if (!m->dataFile->is_valid())
-            {
-                master->print_error("cannot write statistics file\n");
                 ++nerror;
-            }
         }
         // crash on all processes in case the file could not be written
-        master->broadcast(&nerror, 1);
+        master->sum(&nerror, 1);
         if (nerror)
+        {
+            master->print_error("cannot write statistics file of mask %s\n", m->name.c_str());
             throw 1;
+        }
 
         // create dimensions
-        if (master->mpiid == 0)
+        if (master->mpiid == m->iorank)
         {
             m->z_dim  = m->dataFile->add_dim("z" , grid->kmax);
             m->zh_dim = m->dataFile->add_dim("zh", grid->kmax+1);
@@ -154,6 +212,47 @@ void Stats::create(int n)
             z_var ->put(&grid->z [grid->kstart], grid->kmax  );
             zh_var->put(&grid->zh[grid->kstart], grid->kmax+1);
 
+            // the spectra are only written to the file of the default mask
+            if (m->name == "default" && !spectralist.empty())
+            {
+                const double pi = std::acos(-1.);
+
+                m->kx_dim = m->dataFile->add_dim("kx", nkx);
+                m->ky_dim = m->dataFile->add_dim("ky", nky);
+
+                NcVar* kx_var = m->dataFile->add_var("kx", ncDouble, m->kx_dim);
+                kx_var->add_att("units", "m-1");
+                kx_var->add_att("long_name", "Wave number in x-direction");
+
+                NcVar* ky_var = m->dataFile->add_var("ky", ncDouble, m->ky_dim);
+                ky_var->add_att("units", "m-1");
+                ky_var->add_att("long_name", "Wave number in y-direction");
+
+                std::vector<double> kx(nkx), ky(nky);
+                for (int i=0; i<nkx; ++i)
+                    kx[i] = 2.*pi*i/grid->xsize;
+                for (int j=0; j<nky; ++j)
+                    ky[j] = 2.*pi*j/grid->ysize;
+
+                kx_var->put(&kx[0], nkx);
+                ky_var->put(&ky[0], nky);
+
+                if (swspectra2d == "1")
+                {
+                    m->kr_dim = m->dataFile->add_dim("kr", nkr);
+
+                    NcVar* kr_var = m->dataFile->add_var("kr", ncDouble, m->kr_dim);
+                    kr_var->add_att("units", "m-1");
+                    kr_var->add_att("long_name", "Horizontal wave number");
+
+                    std::vector<double> kr(nkr);
+                    for (int n=0; n<nkr; ++n)
+                        kr[n] = n*dkr;
+
+                    kr_var->put(&kr[0], nkr);
+                }
+            }
+
             m->dataFile->sync();
         }
 
@@ -198,29 +297,86 @@ void Stats::exec(int iteration, double time, unsigned long itime)
     // write message in case stats is triggered
     master->print_message("Saving stats for time %f\n", model->timeloop->get_time());
 
+    for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it)
+    {
+        // shortcut
+        Mask* m = &it->second;
+
+        // keep the sample in memory until the next sync
+        if (master->mpiid == m->iorank)
+        {
+            m->tbuf   .push_back(time);
+            m->iterbuf.push_back(iteration);
+
+            for (Prof_map::iterator it=m->profs.begin(); it!=m->profs.end(); ++it)
+                it->second.buffer.insert(it->second.buffer.end(),
+                                         &it->second.data[grid->kstart], &it->second.data[grid->kstart+it->second.nlevels]);
+
+            for (Time_series_map::iterator it=m->tseries.begin(); it!=m->tseries.end(); ++it)
+                it->second.buffer.push_back(it->second.data);
+
+            for (Spec_map::iterator it=m->specs.begin(); it!=m->specs.end(); ++it)
+                it->second.buffer.insert(it->second.buffer.end(),
+                                         it->second.data, it->second.data + grid->kmax*it->second.nwaves);
+        }
+    }
+
+    ++nbuffered;
+
+    // write all samples in memory at once
+    if (itime % isynctime == 0)
+        write_buffer();
+}
+
+void Stats::write_buffer()
+{
+    if (nbuffered == 0)
+        return;
+
     for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it)
     {
         // shortcut
         Mask* m = &it->second;
 
         // put the data into the NetCDF file
-        if (master->mpiid == 0)
+        if (master->mpiid == m->iorank && m->dataFile != 0)
         {
-            m->t_var   ->put_rec(&time     , nstats);
-            m->iter_var->put_rec(&iteration, nstats);
+            m->t_var->set_cur(nstats);
+            m->t_var->put(&m->tbuf[0], nbuffered);
+            m->tbuf.clear();
 
-            for (Prof_map::const_iterator it=m->profs.begin(); it!=m->profs.end(); ++it)
-                m->profs[it->first].ncvar->put_rec(&m->profs[it->first].data[grid->kstart], nstats);
+            m->iter_var->set_cur(nstats);
+            m->iter_var->put(&m->iterbuf[0], nbuffered);
+            m->iterbuf.clear();
 
-            for (Time_series_map::const_iterator it=m->tseries.begin(); it!=m->tseries.end(); ++it)
-                m->tseries[it->first].ncvar->put_rec(&m->tseries[it->first].data, nstats);
+            for (Prof_map::iterator it=m->profs.begin(); it!=m->profs.end(); ++it)
+            {
+                it->second.ncvar->set_cur(nstats, 0);
+                it->second.ncvar->put(&it->second.buffer[0], nbuffered, it->second.nlevels);
+                it->second.buffer.clear();
+            }
+
+            for (Time_series_map::iterator it=m->tseries.begin(); it!=m->tseries.end(); ++it)
+            {
+                it->second.ncvar->set_cur(nstats);
+                it->second.ncvar->put(&it->second.buffer[0], nbuffered);
+                it->second.buffer.clear();
+            }
+
+            for (Spec_map::iterator it=m->specs.begin(); it!=m->specs.end(); ++it)
+            {
+                it->second.ncvar->set_cur(nstats, 0, 0);
+                it->second.ncvar->put(&it->second.buffer[0], nbuffered, grid->kmax, it->second.nwaves);
+                it->second.buffer.clear();
+            }
 
             // sync the data
             m->dataFile->sync();
         }
     }
 
-    ++nstats;
+    nstats += nbuffered;
+    nbuffered = 0;
 }
 
 std::string Stats::get_switch()
@@ -232,6 +388,10 @@ void Stats::add_mask(const std::string maskname)
 {
     masks[maskname].name = maskname;
     masks[maskname].dataFile = 0;
+    masks[maskname].iorank = 0;
+    masks[maskname].kx_dim = 0;
+    masks[maskname].ky_dim = 0;
+    masks[maskname].kr_dim = 0;
 }
 
 void Stats::add_prof(std::string name, std::string longname, std::string unit, std::string zloc)
@@ -245,7 +405,7 @@ void Stats::add_prof(std::string name, std::string longname, std::string unit, s
         Mask* m = &it->second;
 
         // create the NetCDF variable
-        if (master->mpiid == 0)
+        if (master->mpiid == m->iorank)
         {
             if (zloc == "z")
             {
@@ -262,6 +422,8 @@ void Stats::add_prof(std::string name, std::string longname, std::string unit, s
             m->profs[name].ncvar->add_att("_FillValue", NC_FILL_DOUBLE);
         }
 
+        m->profs[name].nlevels = (zloc == "zh") ? grid->kmax+1 : grid->kmax;
+
         // and allocate the memory and initialize at zero
         m->profs[name].data = new double[grid->kcells];
         for (int k=0; k<grid->kcells; ++k)
@@ -284,7 +446,7 @@ void Stats::add_fixed_prof(std::string name, std::string longname, std::string u
 
         // create the NetCDF variable
         NcVar* var = 0;
-        if (master->mpiid == 0)
+        if (master->mpiid == m->iorank)
         {
             if (zloc == "z")
                 var = m->dataFile->add_var(name.c_str(), ncDouble, m->z_dim);
@@ -316,7 +478,7 @@ void Stats::add_time_series(std::string name, std::string longname, std::string
         Mask* m = &it->second;
 
         // create the NetCDF variable
-        if (master->mpiid == 0)
+        if (master->mpiid == m->iorank)
         {
             m->tseries[name].ncvar = m->dataFile->add_var(name.c_str(), ncDouble, m->t_dim);
             m->tseries[name].ncvar->add_att("units", unit.c_str());
@@ -332,6 +494,127 @@ void Stats::add_time_series(std::string name, std::string longname, std::string
         throw 1;
 }
 
+std::vector<std::string>* Stats::get_spectralist()
+{
+    return &spectralist;
+}
+
+/**
+ * This function adds the spectra in the x- and y-direction of a field, and the radially averaged
+ * spectrum if enabled, to the file of the default mask. The spectra are stored per full level.
+ */
+void Stats::add_spectra(std::string name, std::string longname, std::string unit)
+{
+    Mask* m = &masks["default"];
+
+    const int nspec = (swspectra2d == "1") ? 3 : 2;
+    const std::string suffix[3] = {"specx", "specy", "specr"};
+    const std::string dir   [3] = {"x-direction", "y-direction", "radial direction"};
+    const int nwaves[3] = {nkx, nky, nkr};
+
+    for (int n=0; n<nspec; ++n)
+    {
+        Spec_var* spec = &m->specs[name + suffix[n]];
+
+        if (master->mpiid == m->iorank)
+        {
+            NcDim* kdim = (n == 0) ? m->kx_dim : (n == 1) ? m->ky_dim : m->kr_dim;
+            spec->ncvar = m->dataFile->add_var((name + suffix[n]).c_str(), ncDouble, m->t_dim, m->z_dim, kdim);
+            spec->ncvar->add_att("units", ("(" + unit + ")2").c_str());
+            spec->ncvar->add_att("long_name", ("Spectrum in the " + dir[n] + " of the " + longname).c_str());
+            spec->ncvar->add_att("_FillValue", NC_FILL_DOUBLE);
+        }
+
+        spec->nwaves = nwaves[n];
+        spec->data = new double[grid->kmax*spec->nwaves];
+    }
+}
+
+/**
+ * This function computes the spectra of a field per level with the Fourier transforms of the pressure solver.
+ * The spectra are normalized such that their sum over all wave numbers equals the mean of the squared field
+ * over the horizontal plane. The transformed field is in the half-complex format of FFTW, in which every
+ * wave number other than the mean and the Nyquist wave number has a cosine and a sine coefficient, which each
+ * count double. Therefore, the energy of a mode is the weighted square of its coefficient.
+ */
+void Stats::calc_spectra(std::string name, double* restrict data,
+                         double* restrict tmp1, double* restrict tmp2, double* restrict tmp3)
+{
+    const int jj  = grid->icells;
+    const int kk  = grid->ijcells;
+    const int jjb = grid->imax;
+    const int kkb = grid->imax*grid->jmax;
+
+    const int itot   = grid->itot;
+    const int jtot   = grid->jtot;
+    const int kmax   = grid->kmax;
+    const int iblock = grid->iblock;
+    const int jblock = grid->jblock;
+
+    // write the field as a 3d array without ghost cells
+    for (int k=0; k<kmax; ++k)
+        for (int j=0; j<grid->jmax; ++j)
+#pragma ivdep
+            for (int i=0; i<grid->imax; ++i)
+            {
+                const int ijk  = i+grid->igc + (j+grid->jgc)*jj + (k+grid->kgc)*kk;
+                const int ijkb = i + j*jjb + k*kkb;
+                tmp1[ijkb] = data[ijk];
+            }
+
+    grid->fft_forward(tmp1, tmp2, tmp3, grid->fftini, grid->fftouti, grid->fftinj, grid->fftoutj);
+
+    Mask* m = &masks["default"];
+    double* restrict specx = m->specs[name + "specx"].data;
+    double* restrict specy = m->specs[name + "specy"].data;
+    double* restrict specr = (swspectra2d == "1") ? m->specs[name + "specr"].data : 0;
+
+    for (int n=0; n<kmax*nkx; ++n)
+        specx[n] = 0.;
+    for (int n=0; n<kmax*nky; ++n)
+        specy[n] = 0.;
+    if (specr)
+        for (int n=0; n<kmax*nkr; ++n)
+            specr[n] = 0.;
+
+    const double pi  = std::acos(-1.);
+    const double dkx = 2.*pi/grid->xsize;
+    const double dky = 2.*pi/grid->ysize;
+    const double norm = 1./((double)itot*jtot*itot*jtot);
+
+    // the transformed field is turned 90 degrees, see the pressure solver
+    for (int j=0; j<jblock; ++j)
+    {
+        const int jindex = master->mpicoordx*jblock + j;
+        const int q  = (jindex <= jtot/2) ? jindex : jtot-jindex;
+        const double wy = (q == 0 || 2*q == jtot) ? 1. : 2.;
+
+        for (int i=0; i<iblock; ++i)
+        {
+            const int iindex = master->mpicoordy*iblock + i;
+            const int p  = (iindex <= itot/2) ? iindex : itot-iindex;
+            const double wx = (p == 0 || 2*p == itot) ? 1. : 2.;
+
+            const int r = static_cast<int>(std::sqrt(std::pow(p*dkx, 2) + std::pow(q*dky, 2)) / dkr + 0.5);
+
+            for (int k=0; k<kmax; ++k)
+            {
+                const int ijk = i + j*iblock + k*iblock*jblock;
+                const double e = norm*wx*wy*tmp1[ijk]*tmp1[ijk];
+                specx[k*nkx + p] += e;
+                specy[k*nky + q] += e;
+                if (specr)
+                    specr[k*nkr + r] += e;
+            }
+        }
+    }
+
+    master->sum(specx, kmax*nkx);
+    master->sum(specy, kmax*nky);
+    if (specr)
+        master->sum(specr, kmax*nkr);
+}
+
 void Stats::get_mask(Field3d* mfield, Field3d* mfieldh, Mask* m)
 {
     calc_mask(mfield->data, mfieldh->data, mfieldh->databot,
@@ -375,6 +658,69 @@ void Stats::calc_area(double* restrict area, const int loc[3], int* restrict nma
     }
 }
 
+/**
+ * This function lets the calc functions keep the local sums of their profiles,
+ * such that all profiles are reduced at once with a single call in end_deferred_sums.
+ */
+void Stats::begin_deferred_sums()
+{
+    defersums = true;
+}
+
+void Stats::end_deferred_sums()
+{
+    defersums = false;
+
+    const int nprofs = deferredprofs.size();
+    if (nprofs == 0)
+        return;
+
+    const int kcells = grid->kcells;
+
+    // pack the profiles into one buffer, to reduce them with a single call
+    std::vector<double> sums(nprofs*kcells);
+    for (int n=0; n<nprofs; ++n)
+        for (int k=0; k<kcells; ++k)
+            sums[n*kcells+k] = deferredprofs[n].prof[k];
+
+    master->sum(&sums[0], nprofs*kcells);
+
+    for (int n=0; n<nprofs; ++n)
+    {
+        for (int k=0; k<kcells; ++k)
+            deferredprofs[n].prof[k] = sums[n*kcells+k];
+
+        normalize_prof(deferredprofs[n].prof, deferredprofs[n].nmask, deferredprofs[n].datamean);
+    }
+
+    deferredprofs.clear();
+}
+
+void Stats::sum_prof(double* prof, const int* nmask, const double* datamean)
+{
+    if (defersums)
+    {
+        Deferred_prof deferred = {prof, nmask, datamean};
+        deferredprofs.push_back(deferred);
+        return;
+    }
+
+    master->sum(prof, grid->kcells);
+    normalize_prof(prof, nmask, datamean);
+}
+
+void Stats::normalize_prof(double* restrict prof, const int* restrict nmask, const double* restrict datamean)
+{
+    // in case a mean is given, the levels on which the mean is missing are missing as well
+    for (int k=1; k<grid->kcells; k++)
+    {
+        if (nmask[k] > nthres && (datamean == 0 || (datamean[k-1] != NC_FILL_DOUBLE && datamean[k] != NC_FILL_DOUBLE)))
+            prof[k] /= (double)(nmask[k]);
+        else
+            prof[k] = NC_FILL_DOUBLE;
+    }
+}
+
 void Stats::calc_mean(double* const restrict prof, const double* const restrict data,
                       const double offset, const int loc[3],
                       const double* const restrict mask, const int * const restrict nmask)
@@ -394,15 +740,7 @@ void Stats::calc_mean(double* const restrict prof, const double* const restrict
             }
     }
 
-    master->sum(prof, grid->kcells);
-
-    for (int k=1; k<grid->kcells; k++)
-    {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
+    sum_prof(prof, nmask, 0);
 }
 
 void Stats::calc_mean2d(double* const restrict mean, const double* const restrict data,
@@ -602,15 +940,69 @@ void Stats::calc_moment(double* restrict data, double* restrict datamean, double
             }
     }
 
-    master->sum(prof, grid->kcells);
+    sum_prof(prof, nmask, 0);
+}
 
-    for (int k=1; k<grid->kcells; k++)
+/**
+ * This function calculates the second, third and fourth moment, the gradient, the turbulent
+ * flux and the diffusive flux of a field in a single sweep for the second order scheme.
+ * The profiles that are not needed can be given as zero pointers.
+ */
+void Stats::calc_stats_2nd(double* restrict data, double* restrict datamean, double* restrict w, double* restrict wmean,
+                           double* restrict prof2, double* restrict prof3, double* restrict prof4,
+                           double* restrict profgrad, double* restrict profflux, double* restrict profdiff,
+                           double* restrict dzhi, double visc, const int loc[3],
+                           double* restrict mask, int* restrict nmask, double* restrict maskh, int* restrict nmaskh)
+{
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+
+    // offset of the neighbor with which w is interpolated to the location of the flux
+    const int iw = loc[0]*1 + loc[1]*jj;
+
+    for (int k=grid->kstart; k<grid->kend+1; ++k)
     {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
+        double sum2 = 0.;
+        double sum3 = 0.;
+        double sum4 = 0.;
+        double sumgrad = 0.;
+        double sumflux = 0.;
+        double sumdiff = 0.;
+
+        const double datameanh = 0.5*(datamean[k-1]+datamean[k]);
+
+        for (int j=grid->jstart; j<grid->jend; ++j)
+#pragma ivdep
+            for (int i=grid->istart; i<grid->iend; ++i)
+            {
+                const int ijk = i + j*jj + k*kk;
+                const double dev  = data[ijk]-datamean[k];
+                const double dev2 = dev*dev;
+                const double grad = (data[ijk]-data[ijk-kk])*dzhi[k];
+
+                sum2 += mask[ijk]*dev2;
+                sum3 += mask[ijk]*dev2*dev;
+                sum4 += mask[ijk]*dev2*dev2;
+
+                sumgrad += maskh[ijk]*grad;
+                sumflux += maskh[ijk]*(0.5*(data[ijk-kk]+data[ijk])-datameanh)*(0.5*(w[ijk-iw]+w[ijk])-wmean[k]);
+                sumdiff -= maskh[ijk]*visc*grad;
+            }
+
+        if (prof2)    prof2[k]    = sum2;
+        if (prof3)    prof3[k]    = sum3;
+        if (prof4)    prof4[k]    = sum4;
+        if (profgrad) profgrad[k] = sumgrad;
+        if (profflux) profflux[k] = sumflux;
+        if (profdiff) profdiff[k] = sumdiff;
     }
+
+    if (prof2)    sum_prof(prof2, nmask, 0);
+    if (prof3)    sum_prof(prof3, nmask, 0);
+    if (prof4)    sum_prof(prof4, nmask, 0);
+    if (profgrad) sum_prof(profgrad, nmaskh, 0);
+    if (profflux) sum_prof(profflux, nmaskh, datamean);
+    if (profdiff) sum_prof(profdiff, nmaskh, 0);
 }
 
 void Stats::calc_flux_2nd(double* restrict data, double* restrict datamean, double* restrict w, double* restrict wmean,
@@ -652,15 +1044,7 @@ void Stats::calc_flux_2nd(double* restrict data, double* restrict datamean, doub
             }
     }
 
-    master->sum(prof, grid->kcells);
-
-    for (int k=1; k<grid->kcells; ++k)
-    {
-        if (nmask[k] > nthres && datamean[k-1] != NC_FILL_DOUBLE && datamean[k] != NC_FILL_DOUBLE)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
+    sum_prof(prof, nmask, datamean);
 }
 
 void Stats::calc_flux_4th(double* restrict data, double* restrict w, double* restrict prof, double* restrict tmp1, const int loc[3],
@@ -703,15 +1087,7 @@ void Stats::calc_flux_4th(double* restrict data, double* restrict w, double* res
             }
     }
 
-    master->sum(prof, grid->kcells);
-
-    for (int k=1; k<grid->kcells; k++)
-    {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
+    sum_prof(prof, nmask, 0);
 }
 
 void Stats::calc_grad_2nd(double* restrict data, double* restrict prof, double* restrict dzhi, const int loc[3],
@@ -732,15 +1108,7 @@ void Stats::calc_grad_2nd(double* restrict data, double* restrict prof, double*
             }
     }
 
-    master->sum(prof, grid->kcells);
-
-    for (int k=1; k<grid->kcells; k++)
-    {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
+    sum_prof(prof, nmask, 0);
 }
 
 void Stats::calc_grad_4th(double* restrict data, double* restrict prof, double* restrict dzhi4, const int loc[3],
@@ -764,15 +1132,7 @@ void Stats::calc_grad_4th(double* restrict data, double* restrict prof, double*
             }
     }
 
-    master->sum(prof, grid->kcells);
-
-    for (int k=1; k<grid->kcells; k++)
-    {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
+    sum_prof(prof, nmask, 0);
 }
 
 void Stats::calc_diff_4th(double* restrict data, double* restrict prof, double* restrict dzhi4, double visc, const int loc[3],
@@ -796,15 +1156,7 @@ void Stats::calc_diff_4th(double* restrict data, double* restrict prof, double*
             }
     }
 
-    master->sum(prof, grid->kcells);
-
-    for (int k=1; k<grid->kcells; k++)
-    {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
+    sum_prof(prof, nmask, 0);
 }
 
 void Stats::calc_diff_2nd(double* restrict data, double* restrict prof, double* restrict dzhi, double visc, const int loc[3],
@@ -825,15 +1177,7 @@ void Stats::calc_diff_2nd(double* restrict data, double* restrict prof, double*
             }
     }
 
-    master->sum(prof, grid->kcells);
-
-    for (int k=1; k<grid->kcells; k++)
-    {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
+    sum_prof(prof, nmask, 0);
 }
 
 
@@ -922,15 +1266,7 @@ void Stats::calc_diff_2nd(double* restrict data, double* restrict w, double* res
             prof[kend] += mask[ijk]*fluxtop[ij];
         }
 
-    master->sum(prof, grid->kcells);
-
-    for (int k=1; k<grid->kcells; k++)
-    {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
+    sum_prof(prof, nmask, 0);
 }
 
 void Stats::add_fluxes(double* restrict flux, double* restrict turb, double* restrict diff)
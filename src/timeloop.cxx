@@ -216,19 +216,23 @@ void Timeloop::set_time_step()
 #ifndef USECUDA
 void Timeloop::exec()
 {
-    if (rkorder == 3)
+    // Collect all prognostic fields, such that they are updated in a single sweep.
+    std::vector<double*> alist, atlist;
+    for (FieldMap::const_iterator it = fields->at.begin(); it!=fields->at.end(); ++it)
     {
-        for (FieldMap::const_iterator it = fields->at.begin(); it!=fields->at.end(); ++it)
-            rk3(fields->ap[it->first]->data, it->second->data, dt);
+        alist .push_back(fields->ap[it->first]->data);
+        atlist.push_back(it->second->data);
+    }
 
+    if (rkorder == 3)
+    {
+        rk3(alist, atlist, dt);
         substep = (substep+1) % 3;
     }
 
     if (rkorder == 4)
     {
-        for (FieldMap::const_iterator it = fields->at.begin(); it!=fields->at.end(); ++it)
-            rk4(fields->ap[it->first]->data, it->second->data, dt);
-
+        rk4(alist, atlist, dt);
         substep = (substep+1) % 5;
     }
 }
@@ -262,37 +266,38 @@ inline double Timeloop::rk4subdt(const double dt)
     return cB[substep]*dt;
 }
 
-void Timeloop::rk3(double * restrict a, double * restrict at, const double dt)
+void Timeloop::rk3(const std::vector<double*>& alist, const std::vector<double*>& atlist, const double dt)
 {
     const double cA [] = {0., -5./9., -153./128.};
     const double cB [] = {1./3., 15./16., 8./15.};
 
+    const int nfields = alist.size();
+
     const int jj = grid->icells;
     const int kk = grid->ijcells;
 
-    for (int k=grid->kstart; k<grid->kend; k++)
-        for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk = i + j*jj + k*kk;
-                a[ijk] += cB[substep]*dt*at[ijk];
-            }
-
     const int substepn = (substep+1) % 3;
 
+    // Update the fields and prepare the tendencies for the next substep in the same sweep,
     // substep 0 resets the tendencies, because cA[0] == 0
+#pragma omp parallel for
     for (int k=grid->kstart; k<grid->kend; k++)
         for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
+            for (int n=0; n<nfields; n++)
             {
-                const int ijk = i + j*jj + k*kk;
-                at[ijk] *= cA[substepn];
+                double* restrict a  = alist[n];
+                double* restrict at = atlist[n];
+#pragma ivdep
+                for (int i=grid->istart; i<grid->iend; i++)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    a[ijk] += cB[substep]*dt*at[ijk];
+                    at[ijk] *= cA[substepn];
+                }
             }
 }
 
-void Timeloop::rk4(double * restrict a, double * restrict at, const double dt)
+void Timeloop::rk4(const std::vector<double*>& alist, const std::vector<double*>& atlist, const double dt)
 {
     const double cA [] = {
         0.,
@@ -308,28 +313,29 @@ void Timeloop::rk4(double * restrict a, double * restrict at, const double dt)
         3134564353537./ 4481467310338.,
         2277821191437./14882151754819.};
 
+    const int nfields = alist.size();
+
     const int jj = grid->icells;
     const int kk = grid->ijcells;
 
-    for (int k=grid->kstart; k<grid->kend; k++)
-        for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk = i + j*jj + k*kk;
-                a[ijk] = a[ijk] + cB[substep]*dt*at[ijk];
-            }
-
     const int substepn = (substep+1) % 5;
 
+    // Update the fields and prepare the tendencies for the next substep in the same sweep,
     // substep 0 resets the tendencies, because cA[0] == 0
+#pragma omp parallel for
     for (int k=grid->kstart; k<grid->kend; k++)
         for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
+            for (int n=0; n<nfields; n++)
             {
-                const int ijk = i + j*jj + k*kk;
-                at[ijk] = cA[substepn]*at[ijk];
+                double* restrict a  = alist[n];
+                double* restrict at = atlist[n];
+#pragma ivdep
+                for (int i=grid->istart; i<grid->iend; i++)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    a[ijk] = a[ijk] + cB[substep]*dt*at[ijk];
+                    at[ijk] = cA[substepn]*at[ijk];
+                }
             }
 }
 
@@ -430,6 +436,16 @@ void Timeloop::load(int starttime)
     dt   = (double)idt   / ifactor;
 }
 
+int Timeloop::get_next_post_proc_iotime()
+{
+    const unsigned long itimenext = itime + ipostproctime;
+
+    if (itimenext > iendtime)
+        return -1;
+
+    return (int)(itimenext/iiotimeprec);
+}
+
 void Timeloop::step_post_proc_time()
 {
     itime += ipostproctime;